@@ -0,0 +1,21 @@
+#version 330 core
+#extension GL_ARB_bindless_texture : require
+out vec4 FragColor;
+
+in vec3 vertexColor;
+in vec2 TexCoord;
+
+// Resident texture handles written by BindlessTextureTable. Each uvec4 holds one 64-bit handle in .xy
+//		(std140 pads array elements to 16 bytes). The size must match BindlessTextureTable::MAX_TEXTURES.
+layout (std140) uniform BindlessTextures
+{
+	uvec4 handles[1024];
+};
+
+uniform int textureIndex;
+
+void main()
+{
+	sampler2D tex = sampler2D(handles[textureIndex].xy);
+	FragColor = texture(tex, TexCoord) * vec4(vertexColor, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "BindlessTextureTable.h"
+
+// Local Library Includes
+#include "TextureLoader.h"
+
+// Standard Library Includes
+#include <iostream>
+
+BindlessTextureTable::BindlessTextureTable() {
+	ubo = 0;
+	dirty = false;
+
+	if (!isSupported())
+		return;
+
+	// std140 pads every array element to 16 bytes, so each handle takes a whole uvec4 slot.
+	glGenBuffers(1, &ubo);
+	glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+	glBufferData(GL_UNIFORM_BUFFER, MAX_TEXTURES * 16, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+BindlessTextureTable::~BindlessTextureTable() {
+	for (GLuint64 handle : handles)
+		glMakeTextureHandleNonResidentARB(handle);
+
+	if (!ownedTextures.empty())
+		glDeleteTextures((GLsizei)ownedTextures.size(), ownedTextures.data());
+	for (TextureCharge& charge : charges)
+		charge.release();
+	if (ubo)
+		glDeleteBuffers(1, &ubo);
+}
+
+bool BindlessTextureTable::isSupported() {
+	return GLExtensions::bindlessTexture;
+}
+
+TextureRef BindlessTextureTable::add(unsigned int texture) {
+	TextureRef ref;
+	ref.texture = texture;
+
+	if (!isSupported())
+		return ref; // Fallback: plain glBindTexture per draw.
+
+	if ((int)handles.size() >= MAX_TEXTURES) {
+		std::cout << "ERROR::BINDLESS::TABLE_FULL" << std::endl;
+		return ref;
+	}
+
+	// A handle freezes the texture's sampler state, so all parameters must be set before this point.
+	GLuint64 handle = glGetTextureHandleARB(texture);
+	glMakeTextureHandleResidentARB(handle);
+
+	ref.kind = TextureKind::Bindless;
+	ref.index = (int)handles.size();
+	handles.push_back(handle);
+	dirty = true;
+	return ref;
+}
+
+TextureRef BindlessTextureTable::add(const char* texPath) {
+	TextureCharge charge;
+	MipChain chain = TextureLoader::loadMipChain(texPath, TextureCategory::Default, &charge);
+	if (chain.levels.empty())
+		return TextureRef();
+
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	MipmapGenerator::upload(GL_TEXTURE_2D, chain);
+
+	ownedTextures.push_back(texture);
+	charges.push_back(charge);
+	return add(texture);
+}
+
+const char* BindlessTextureTable::fragmentShader(const char* fallback) const {
+	return isSupported() ? "./Bindless.frag" : fallback;
+}
+
+void BindlessTextureTable::bind() {
+	if (!ubo)
+		return;
+
+	if (dirty) {
+		vector<GLuint64> padded(handles.size() * 2, 0);
+		for (size_t i = 0; i < handles.size(); i++)
+			padded[i * 2] = handles[i];
+
+		glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, padded.size() * sizeof(GLuint64), padded.data());
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		dirty = false;
+	}
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, ubo);
+}
+
+void BindlessTextureTable::attachToProgram(unsigned int program) {
+	unsigned int blockIndex = glGetUniformBlockIndex(program, "BindlessTextures");
+	if (blockIndex != GL_INVALID_INDEX)
+		glUniformBlockBinding(program, blockIndex, BINDING_POINT);
+}
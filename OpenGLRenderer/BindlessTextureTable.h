@@ -0,0 +1,53 @@
+#pragma once
+
+// OpenGL Includes
+#include "GLExtensions.h"
+
+// Local Library Includes
+#include "MipmapGenerator.h"
+#include "TextureBudget.h"
+#include "TextureRef.h"
+
+// Standard Library Includes
+#include <vector>
+
+using namespace std;
+
+// Resident ARB_bindless_texture handles, stored in a uniform buffer the fragment shader indexes.
+//		Objects pick their texture by index, so switching textures between draws is just a uniform.
+//		When the extension isn't available add() hands back ordinary Single references instead,
+//		and fragmentShader() returns the caller's fallback shader, so callers never branch on support.
+class BindlessTextureTable {
+
+	private:
+		unsigned int ubo;
+		vector<GLuint64> handles;
+		vector<unsigned int> ownedTextures;
+		vector<TextureCharge> charges;	// Budget charges of ownedTextures, given back with them.
+		bool dirty;
+
+	public:
+		// Must match the array size and binding in Bindless.frag.
+		static const int MAX_TEXTURES = 1024;
+		static const unsigned int BINDING_POINT = 0;
+
+		// Constructor
+		BindlessTextureTable();
+		~BindlessTextureTable();
+
+		BindlessTextureTable(const BindlessTextureTable&) = delete;
+		BindlessTextureTable& operator=(const BindlessTextureTable&) = delete;
+
+		// Functions
+		static bool isSupported();
+
+		TextureRef add(unsigned int texture);
+		TextureRef add(const char* texPath);
+		const char* fragmentShader(const char* fallback) const;
+
+		// Upload new handles and bind the table. Call once per frame before drawing.
+		void bind();
+
+		// Point a program's "BindlessTextures" block at our binding. Harmless if it has no such block.
+		static void attachToProgram(unsigned int program);
+};
@@ -0,0 +1,77 @@
+#include "DirtyRangeSet.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+const size_t DirtyRangeSet::mapThreshold;
+
+DirtyRangeSet::DirtyRangeSet() {
+	bytes = 0;
+}
+
+void DirtyRangeSet::write(size_t offset, const void* data, size_t size) {
+	if (size == 0)
+		return;
+
+	size_t start = offset, end = offset + size;
+
+	// The first range that could touch [offset, end): the last one starting at or before it, if it reaches this far.
+	auto first = ranges.upper_bound(offset);
+	if (first != ranges.begin()) {
+		auto previous = prev(first);
+		if (previous->first + previous->second.size() >= offset)
+			first = previous;
+	}
+
+	auto last = first;
+	while (last != ranges.end() && last->first <= end) {
+		start = min(start, last->first);
+		end = max(end, last->first + last->second.size());
+		++last;
+	}
+
+	// Older bytes first, then the new write on top.
+	vector<unsigned char> merged(end - start);
+	for (auto it = first; it != last; ++it) {
+		memcpy(merged.data() + (it->first - start), it->second.data(), it->second.size());
+		bytes -= it->second.size();
+	}
+	memcpy(merged.data() + (offset - start), data, size);
+
+	ranges.erase(first, last);
+	bytes += merged.size();
+	ranges.emplace(start, std::move(merged));
+}
+
+size_t DirtyRangeSet::flush(GLuint buffer) {
+	size_t count = ranges.size();
+	if (count == 0)
+		return 0;
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	for (const auto& range : ranges) {
+		const vector<unsigned char>& data = range.second;
+		if (data.size() >= mapThreshold) {
+			void* mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, range.first, data.size(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+			if (mapped) {
+				memcpy(mapped, data.data(), data.size());
+
+				// A false return means the contents were lost (e.g. a mode switch); send them the ordinary way.
+				if (glUnmapBuffer(GL_COPY_WRITE_BUFFER) == GL_TRUE)
+					continue;
+			}
+		}
+		glBufferSubData(GL_COPY_WRITE_BUFFER, range.first, data.size(), data.data());
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	clear();
+	return count;
+}
+
+void DirtyRangeSet::clear() {
+	ranges.clear();
+	bytes = 0;
+}
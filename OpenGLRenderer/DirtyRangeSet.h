@@ -0,0 +1,43 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// Standard Library Includes
+#include <cstddef>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+// Pending writes to a GL buffer, kept as byte ranges with their new contents until flush().
+//
+//		Overlapping and touching writes are merged as they arrive, newest bytes winning, so many small edits
+//		to neighbouring vertices go up as one range. flush() sends each range with glBufferSubData, or, for
+//		large ranges, through glMapBufferRange with GL_MAP_INVALIDATE_RANGE_BIT so the driver can hand out
+//		fresh memory instead of waiting for the GPU to finish reading the old contents.
+class DirtyRangeSet {
+
+	private:
+		map<size_t, vector<unsigned char>> ranges;	// Start offset -> bytes, never overlapping or touching.
+		size_t bytes;
+
+	public:
+		// Constructor
+		DirtyRangeSet();
+
+		// Functions
+		void write(size_t offset, const void* data, size_t size);
+
+		// Upload everything to 'buffer' (through GL_COPY_WRITE_BUFFER, so no other binding changes) and clear.
+		//		Returns the number of ranges sent.
+		size_t flush(GLuint buffer);
+
+		void clear();
+		bool empty() const { return ranges.empty(); }
+		size_t rangeCount() const { return ranges.size(); }
+		size_t pendingBytes() const { return bytes; }
+
+		// Ranges at least this large are written through a mapping rather than glBufferSubData.
+		static const size_t mapThreshold = 64 * 1024;
+};
@@ -0,0 +1,46 @@
+#include "Frustum.h"
+
+// Standard Library Includes
+#include <cmath>
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProjection) {
+	// glm is column major, so row r is m[0][r], m[1][r], m[2][r], m[3][r].
+	const glm::mat4& m = viewProjection;
+	glm::vec4 row[4];
+	for (int r = 0; r < 4; r++)
+		row[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+
+	Frustum frustum;
+	frustum.planes[0] = row[3] + row[0];	// Left
+	frustum.planes[1] = row[3] - row[0];	// Right
+	frustum.planes[2] = row[3] + row[1];	// Bottom
+	frustum.planes[3] = row[3] - row[1];	// Top
+	frustum.planes[4] = row[3] + row[2];	// Near
+	frustum.planes[5] = row[3] - row[2];	// Far
+
+	// Normalized, so plane distances are real distances and sphere radii can be compared against them.
+	for (glm::vec4& plane : frustum.planes) {
+		float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		if (length > 0.0f)
+			plane = plane * (1.0f / length);
+	}
+	return frustum;
+}
+
+bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const {
+	for (const glm::vec4& plane : planes) {
+		if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+			return false;
+	}
+	return true;
+}
+
+// Tests the box corner furthest along each plane's normal; if even that is outside, the whole box is.
+bool Frustum::intersectsBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const {
+	for (const glm::vec4& plane : planes) {
+		glm::vec3 corner(plane.x >= 0.0f ? boxMax.x : boxMin.x, plane.y >= 0.0f ? boxMax.y : boxMin.y, plane.z >= 0.0f ? boxMax.z : boxMin.z);
+		if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
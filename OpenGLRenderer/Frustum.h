@@ -0,0 +1,18 @@
+#pragma once
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// The six clip planes of a view-projection matrix, for rejecting bounding volumes on the CPU.
+//		Each plane is (normal, distance) with the normal pointing into the frustum.
+struct Frustum {
+	glm::vec4 planes[6];
+
+	// Gribb and Hartmann's extraction: each plane is a sum or difference of the matrix's rows.
+	//		Planes come out in the space the matrix transforms from, so pass projection * view * model
+	//		to test bounds given in model space.
+	static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+	bool intersectsSphere(const glm::vec3& center, float radius) const;
+	bool intersectsBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+};
@@ -0,0 +1,62 @@
+#include "GLExtensions.h"
+
+// Standard Library Includes
+#include <cstring>
+#include <iostream>
+
+PFNGLGETTEXTUREHANDLEARBPROC ext_glGetTextureHandleARB = NULL;
+PFNGLMAKETEXTUREHANDLERESIDENTARBPROC ext_glMakeTextureHandleResidentARB = NULL;
+PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC ext_glMakeTextureHandleNonResidentARB = NULL;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC ext_glMultiDrawElementsIndirect = NULL;
+PFNGLBUFFERSTORAGEPROC ext_glBufferStorage = NULL;
+
+bool GLExtensions::bindlessTexture = false;
+bool GLExtensions::multiDrawIndirect = false;
+bool GLExtensions::bufferStorage = false;
+bool GLExtensions::shaderStorageBuffer = false;
+
+void GLExtensions::load(GLADloadproc loader) {
+	// A feature only counts as supported if the extension is advertised AND every entry point resolved.
+	if (hasExtension("GL_ARB_bindless_texture")) {
+		ext_glGetTextureHandleARB = (PFNGLGETTEXTUREHANDLEARBPROC)loader("glGetTextureHandleARB");
+		ext_glMakeTextureHandleResidentARB = (PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)loader("glMakeTextureHandleResidentARB");
+		ext_glMakeTextureHandleNonResidentARB = (PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)loader("glMakeTextureHandleNonResidentARB");
+
+		bindlessTexture = ext_glGetTextureHandleARB && ext_glMakeTextureHandleResidentARB && ext_glMakeTextureHandleNonResidentARB;
+	}
+
+	// Indirect commands carry a baseInstance, which drivers only honour with ARB_base_instance (core in 4.2).
+	if (hasVersion(4, 3) || (hasExtension("GL_ARB_multi_draw_indirect") && hasExtension("GL_ARB_base_instance"))) {
+		ext_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)loader("glMultiDrawElementsIndirect");
+		multiDrawIndirect = ext_glMultiDrawElementsIndirect != NULL;
+	}
+
+	if (hasVersion(4, 4) || hasExtension("GL_ARB_buffer_storage")) {
+		ext_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)loader("glBufferStorage");
+		bufferStorage = ext_glBufferStorage != NULL;
+	}
+
+	shaderStorageBuffer = hasVersion(4, 3) || hasExtension("GL_ARB_shader_storage_buffer_object");
+
+	std::cout << "OpenGL " << GLVersion.major << "." << GLVersion.minor
+		<< " | bindless textures: " << (bindlessTexture ? "yes" : "no")
+		<< " | multi-draw indirect: " << (multiDrawIndirect ? "yes" : "no")
+		<< " | buffer storage: " << (bufferStorage ? "yes" : "no")
+		<< " | storage buffers: " << (shaderStorageBuffer ? "yes" : "no") << std::endl;
+}
+
+bool GLExtensions::hasExtension(const char* name) {
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+	for (GLint i = 0; i < count; i++) {
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension && strcmp(extension, name) == 0)
+			return true;
+	}
+	return false;
+}
+
+bool GLExtensions::hasVersion(int major, int minor) {
+	return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
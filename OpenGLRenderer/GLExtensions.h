@@ -0,0 +1,72 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h> // Our glad loader only covers GL 3.3 core, so newer entry points are fetched here.
+
+// ---
+// ARB_bindless_texture
+// ---
+#ifndef GL_ARB_bindless_texture
+#define GL_ARB_bindless_texture 1
+typedef GLuint64 (APIENTRYP PFNGLGETTEXTUREHANDLEARBPROC)(GLuint texture);
+typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)(GLuint64 handle);
+typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)(GLuint64 handle);
+extern PFNGLGETTEXTUREHANDLEARBPROC ext_glGetTextureHandleARB;
+extern PFNGLMAKETEXTUREHANDLERESIDENTARBPROC ext_glMakeTextureHandleResidentARB;
+extern PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC ext_glMakeTextureHandleNonResidentARB;
+#define glGetTextureHandleARB ext_glGetTextureHandleARB
+#define glMakeTextureHandleResidentARB ext_glMakeTextureHandleResidentARB
+#define glMakeTextureHandleNonResidentARB ext_glMakeTextureHandleNonResidentARB
+#endif
+
+// ---
+// ARB_multi_draw_indirect (core in GL 4.3)
+// ---
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_ARB_multi_draw_indirect
+#define GL_ARB_multi_draw_indirect 1
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC ext_glMultiDrawElementsIndirect;
+#define glMultiDrawElementsIndirect ext_glMultiDrawElementsIndirect
+#endif
+
+// ---
+// ARB_buffer_storage (core in GL 4.4)
+// ---
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+#ifndef GL_ARB_buffer_storage
+#define GL_ARB_buffer_storage 1
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+extern PFNGLBUFFERSTORAGEPROC ext_glBufferStorage;
+#define glBufferStorage ext_glBufferStorage
+#endif
+
+// ---
+// ARB_shader_storage_buffer_object (core in GL 4.3). Bound with the core glBindBufferBase, so only the token is needed.
+// ---
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+
+// Which optional features the current context actually supports.
+//		Call load() once, right after gladLoadGLLoader, with the same loader function.
+class GLExtensions {
+
+	public:
+		static bool bindlessTexture;
+		static bool multiDrawIndirect;	// Including baseInstance, which needs GL 4.2 or ARB_base_instance.
+		static bool bufferStorage;
+		static bool shaderStorageBuffer;
+
+		// Functions
+		static void load(GLADloadproc loader);
+		static bool hasExtension(const char* name);
+		static bool hasVersion(int major, int minor);
+};
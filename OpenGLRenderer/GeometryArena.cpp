@@ -0,0 +1,208 @@
+#include "GeometryArena.h"
+
+// Local Library Includes
+#include "RenderableObject.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <iostream>
+
+// ---
+// RangeAllocator
+// ---
+const size_t RangeAllocator::INVALID;
+
+RangeAllocator::RangeAllocator(size_t capacity) {
+	this->capacity = capacity;
+	freeSpace = 0;
+	if (capacity > 0)
+		insertFree(0, capacity);
+}
+
+size_t RangeAllocator::allocate(size_t size) {
+	if (size == 0)
+		return INVALID;
+
+	// The smallest free range that fits keeps large ranges intact for large meshes.
+	auto fit = freeBySize.lower_bound(size);
+	if (fit == freeBySize.end())
+		return INVALID;
+
+	size_t offset = fit->second;
+	size_t rangeSize = fit->first;
+	eraseFree(freeByOffset.find(offset));
+
+	if (rangeSize > size)
+		insertFree(offset + size, rangeSize - size);
+	return offset;
+}
+
+void RangeAllocator::free(size_t offset, size_t size) {
+	if (size == 0)
+		return;
+
+	// Merge with the free range that ends where this one starts, and with the one that starts where it ends.
+	auto next = freeByOffset.lower_bound(offset);
+	if (next != freeByOffset.begin()) {
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == offset) {
+			offset = previous->first;
+			size += previous->second;
+			eraseFree(previous);
+		}
+	}
+
+	next = freeByOffset.lower_bound(offset + size);
+	if (next != freeByOffset.end() && next->first == offset + size) {
+		size += next->second;
+		eraseFree(next);
+	}
+
+	insertFree(offset, size);
+}
+
+void RangeAllocator::insertFree(size_t offset, size_t size) {
+	freeByOffset[offset] = size;
+	freeBySize.insert(make_pair(size, offset));
+	freeSpace += size;
+}
+
+void RangeAllocator::eraseFree(map<size_t, size_t>::iterator range) {
+	auto sized = freeBySize.equal_range(range->second);
+	for (auto it = sized.first; it != sized.second; ++it) {
+		if (it->second == range->first) {
+			freeBySize.erase(it);
+			break;
+		}
+	}
+	freeSpace -= range->second;
+	freeByOffset.erase(range);
+}
+
+// ---
+// GeometryArena
+// ---
+GeometryArena::GeometryArena(size_t vertexBytesPerPage, size_t indicesPerPage) {
+	this->vertexBytesPerPage = vertexBytesPerPage;
+	this->indicesPerPage = indicesPerPage;
+}
+
+GeometryArena::~GeometryArena() {
+	for (unique_ptr<Page>& page : pages) {
+		glDeleteVertexArrays(1, &page->vao);
+		glDeleteBuffers(1, &page->vbo);
+		glDeleteBuffers(1, &page->ebo);
+	}
+}
+
+GeometryRange GeometryArena::allocate(const VertexLayout& layout, const void* vertexData, size_t vertexCount, const void* indexData, size_t indexCount, GLenum indexType,
+	UploadQueue* uploadQueue, shared_ptr<UploadTicket> ticket) {
+	GeometryRange range;
+	range.indexType = indexType;
+	if (vertexCount == 0 || indexCount == 0 || layout.stride <= 0) {
+		cout << "ERROR::GEOMETRY_ARENA::EMPTY_MESH" << endl;
+		return range;
+	}
+
+	size_t firstVertex = RangeAllocator::INVALID;
+	size_t firstIndex = RangeAllocator::INVALID;
+	int pageIndex = -1;
+
+	for (size_t i = 0; i < pages.size() && pageIndex < 0; i++) {
+		Page& page = *pages[i];
+		if (page.layout != layout || page.indexType != indexType || page.vertices.largestFree() < vertexCount || page.indices.largestFree() < indexCount)
+			continue;
+
+		firstVertex = page.vertices.allocate(vertexCount);
+		firstIndex = page.indices.allocate(indexCount);
+		pageIndex = (int)i;
+	}
+
+	if (pageIndex < 0) {
+		pageIndex = createPage(layout, indexType, vertexCount, indexCount);
+		firstVertex = pages[pageIndex]->vertices.allocate(vertexCount);
+		firstIndex = pages[pageIndex]->indices.allocate(indexCount);
+	}
+
+	Page& page = *pages[pageIndex];
+	write(page.vbo, firstVertex * layout.stride, vertexData, vertexCount * layout.stride, uploadQueue, ticket);
+	write(page.ebo, firstIndex * range.indexSize(), indexData, indexCount * range.indexSize(), uploadQueue, ticket);
+
+	range.page = pageIndex;
+	range.vao = page.vao;
+	range.vertexBuffer = page.vbo;
+	range.indexBuffer = page.ebo;
+	range.baseVertex = (GLint)firstVertex;
+	range.firstIndex = (GLuint)firstIndex;
+	range.indexCount = (GLsizei)indexCount;
+	range.vertexCount = (GLuint)vertexCount;
+	return range;
+}
+
+void GeometryArena::free(GeometryRange& range) {
+	if (!range.valid() || range.page >= (int)pages.size())
+		return;
+
+	Page& page = *pages[range.page];
+	page.vertices.free(range.baseVertex, range.vertexCount);
+	page.indices.free(range.firstIndex, range.indexCount);
+	range = GeometryRange();
+}
+
+int GeometryArena::createPage(const VertexLayout& layout, GLenum indexType, size_t vertexCount, size_t indexCount) {
+	unique_ptr<Page> page(new Page());
+	page->layout = layout;
+	page->indexType = indexType;
+	size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? 2 : 4;
+
+	size_t vertexCapacity = max(vertexCount, vertexBytesPerPage / layout.stride);
+	size_t indexCapacity = max(indexCount, indicesPerPage);
+	page->vertices = RangeAllocator(vertexCapacity);
+	page->indices = RangeAllocator(indexCapacity);
+
+	glGenVertexArrays(1, &page->vao);
+	glGenBuffers(1, &page->vbo);
+	glGenBuffers(1, &page->ebo);
+
+	// The storage is reserved once; meshes are written into it with glBufferSubData.
+	//		The element buffer binding is part of the VAO, so it is bound while the VAO is.
+	//		Pages can be made mid-frame, so the binds go through RenderableObject's cache to keep it honest.
+	RenderableObject::bindVertexArray(page->vao);
+	glBindBuffer(GL_ARRAY_BUFFER, page->vbo);
+	glBufferData(GL_ARRAY_BUFFER, vertexCapacity * layout.stride, NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, page->ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * indexSize, NULL, GL_STATIC_DRAW);
+
+	layout.apply();
+	RenderableObject::bindVertexArray(0);
+
+	pages.push_back(std::move(page));
+	return (int)pages.size() - 1;
+}
+
+// Writes go through GL_COPY_WRITE_BUFFER, like the upload queue, so the bound VAO's element buffer is left alone.
+void GeometryArena::write(GLuint buffer, size_t offset, const void* data, size_t bytes, UploadQueue* uploadQueue, shared_ptr<UploadTicket> ticket) {
+	if (uploadQueue) {
+		const unsigned char* begin = (const unsigned char*)data;
+		uploadQueue->uploadBuffer(buffer, offset, vector<unsigned char>(begin, begin + bytes), UploadPriority::High, ticket);
+		return;
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, offset, bytes, data);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+size_t GeometryArena::usedVertexBytes() const {
+	size_t used = 0;
+	for (const unique_ptr<Page>& page : pages)
+		used += (page->vertices.size() - page->vertices.available()) * page->layout.stride;
+	return used;
+}
+
+size_t GeometryArena::usedIndexBytes() const {
+	size_t used = 0;
+	for (const unique_ptr<Page>& page : pages)
+		used += (page->indices.size() - page->indices.available()) * (page->indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+	return used;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// Local Library Includes
+#include "UploadQueue.h"
+#include "VertexLayout.h"
+
+// Standard Library Includes
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Hands out ranges of a fixed-size space (elements of a buffer) and takes them back.
+//		Free ranges are kept both by offset, so neighbours merge when a range is freed,
+//		and by size, so allocation is a best fit found with one O(log n) lookup.
+class RangeAllocator {
+
+	private:
+		map<size_t, size_t> freeByOffset;		// offset -> size
+		multimap<size_t, size_t> freeBySize;	// size -> offset
+		size_t capacity;
+		size_t freeSpace;
+
+		void insertFree(size_t offset, size_t size);
+		void eraseFree(map<size_t, size_t>::iterator range);
+
+	public:
+		static const size_t INVALID = SIZE_MAX;
+
+		// Constructor
+		RangeAllocator(size_t capacity = 0);
+
+		// Functions
+		// Returns the offset of 'size' free elements, or INVALID if no free range is large enough.
+		size_t allocate(size_t size);
+		void free(size_t offset, size_t size);
+
+		size_t available() const { return freeSpace; }
+		size_t largestFree() const { return freeBySize.empty() ? 0 : freeBySize.rbegin()->first; }
+		size_t size() const { return capacity; }
+};
+
+// Where one mesh lives inside a GeometryArena: draw it with
+//		glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, indexType, indexOffset(), baseVertex) while 'vao' is bound.
+struct GeometryRange {
+	int page = -1;
+	GLuint vao = 0;
+	GLuint vertexBuffer = 0;
+	GLuint indexBuffer = 0;
+	GLint baseVertex = 0;		// First vertex, in vertices. Indices stay relative to the mesh.
+	GLuint firstIndex = 0;		// First index, in indices.
+	GLsizei indexCount = 0;
+	GLuint vertexCount = 0;
+	GLenum indexType = GL_UNSIGNED_INT;
+
+	bool valid() const { return page >= 0; }
+	size_t indexSize() const { return indexType == GL_UNSIGNED_SHORT ? 2 : 4; }
+	const void* indexOffset() const { return (const void*)(uintptr_t)(firstIndex * indexSize()); }
+};
+
+// Keeps many meshes in a few large vertex and index buffers instead of one VAO, VBO and EBO per object.
+//
+//		Each page holds meshes of a single vertex format, so the format's attribute setup is done once in
+//		the page's VAO. Objects drawn from the same page share that VAO and only differ in their base vertex
+//		and first index, which means no VAO switches between them, far fewer GL objects for the driver
+//		to track, and one buffer pair per format for multi-draw batching to point at.
+//
+//		When a format's pages are full a new page is added; a mesh larger than a page gets a page of its own.
+class GeometryArena {
+
+	private:
+		struct Page {
+			VertexLayout layout;
+			GLenum indexType;			// 16 and 32-bit meshes live in separate pages.
+			GLuint vao;
+			GLuint vbo;
+			GLuint ebo;
+			RangeAllocator vertices;	// In vertices.
+			RangeAllocator indices;		// In indices.
+		};
+
+		vector<unique_ptr<Page>> pages;
+		size_t vertexBytesPerPage;
+		size_t indicesPerPage;
+
+		int createPage(const VertexLayout& layout, GLenum indexType, size_t vertexCount, size_t indexCount);
+		void write(GLuint buffer, size_t offset, const void* data, size_t bytes, UploadQueue* uploadQueue, shared_ptr<UploadTicket> ticket);
+
+	public:
+		// Constructor
+		GeometryArena(size_t vertexBytesPerPage = 16 * 1024 * 1024, size_t indicesPerPage = 4 * 1024 * 1024);
+		~GeometryArena();
+
+		GeometryArena(const GeometryArena&) = delete;
+		GeometryArena& operator=(const GeometryArena&) = delete;
+
+		// Functions
+		// Copy a mesh into a page with a matching layout. With an upload queue the data is queued against 'ticket'.
+		//		Returns an invalid range if the mesh is empty.
+		GeometryRange allocate(const VertexLayout& layout, const void* vertexData, size_t vertexCount, const void* indexData, size_t indexCount, GLenum indexType = GL_UNSIGNED_INT,
+			UploadQueue* uploadQueue = nullptr, shared_ptr<UploadTicket> ticket = nullptr);
+
+		// Give a range's space back. The range must not be drawn afterwards.
+		void free(GeometryRange& range);
+
+		size_t pageCount() const { return pages.size(); }
+		size_t usedVertexBytes() const;
+		size_t usedIndexBytes() const;
+};
@@ -0,0 +1,321 @@
+#include "GlbModel.h"
+
+// Local Library Includes
+#include "MappedFile.h"
+#include "RenderableObject.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace {
+	const uint32_t GLB_MAGIC = 0x46546C67;	// "glTF"
+	const uint32_t CHUNK_JSON = 0x4E4F534A;	// "JSON"
+	const uint32_t CHUNK_BIN = 0x004E4942;	// "BIN\0"
+	const long long MODE_TRIANGLES = 4;
+
+	uint32_t readU32(const unsigned char* p) {
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	size_t componentSize(GLenum type) {
+		switch (type) {
+			case GL_BYTE: case GL_UNSIGNED_BYTE: return 1;
+			case GL_SHORT: case GL_UNSIGNED_SHORT: return 2;
+			case GL_UNSIGNED_INT: case GL_FLOAT: return 4;
+		}
+		return 0;
+	}
+
+	// Whether 'count' elements of 'elementSize' bytes, 'stride' apart (0 for packed) from the accessor's
+	//		byteOffset, fit inside the view. GL would otherwise read past the end of the buffer.
+	bool accessorFits(const JsonValue& accessor, const JsonValue& view, size_t elementSize, size_t stride) {
+		long long offset = accessor["byteOffset"].integer(0);
+		long long count = accessor["count"].integer(0);
+		long long length = view["byteLength"].integer(0);
+		if (offset < 0 || count <= 0 || length <= 0 || (stride != 0 && stride < elementSize))
+			return false;
+
+		// Compared as a division first, so an absurd count can't overflow the multiplication.
+		unsigned long long step = stride ? stride : elementSize;
+		unsigned long long available = (unsigned long long)length;
+		if ((unsigned long long)offset + elementSize > available)
+			return false;
+		return (unsigned long long)(count - 1) <= (available - offset - elementSize) / step;
+	}
+
+	// The largest index of an index accessor already checked with accessorFits.
+	unsigned int maxIndex(const unsigned char* indices, size_t count, size_t indexSize) {
+		unsigned int largest = 0;
+		for (size_t i = 0; i < count; i++) {
+			unsigned int value = 0;
+			if (indexSize == 1)
+				value = indices[i];
+			else if (indexSize == 2) {
+				uint16_t shortValue;
+				memcpy(&shortValue, indices + i * 2, 2);
+				value = shortValue;
+			}
+			else
+				memcpy(&value, indices + i * 4, 4);
+			largest = max(largest, value);
+		}
+		return largest;
+	}
+}
+
+GlbModel::GlbModel() {
+	uploadedBytes = 0;
+}
+
+GlbModel::~GlbModel() {
+	release();
+}
+
+void GlbModel::release() {
+	for (GLuint buffer : buffers) {
+		if (buffer)
+			glDeleteBuffers(1, &buffer);
+	}
+	if (!vertexArrays.empty())
+		glDeleteVertexArrays((GLsizei)vertexArrays.size(), vertexArrays.data());
+
+	buffers.clear();
+	vertexArrays.clear();
+	primitives.clear();
+	uploadedBytes = 0;
+}
+
+bool GlbModel::load(const char* path) {
+	release();
+
+	MappedFile file;
+	if (!file.open(path) || file.size() < 20) {
+		cout << "ERROR::GLB::FILE_NOT_SUCCESFULLY_READ: " << path << endl;
+		return false;
+	}
+
+	// ---
+	// Container: 12 byte header, then a JSON chunk and an optional BIN chunk.
+	// ---
+	const unsigned char* data = file.data();
+	size_t size = file.size();
+	if (readU32(data) != GLB_MAGIC || readU32(data + 4) != 2 || readU32(data + 8) > size) {
+		cout << "ERROR::GLB::NOT_A_GLB_2_FILE: " << path << endl;
+		return false;
+	}
+	size = readU32(data + 8);
+
+	const unsigned char* jsonChunk = nullptr;
+	size_t jsonSize = 0;
+	const unsigned char* binChunk = nullptr;
+	size_t binSize = 0;
+
+	for (size_t offset = 12; offset + 8 <= size;) {
+		size_t chunkSize = readU32(data + offset);
+		uint32_t chunkType = readU32(data + offset + 4);
+		if (chunkSize > size - offset - 8)
+			break;
+
+		if (chunkType == CHUNK_JSON && !jsonChunk) {
+			jsonChunk = data + offset + 8;
+			jsonSize = chunkSize;
+		}
+		else if (chunkType == CHUNK_BIN && !binChunk) {
+			binChunk = data + offset + 8;
+			binSize = chunkSize;
+		}
+		offset += 8 + ((chunkSize + 3) & ~(size_t)3);
+	}
+
+	JsonValue json;
+	if (!jsonChunk || !JsonValue::parse((const char*)jsonChunk, jsonSize, json))
+		return false;
+
+	// ---
+	// Work out which bufferViews triangle primitives read, and check they lie inside the BIN chunk.
+	// ---
+	const JsonValue& views = json["bufferViews"];
+	const JsonValue& accessors = json["accessors"];
+	const JsonValue& meshes = json["meshes"];
+	vector<char> viewUsed(views.size(), 0);
+
+	auto markAccessor = [&](long long accessorIndex) {
+		long long view = accessors[(size_t)accessorIndex]["bufferView"].integer(-1);
+		if (view >= 0 && view < (long long)views.size())
+			viewUsed[(size_t)view] = 1;
+	};
+
+	for (size_t m = 0; m < meshes.size(); m++) {
+		const JsonValue& meshPrimitives = meshes[m]["primitives"];
+		for (size_t p = 0; p < meshPrimitives.size(); p++) {
+			const JsonValue& primitive = meshPrimitives[p];
+			if (primitive["mode"].integer(MODE_TRIANGLES) != MODE_TRIANGLES || !primitive.has("indices"))
+				continue;
+
+			markAccessor(primitive["indices"].integer(-1));
+			const JsonValue& attributes = primitive["attributes"];
+			for (size_t a = 0; a < attributes.size(); a++)
+				markAccessor(attributes.value(a).integer(-1));
+		}
+	}
+
+	// ---
+	// Upload the used views straight out of the mapping.
+	// ---
+	buffers.assign(views.size(), 0);
+	for (size_t v = 0; v < views.size(); v++) {
+		if (!viewUsed[v])
+			continue;
+
+		const JsonValue& view = views[v];
+		long long offset = view["byteOffset"].integer(0);
+		long long length = view["byteLength"].integer(0);
+		if (view["buffer"].integer(0) != 0 || !binChunk || offset < 0 || length <= 0 || (size_t)(offset + length) > binSize) {
+			cout << "ERROR::GLB::BUFFER_VIEW_OUT_OF_RANGE: " << v << endl;
+			continue;
+		}
+
+		// GL_COPY_WRITE_BUFFER leaves whatever VAO is bound untouched.
+		glGenBuffers(1, &buffers[v]);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[v]);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)length, binChunk + offset, GL_STATIC_DRAW);
+		uploadedBytes += (size_t)length;
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	// ---
+	// One VAO per primitive, with attribute pointers straight into the view buffers.
+	// ---
+	for (size_t m = 0; m < meshes.size(); m++) {
+		const JsonValue& meshPrimitives = meshes[m]["primitives"];
+		for (size_t p = 0; p < meshPrimitives.size(); p++) {
+			const JsonValue& primitive = meshPrimitives[p];
+			if (primitive["mode"].integer(MODE_TRIANGLES) != MODE_TRIANGLES || !primitive.has("indices")) {
+				cout << "ERROR::GLB::UNSUPPORTED_PRIMITIVE (mesh " << m << ")" << endl;
+				continue;
+			}
+
+			const JsonValue& indices = accessors[(size_t)primitive["indices"].integer(-1)];
+			long long indexView = indices["bufferView"].integer(-1);
+			GLenum indexType = (GLenum)indices["componentType"].integer(0);
+			size_t indexSize = componentSize(indexType);
+			long long indexOffset = indices["byteOffset"].integer(0);
+			if (indexView < 0 || indexView >= (long long)buffers.size() || !buffers[(size_t)indexView] ||
+				(indexType != GL_UNSIGNED_BYTE && indexType != GL_UNSIGNED_SHORT && indexType != GL_UNSIGNED_INT) || indexOffset % indexSize != 0 ||
+				!accessorFits(indices, views[(size_t)indexView], indexSize, 0)) {
+				cout << "ERROR::GLB::INVALID_INDICES (mesh " << m << ")" << endl;
+				continue;
+			}
+
+			GlbPrimitive drawable;
+			drawable.mesh = (int)m;
+			drawable.indexBuffer = buffers[(size_t)indexView];
+			drawable.indexType = indexType;
+			drawable.firstIndex = (GLuint)(indexOffset / indexSize);
+			drawable.indexCount = (GLsizei)indices["count"].integer(0);
+
+			// Through RenderableObject's cache, so loading a model mid-frame doesn't leave it naming the wrong VAO.
+			glGenVertexArrays(1, &drawable.vao);
+			vertexArrays.push_back(drawable.vao);
+			RenderableObject::bindVertexArray(drawable.vao);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, drawable.indexBuffer);
+
+			const JsonValue& attributes = primitive["attributes"];
+			static const char* SEMANTICS[] = { "COLOR_0", "TEXCOORD_0", "NORMAL", "TANGENT", "TEXCOORD_1", "JOINTS_0", "WEIGHTS_0" };
+			size_t vertexCount = SIZE_MAX;
+			bool hasPosition = attributes.has("POSITION") && setupAttribute(json, attributes["POSITION"].integer(-1), 0, vertexCount);
+			for (const char* semantic : SEMANTICS) {
+				if (attributes.has(semantic)) {
+					bool added = setupAttribute(json, attributes[semantic].integer(-1), attributeLocation(semantic), vertexCount);
+					if (added && attributeLocation(semantic) == attributeLocation("COLOR_0"))
+						drawable.hasColor = true;
+				}
+			}
+
+			RenderableObject::bindVertexArray(0);
+
+			const JsonValue& position = accessors[(size_t)attributes["POSITION"].integer(-1)];
+			const JsonValue& minimum = position["min"];
+			const JsonValue& maximum = position["max"];
+			drawable.boundsMin = glm::vec3((float)minimum[0].number(), (float)minimum[1].number(), (float)minimum[2].number());
+			drawable.boundsMax = glm::vec3((float)maximum[0].number(), (float)maximum[1].number(), (float)maximum[2].number());
+
+			if (!hasPosition) {
+				cout << "ERROR::GLB::PRIMITIVE_HAS_NO_POSITION (mesh " << m << ")" << endl;
+				continue;
+			}
+
+			// Every index must land on a vertex that all of the enabled arrays actually have.
+			const unsigned char* indexData = binChunk + views[(size_t)indexView]["byteOffset"].integer(0) + indexOffset;
+			if (maxIndex(indexData, (size_t)drawable.indexCount, indexSize) >= vertexCount) {
+				cout << "ERROR::GLB::INDEX_OUT_OF_RANGE (mesh " << m << ")" << endl;
+				continue;
+			}
+			primitives.push_back(drawable);
+		}
+	}
+
+	cout << "Loaded " << path << ": " << primitives.size() << " primitives, " << uploadedBytes << " bytes uploaded" << endl;
+	return !primitives.empty();
+}
+
+// Point 'location' at an accessor on the bound VAO, in the accessor's own component type.
+//		'vertexCount' is lowered to the accessor's count, so it ends up as the count every enabled array has.
+bool GlbModel::setupAttribute(const JsonValue& json, long long accessorIndex, GLuint location, size_t& vertexCount) {
+	const JsonValue& accessor = json["accessors"][(size_t)accessorIndex];
+	long long viewIndex = accessor["bufferView"].integer(-1);
+	if (accessor.isNull() || accessor.has("sparse") || viewIndex < 0 || viewIndex >= (long long)buffers.size() || !buffers[(size_t)viewIndex]) {
+		cout << "ERROR::GLB::UNSUPPORTED_ACCESSOR: " << accessorIndex << endl;
+		return false;
+	}
+
+	GLenum type = (GLenum)accessor["componentType"].integer(0);
+	GLint components = componentCount(accessor["type"].str());
+	if (componentSize(type) == 0 || components == 0) {
+		cout << "ERROR::GLB::UNSUPPORTED_ACCESSOR_FORMAT: " << accessorIndex << endl;
+		return false;
+	}
+
+	// A byteStride of 0 (or none) means tightly packed, which is also what 0 means to GL.
+	const JsonValue& view = json["bufferViews"][(size_t)viewIndex];
+	GLsizei stride = (GLsizei)view["byteStride"].integer(0);
+	if (stride < 0 || !accessorFits(accessor, view, componentSize(type) * components, (size_t)stride)) {
+		cout << "ERROR::GLB::ACCESSOR_OUT_OF_RANGE: " << accessorIndex << endl;
+		return false;
+	}
+	vertexCount = min(vertexCount, (size_t)accessor["count"].integer(0));
+
+	const void* offset = (const void*)(uintptr_t)accessor["byteOffset"].integer(0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffers[(size_t)viewIndex]);
+	if (location == attributeLocation("JOINTS_0"))
+		glVertexAttribIPointer(location, components, type, stride, offset);
+	else
+		glVertexAttribPointer(location, components, type, accessor["normalized"].boolValue() ? GL_TRUE : GL_FALSE, stride, offset);
+	glEnableVertexAttribArray(location);
+	return true;
+}
+
+GLuint GlbModel::attributeLocation(const string& semantic) {
+	if (semantic == "POSITION") return 0;
+	if (semantic == "COLOR_0") return 1;
+	if (semantic == "TEXCOORD_0") return 2;
+	if (semantic == "NORMAL") return 3;
+	if (semantic == "TANGENT") return 4;
+	if (semantic == "TEXCOORD_1") return 5;
+	if (semantic == "JOINTS_0") return 6;
+	return 7;
+}
+
+GLint GlbModel::componentCount(const string& type) {
+	if (type == "SCALAR") return 1;
+	if (type == "VEC2") return 2;
+	if (type == "VEC3") return 3;
+	if (type == "VEC4") return 4;
+	return 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Local Library Includes
+#include "JsonValue.h"
+
+// Standard Library Includes
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// One drawable glTF primitive: a VAO over the model's buffers plus the index range to draw.
+struct GlbPrimitive {
+	int mesh = -1;
+	GLuint vao = 0;
+	GLuint indexBuffer = 0;
+	GLenum indexType = GL_UNSIGNED_INT;
+	GLuint firstIndex = 0;			// In indices, from the accessor's offset into its bufferView.
+	GLsizei indexCount = 0;
+	glm::vec3 boundsMin = glm::vec3(0.0f);	// From the POSITION accessor's min/max.
+	glm::vec3 boundsMax = glm::vec3(0.0f);
+
+	// Without COLOR_0, location 1 reads GL's current generic attribute value. That is context-wide state, not part
+	//		of the VAO, so whoever draws the primitive sets it to glTF's white first (RenderableObject does).
+	bool hasColor = false;
+};
+
+// Binary glTF (.glb) loading without converting any vertex data.
+//
+//		The file is mapped, the JSON chunk parsed, and every bufferView that a triangle primitive reads is handed
+//		to glBufferData straight from the mapped binary chunk, so the only copy is the one into GL. Accessors
+//		become attribute pointers in their stored format (normalized bytes and shorts stay as they are), laid out
+//		to match MeshVertex's locations: POSITION 0, COLOR_0 1, TEXCOORD_0 2, NORMAL 3, TANGENT 4, TEXCOORD_1 5,
+//		JOINTS_0 6 and WEIGHTS_0 7.
+//
+//		Not handled: external .gltf/.bin files, sparse accessors, morph targets, and non-triangle primitives.
+//		Materials and images are left to the caller.
+class GlbModel {
+
+	private:
+		vector<GLuint> buffers;		// One per bufferView; 0 for views nothing draws from.
+		vector<GLuint> vertexArrays;
+		vector<GlbPrimitive> primitives;
+		size_t uploadedBytes;
+
+		void release();
+		bool setupAttribute(const JsonValue& json, long long accessorIndex, GLuint location, size_t& vertexCount);
+		static GLuint attributeLocation(const string& semantic);
+		static GLint componentCount(const string& type);
+
+	public:
+		// Constructor
+		GlbModel();
+		~GlbModel();
+
+		GlbModel(const GlbModel&) = delete;
+		GlbModel& operator=(const GlbModel&) = delete;
+
+		// Functions
+		bool load(const char* path);
+
+		const vector<GlbPrimitive>& getPrimitives() const { return primitives; }
+		size_t bytesUploaded() const { return uploadedBytes; }
+};
@@ -0,0 +1,362 @@
+#include "HdrTexture.h"
+
+// Local Library Includes
+#include "MappedFile.h"
+#include "stb_image.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HDR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+	// Largest finite values of each target, so overbright input saturates instead of becoming infinity.
+	const float HALF_MAX = 65504.0f;
+	const float FLOAT11_MAX = 65024.0f;
+	const float FLOAT10_MAX = 64512.0f;
+	const float RGB9E5_MAX = 65408.0f;
+
+	// Pixels per packing job.
+	const size_t PACK_CHUNK = 4096;
+
+	uint32_t floatBits(float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	float bitsFloat(uint32_t bits) {
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// ---
+	// Scalar conversions. These match the vector versions bit for bit and handle row tails.
+	// ---
+
+	// Non-negative float with a 5-bit exponent (bias 15) and the given mantissa width: the layout shared by
+	//		half floats (10 bits), and the 11 and 10 bit channels of R11G11B10F (6 and 5 bits). Rounds to nearest even.
+	uint32_t packUnsignedFloat(float value, int mantissaBits, float maxValue) {
+		if (!(value > 0.0f))
+			value = 0.0f; // Negative and NaN.
+		value = min(value, maxValue);
+
+		uint32_t bits = floatBits(value);
+		int shift = 23 - mantissaBits;
+
+		// Below the smallest normal (2^-14), adding a magic number lines the subnormal mantissa up with the float's.
+		if (bits < (113u << 23)) {
+			uint32_t magic = (uint32_t)(112 + shift + 1) << 23;
+			return floatBits(value + bitsFloat(magic)) - magic;
+		}
+
+		uint32_t odd = (bits >> shift) & 1;
+		return (bits + ((1u << (shift - 1)) - 1) - (112u << 23) + odd) >> shift;
+	}
+
+	uint16_t packHalf(float value) {
+		uint32_t sign = (floatBits(value) >> 16) & 0x8000;
+		return (uint16_t)(sign | packUnsignedFloat(fabsf(value), 10, HALF_MAX));
+	}
+
+	uint32_t packR11G11B10(float r, float g, float b) {
+		return packUnsignedFloat(r, 6, FLOAT11_MAX) | (packUnsignedFloat(g, 6, FLOAT11_MAX) << 11) | (packUnsignedFloat(b, 5, FLOAT10_MAX) << 22);
+	}
+
+	// Shared exponent packing as specified by EXT_texture_shared_exponent, with floor(log2) read from the float's exponent field.
+	uint32_t packRGB9E5(float r, float g, float b) {
+		r = (r > 0.0f) ? min(r, RGB9E5_MAX) : 0.0f;
+		g = (g > 0.0f) ? min(g, RGB9E5_MAX) : 0.0f;
+		b = (b > 0.0f) ? min(b, RGB9E5_MAX) : 0.0f;
+
+		float maxc = max(r, max(g, b));
+		int exponent = max(0, (int)(floatBits(maxc) >> 23) - 111);
+		float scale = bitsFloat((uint32_t)(151 - exponent) << 23);
+
+		if ((int)(maxc * scale + 0.5f) == 512) {
+			exponent++;
+			scale *= 0.5f;
+		}
+
+		uint32_t rc = (uint32_t)(r * scale + 0.5f);
+		uint32_t gc = (uint32_t)(g * scale + 0.5f);
+		uint32_t bc = (uint32_t)(b * scale + 0.5f);
+		return rc | (gc << 9) | (bc << 18) | ((uint32_t)exponent << 27);
+	}
+
+#ifdef HDR_SSE2
+	// ---
+	// SSE2 conversions, four values per call.
+	// ---
+	__m128i select(__m128i mask, __m128i a, __m128i b) {
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	__m128i packUnsignedFloat4(__m128 value, int mantissaBits, float maxValue) {
+		// max() returns its second operand for NaN, so NaN becomes 0 along with negatives.
+		value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(maxValue));
+
+		__m128i bits = _mm_castps_si128(value);
+		int shift = 23 - mantissaBits;
+		__m128i shiftCount = _mm_cvtsi32_si128(shift);
+
+		__m128i magic = _mm_set1_epi32((112 + shift + 1) << 23);
+		__m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(value, _mm_castsi128_ps(magic))), magic);
+
+		__m128i odd = _mm_and_si128(_mm_srl_epi32(bits, shiftCount), _mm_set1_epi32(1));
+		__m128i bias = _mm_set1_epi32((int)(((1u << (shift - 1)) - 1) - (112u << 23)));
+		__m128i normal = _mm_srl_epi32(_mm_add_epi32(_mm_add_epi32(bits, bias), odd), shiftCount);
+
+		__m128i isSubnormal = _mm_cmplt_epi32(bits, _mm_set1_epi32(113 << 23));
+		return select(isSubnormal, subnormal, normal);
+	}
+
+	// Half floats keep their sign; the result is sign extended so _mm_packs_epi32 passes it through unchanged.
+	__m128i packHalf4(__m128 value) {
+		__m128i signMask = _mm_set1_epi32((int)0x80000000);
+		__m128i sign = _mm_and_si128(_mm_castps_si128(value), signMask);
+		__m128 magnitude = _mm_andnot_ps(_mm_castsi128_ps(signMask), value);
+
+		__m128i half = _mm_or_si128(packUnsignedFloat4(magnitude, 10, HALF_MAX), _mm_srli_epi32(sign, 16));
+		return _mm_srai_epi32(_mm_slli_epi32(half, 16), 16);
+	}
+
+	// Four interleaved RGB pixels (12 floats) into one register per channel.
+	void loadRGB4(const float* rgb, __m128& r, __m128& g, __m128& b) {
+		__m128 a = _mm_loadu_ps(rgb);		// r0 g0 b0 r1
+		__m128 m = _mm_loadu_ps(rgb + 4);	// g1 b1 r2 g2
+		__m128 c = _mm_loadu_ps(rgb + 8);	// b2 r3 g3 b3
+
+		r = _mm_shuffle_ps(a, _mm_shuffle_ps(m, c, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		g = _mm_shuffle_ps(_mm_shuffle_ps(a, m, _MM_SHUFFLE(0, 0, 0, 1)), _mm_shuffle_ps(m, c, _MM_SHUFFLE(0, 2, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		b = _mm_shuffle_ps(_mm_shuffle_ps(a, m, _MM_SHUFFLE(0, 1, 0, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+	}
+
+	__m128i packR11G11B10x4(const float* rgb) {
+		__m128 r, g, b;
+		loadRGB4(rgb, r, g, b);
+		return _mm_or_si128(_mm_or_si128(packUnsignedFloat4(r, 6, FLOAT11_MAX), _mm_slli_epi32(packUnsignedFloat4(g, 6, FLOAT11_MAX), 11)),
+			_mm_slli_epi32(packUnsignedFloat4(b, 5, FLOAT10_MAX), 22));
+	}
+
+	__m128i packRGB9E5x4(const float* rgb) {
+		__m128 r, g, b;
+		loadRGB4(rgb, r, g, b);
+
+		__m128 zero = _mm_setzero_ps();
+		__m128 limit = _mm_set1_ps(RGB9E5_MAX);
+		r = _mm_min_ps(_mm_max_ps(r, zero), limit);
+		g = _mm_min_ps(_mm_max_ps(g, zero), limit);
+		b = _mm_min_ps(_mm_max_ps(b, zero), limit);
+
+		__m128 maxc = _mm_max_ps(r, _mm_max_ps(g, b));
+		__m128i exponent = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(maxc), 23), _mm_set1_epi32(111));
+		exponent = _mm_and_si128(exponent, _mm_cmpgt_epi32(exponent, _mm_setzero_si128()));
+
+		__m128 half = _mm_set1_ps(0.5f);
+		__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(151), exponent), 23));
+
+		// Rounding the largest channel up to 512 needs one more bit of exponent.
+		__m128i maxs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(maxc, scale), half));
+		__m128i overflow = _mm_cmpeq_epi32(maxs, _mm_set1_epi32(512));
+		exponent = _mm_sub_epi32(exponent, overflow);
+		scale = _mm_castsi128_ps(select(overflow, _mm_castps_si128(_mm_mul_ps(scale, half)), _mm_castps_si128(scale)));
+
+		__m128i rc = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, scale), half));
+		__m128i gc = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(g, scale), half));
+		__m128i bc = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b, scale), half));
+
+		return _mm_or_si128(_mm_or_si128(rc, _mm_slli_epi32(gc, 9)), _mm_or_si128(_mm_slli_epi32(bc, 18), _mm_slli_epi32(exponent, 27)));
+	}
+#endif
+
+	// Linear data, so a plain 2x2 average is the physically right reduction. Odd edges repeat their last texel.
+	vector<float> downsample(const vector<float>& src, int width, int height, int newWidth, int newHeight, WorkerPool& pool) {
+		vector<float> dst((size_t)newWidth * newHeight * 3);
+
+		pool.parallelFor(newHeight, [&](size_t begin, size_t end) {
+			for (size_t y = begin; y < end; y++) {
+				const float* row0 = &src[(size_t)min((int)y * 2, height - 1) * width * 3];
+				const float* row1 = &src[(size_t)min((int)y * 2 + 1, height - 1) * width * 3];
+				float* out = &dst[y * newWidth * 3];
+
+				for (int x = 0; x < newWidth; x++) {
+					int x0 = min(x * 2, width - 1) * 3;
+					int x1 = min(x * 2 + 1, width - 1) * 3;
+					for (int c = 0; c < 3; c++)
+						out[x * 3 + c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]) * 0.25f;
+				}
+			}
+		}, 16);
+		return dst;
+	}
+}
+
+size_t HdrChain::byteSize() const {
+	size_t total = 0;
+	for (const HdrLevel& level : levels)
+		total += level.data.size();
+	return total;
+}
+
+// ---
+// Loading
+// ---
+HdrChain HdrTexture::load(const char* path, HdrFormat format, bool generateMips, WorkerPool& pool) {
+	MappedFile file;
+	int width = 0, height = 0, fileChannels = 0;
+	float* pixels = nullptr;
+
+	// Flipped for GL like every other texture, using the per-thread flag so concurrent loads don't race.
+	if (file.open(path)) {
+		stbi_set_flip_vertically_on_load_thread(1);
+		pixels = stbi_loadf_from_memory(file.data(), (int)file.size(), &width, &height, &fileChannels, 3);
+	}
+
+	if (!pixels) {
+		cout << "Failed to load texture " << path << endl;
+		return HdrChain();
+	}
+
+	HdrChain chain = pack(pixels, width, height, format, generateMips, pool);
+	stbi_image_free(pixels);
+	return chain;
+}
+
+future<HdrChain> HdrTexture::loadAsync(const char* path, HdrFormat format, bool generateMips, WorkerPool& pool) {
+	string pathCopy = path;
+	return pool.async([pathCopy, format, generateMips, &pool]() {
+		return load(pathCopy.c_str(), format, generateMips, pool);
+	});
+}
+
+HdrChain HdrTexture::pack(const float* rgb, int width, int height, HdrFormat format, bool generateMips, WorkerPool& pool) {
+	HdrChain chain;
+	chain.format = format;
+
+	vector<float> level(rgb, rgb + (size_t)width * height * 3);
+	int bytes = bytesPerPixel(format);
+
+	while (true) {
+		HdrLevel packed;
+		packed.width = width;
+		packed.height = height;
+		packed.data.resize((size_t)width * height * bytes);
+
+		size_t count = (size_t)width * height;
+		size_t chunks = (count + PACK_CHUNK - 1) / PACK_CHUNK;
+		pool.parallelFor(chunks, [&](size_t begin, size_t end) {
+			size_t first = begin * PACK_CHUNK;
+			size_t last = min(end * PACK_CHUNK, count);
+			packPixels(&level[first * 3], last - first, format, &packed.data[first * bytes]);
+		});
+
+		chain.levels.push_back(std::move(packed));
+
+		if (!generateMips || (width == 1 && height == 1))
+			break;
+
+		int newWidth = max(1, width / 2);
+		int newHeight = max(1, height / 2);
+		level = downsample(level, width, height, newWidth, newHeight, pool);
+		width = newWidth;
+		height = newHeight;
+	}
+
+	return chain;
+}
+
+void HdrTexture::packPixels(const float* rgb, size_t count, HdrFormat format, unsigned char* dst) {
+	size_t i = 0;
+
+	switch (format) {
+		case HdrFormat::RGB9E5: {
+			uint32_t* out = (uint32_t*)dst;
+#ifdef HDR_SSE2
+			for (; i + 4 <= count; i += 4)
+				_mm_storeu_si128((__m128i*)(out + i), packRGB9E5x4(rgb + i * 3));
+#endif
+			for (; i < count; i++)
+				out[i] = packRGB9E5(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+			break;
+		}
+
+		case HdrFormat::R11G11B10F: {
+			uint32_t* out = (uint32_t*)dst;
+#ifdef HDR_SSE2
+			for (; i + 4 <= count; i += 4)
+				_mm_storeu_si128((__m128i*)(out + i), packR11G11B10x4(rgb + i * 3));
+#endif
+			for (; i < count; i++)
+				out[i] = packR11G11B10(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+			break;
+		}
+
+		case HdrFormat::RGB16F: {
+			// Every channel converts the same way, so treat the pixels as one flat run of floats.
+			uint16_t* out = (uint16_t*)dst;
+			size_t values = count * 3;
+#ifdef HDR_SSE2
+			for (; i + 8 <= values; i += 8) {
+				__m128i low = packHalf4(_mm_loadu_ps(rgb + i));
+				__m128i high = packHalf4(_mm_loadu_ps(rgb + i + 4));
+				_mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(low, high));
+			}
+#endif
+			for (; i < values; i++)
+				out[i] = packHalf(rgb[i]);
+			break;
+		}
+	}
+}
+
+// ---
+// GPU
+// ---
+void HdrTexture::upload(GLenum target, const HdrChain& chain) {
+	if (chain.levels.empty())
+		return;
+
+	// RGB16F rows are 6 bytes per texel.
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (size_t i = 0; i < chain.levels.size(); i++) {
+		const HdrLevel& level = chain.levels[i];
+		glTexImage2D(target, (GLint)i, internalFormat(chain.format), level.width, level.height, 0, GL_RGB, pixelType(chain.format), level.data.data());
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, (GLint)chain.levels.size() - 1);
+}
+
+GLenum HdrTexture::internalFormat(HdrFormat format) {
+	switch (format) {
+		case HdrFormat::RGB9E5: return GL_RGB9_E5;
+		case HdrFormat::R11G11B10F: return GL_R11F_G11F_B10F;
+		case HdrFormat::RGB16F: return GL_RGB16F;
+	}
+	return GL_RGB16F;
+}
+
+GLenum HdrTexture::pixelType(HdrFormat format) {
+	switch (format) {
+		case HdrFormat::RGB9E5: return GL_UNSIGNED_INT_5_9_9_9_REV;
+		case HdrFormat::R11G11B10F: return GL_UNSIGNED_INT_10F_11F_11F_REV;
+		case HdrFormat::RGB16F: return GL_HALF_FLOAT;
+	}
+	return GL_HALF_FLOAT;
+}
+
+int HdrTexture::bytesPerPixel(HdrFormat format) {
+	return (format == HdrFormat::RGB16F) ? 6 : 4;
+}
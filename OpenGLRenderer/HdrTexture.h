@@ -0,0 +1,63 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// Local Library Includes
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <future>
+#include <vector>
+
+using namespace std;
+
+// 32-bit packed formats cover almost everything lighting needs at a third of the size of RGB32F.
+//		RGB9E5 shares one exponent across the pixel (best precision, sample-only), R11G11B10F has
+//		per-channel exponents and can be rendered to, RGB16F is the 48-bit fallback for when sign or
+//		extra mantissa matters.
+enum class HdrFormat {
+	RGB9E5,
+	R11G11B10F,
+	RGB16F
+};
+
+struct HdrLevel {
+	int width;
+	int height;
+	vector<unsigned char> data;
+};
+
+// A full chain of packed levels, level 0 first, ready for glTexImage2D.
+struct HdrChain {
+	HdrFormat format = HdrFormat::RGB9E5;
+	vector<HdrLevel> levels;
+
+	size_t byteSize() const;
+};
+
+// Loads floating-point images (Radiance .hdr, or LDR files linearised by stb) and packs them into
+//		compact GPU formats. Mips are box-filtered in linear float before packing, and the packing
+//		itself runs across the worker pool with SSE2, four pixels per operation.
+class HdrTexture {
+
+	public:
+		// Functions
+		// Returns an empty chain if the file couldn't be decoded.
+		static HdrChain load(const char* path, HdrFormat format = HdrFormat::RGB9E5, bool generateMips = true, WorkerPool& pool = WorkerPool::shared());
+		static future<HdrChain> loadAsync(const char* path, HdrFormat format = HdrFormat::RGB9E5, bool generateMips = true, WorkerPool& pool = WorkerPool::shared());
+
+		// Pack tightly interleaved linear RGB floats.
+		static HdrChain pack(const float* rgb, int width, int height, HdrFormat format, bool generateMips = true, WorkerPool& pool = WorkerPool::shared());
+
+		// The conversion kernel: 'count' RGB pixels into bytesPerPixel(format) * count bytes.
+		static void packPixels(const float* rgb, size_t count, HdrFormat format, unsigned char* dst);
+
+		// Upload every level into the texture currently bound to 'target'.
+		static void upload(GLenum target, const HdrChain& chain);
+
+		// Matching GL formats.
+		static GLenum internalFormat(HdrFormat format);
+		static GLenum pixelType(HdrFormat format);
+		static int bytesPerPixel(HdrFormat format);
+};
@@ -0,0 +1,324 @@
+#include "ImageDecoder.h"
+
+// Local Library Includes
+#include "MappedFile.h"
+#include "stb_image.h"
+
+// Standard Library Includes
+#include <climits>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DECODER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+	const unsigned char PNG_SIGNATURE[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+	// The same limit stb_image puts on either side, so the fast path never accepts what it would refuse.
+	const unsigned int MAX_DIMENSION = 1 << 24;
+
+	unsigned int readBigEndian(const unsigned char* p) {
+		return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+	}
+
+	int paeth(int a, int b, int c) {
+		int p = a + b - c;
+		int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+		if (pa <= pb && pa <= pc) return a;
+		if (pb <= pc) return b;
+		return c;
+	}
+
+	// Reference unfilter, used for 1 and 2 byte pixels and for the row tails of the vector paths.
+	void unfilterRowScalar(int filter, const unsigned char* raw, const unsigned char* prior, unsigned char* cur, size_t rowBytes, int bpp, size_t start) {
+		for (size_t i = start; i < rowBytes; i++) {
+			int left = (i >= (size_t)bpp) ? cur[i - bpp] : 0;
+			int up = prior[i];
+			int upLeft = (i >= (size_t)bpp) ? prior[i - bpp] : 0;
+
+			switch (filter) {
+				case 0: cur[i] = raw[i]; break;
+				case 1: cur[i] = (unsigned char)(raw[i] + left); break;
+				case 2: cur[i] = (unsigned char)(raw[i] + up); break;
+				case 3: cur[i] = (unsigned char)(raw[i] + ((left + up) >> 1)); break;
+				case 4: cur[i] = (unsigned char)(raw[i] + paeth(left, up, upLeft)); break;
+			}
+		}
+	}
+
+#ifdef DECODER_SSE2
+	// Whole-pixel loads and stores for 3 and 4 byte pixels.
+	__m128i loadPixel(const unsigned char* p, int bpp) {
+		int value = 0;
+		memcpy(&value, p, bpp);
+		return _mm_cvtsi32_si128(value);
+	}
+
+	void storePixel(unsigned char* p, __m128i v, int bpp) {
+		int value = _mm_cvtsi128_si32(v);
+		memcpy(p, &value, bpp);
+	}
+
+	__m128i ifThenElse(__m128i condition, __m128i yes, __m128i no) {
+		return _mm_or_si128(_mm_and_si128(condition, yes), _mm_andnot_si128(condition, no));
+	}
+
+	__m128i abs16(__m128i x) {
+		return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+	}
+
+	// Sub, Avg and Paeth depend on the pixel to the left, so they run one pixel (all channels) per step.
+	//		Up has no such dependency and runs 16 bytes at a time.
+	void unfilterRowSSE2(int filter, const unsigned char* raw, const unsigned char* prior, unsigned char* cur, size_t rowBytes, int bpp) {
+		size_t pixels = rowBytes / bpp;
+		__m128i zero = _mm_setzero_si128();
+
+		switch (filter) {
+			case 0:
+				memcpy(cur, raw, rowBytes);
+				return;
+
+			case 1: {
+				__m128i a = zero;
+				for (size_t i = 0; i < pixels; i++) {
+					a = _mm_add_epi8(a, loadPixel(raw + i * bpp, bpp));
+					storePixel(cur + i * bpp, a, bpp);
+				}
+				return;
+			}
+
+			case 2: {
+				size_t i = 0;
+				for (; i + 16 <= rowBytes; i += 16) {
+					__m128i x = _mm_loadu_si128((const __m128i*)(raw + i));
+					__m128i b = _mm_loadu_si128((const __m128i*)(prior + i));
+					_mm_storeu_si128((__m128i*)(cur + i), _mm_add_epi8(x, b));
+				}
+				unfilterRowScalar(2, raw, prior, cur, rowBytes, bpp, i);
+				return;
+			}
+
+			case 3: {
+				// _mm_avg_epu8 rounds up; PNG wants the floor, so subtract the carried low bit.
+				__m128i a = zero;
+				__m128i one = _mm_set1_epi8(1);
+				for (size_t i = 0; i < pixels; i++) {
+					__m128i b = loadPixel(prior + i * bpp, bpp);
+					__m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+					a = _mm_add_epi8(loadPixel(raw + i * bpp, bpp), average);
+					storePixel(cur + i * bpp, a, bpp);
+				}
+				return;
+			}
+
+			case 4: {
+				// Work in 16-bit lanes so the predictor distances can't overflow.
+				__m128i a = zero, c = zero;
+				for (size_t i = 0; i < pixels; i++) {
+					__m128i b = _mm_unpacklo_epi8(loadPixel(prior + i * bpp, bpp), zero);
+
+					__m128i pa = _mm_sub_epi16(b, c);	// |p - a| = |b - c|
+					__m128i pb = _mm_sub_epi16(a, c);	// |p - b| = |a - c|
+					__m128i pc = _mm_add_epi16(pa, pb);	// |p - c| = |a + b - 2c|
+					pa = abs16(pa);
+					pb = abs16(pb);
+					pc = abs16(pc);
+
+					// Ties favour a, then b, then c.
+					__m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+					__m128i nearest = ifThenElse(_mm_cmpeq_epi16(smallest, pa), a,
+						ifThenElse(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+					__m128i d = _mm_add_epi8(loadPixel(raw + i * bpp, bpp), _mm_packus_epi16(nearest, nearest));
+					storePixel(cur + i * bpp, d, bpp);
+
+					c = b;
+					a = _mm_unpacklo_epi8(d, zero);
+				}
+				return;
+			}
+		}
+	}
+#endif
+}
+
+// ---
+// PNG fast path
+// ---
+bool ImageDecoder::decodePNG(const unsigned char* data, size_t size, bool flipVertically, DecodedImage& image) {
+	if (size < 8 || memcmp(data, PNG_SIGNATURE, 8) != 0)
+		return false;
+
+	unsigned int width = 0, height = 0;
+	int channels = 0;
+	vector<char> compressed;
+
+	// 1. Walk the chunks: read the header and gather every IDAT into one zlib stream.
+	size_t offset = 8;
+	while (offset + 12 <= size) {
+		unsigned int length = readBigEndian(data + offset);
+		const unsigned char* type = data + offset + 4;
+		const unsigned char* body = data + offset + 8;
+
+		if (offset + 12 + (size_t)length > size)
+			return false;
+
+		if (memcmp(type, "IHDR", 4) == 0) {
+			width = readBigEndian(body);
+			height = readBigEndian(body + 4);
+			int depth = body[8], colorType = body[9], interlace = body[12];
+
+			// Only the common layouts; palettes, 16-bit and interlacing go to stb_image.
+			if (depth != 8 || interlace != 0)
+				return false;
+
+			switch (colorType) {
+				case 0: channels = 1; break;
+				case 2: channels = 3; break;
+				case 4: channels = 2; break;
+				case 6: channels = 4; break;
+				default: return false;
+			}
+		}
+		else if (memcmp(type, "tRNS", 4) == 0 || memcmp(type, "PLTE", 4) == 0) {
+			return false; // Colour-keyed transparency needs expanding, which stb_image already does.
+		}
+		else if (memcmp(type, "IDAT", 4) == 0) {
+			compressed.insert(compressed.end(), body, body + length);
+		}
+		else if (memcmp(type, "IEND", 4) == 0) {
+			break;
+		}
+
+		offset += 12 + (size_t)length;
+	}
+
+	if (channels == 0 || width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION || compressed.empty())
+		return false;
+
+	// 2. Inflate straight into a buffer of the exact size: one filter byte per row plus the pixels.
+	//		With both sides capped this can't overflow, but stb's inflater only takes int sizes.
+	size_t rowBytes = (size_t)width * channels;
+	size_t rawSize = (rowBytes + 1) * height;
+	if (rawSize > INT_MAX || compressed.size() > INT_MAX)
+		return false;
+	vector<unsigned char> raw(rawSize);
+
+	int inflated = stbi_zlib_decode_buffer((char*)raw.data(), (int)rawSize, compressed.data(), (int)compressed.size());
+	if (inflated != (int)rawSize)
+		return false;
+
+	// 3. Reverse the filters, writing rows in GL's bottom-up order directly when asked to.
+	image.width = (int)width;
+	image.height = (int)height;
+	image.channels = channels;
+	image.pixels.resize(rowBytes * height);
+
+	vector<unsigned char> zeroRow(rowBytes, 0);
+	const unsigned char* prior = zeroRow.data();
+
+	for (unsigned int y = 0; y < height; y++) {
+		const unsigned char* rawRow = &raw[y * (rowBytes + 1)];
+		int filter = rawRow[0];
+		unsigned char* cur = &image.pixels[(flipVertically ? height - 1 - y : y) * rowBytes];
+
+		if (filter > 4)
+			return false;
+
+#ifdef DECODER_SSE2
+		if (channels >= 3)
+			unfilterRowSSE2(filter, rawRow + 1, prior, cur, rowBytes, channels);
+		else
+#endif
+			unfilterRowScalar(filter, rawRow + 1, prior, cur, rowBytes, channels, 0);
+
+		prior = cur;
+	}
+
+	return true;
+}
+
+// ---
+// Public interface
+// ---
+DecodedImage ImageDecoder::decodeFile(const char* path, int desiredChannels, bool flipVertically) {
+	MappedFile file;
+	if (!file.open(path)) {
+		cout << "Failed to load texture " << path << endl;
+		return DecodedImage();
+	}
+
+	DecodedImage image = decodeMemory(file.data(), file.size(), desiredChannels, flipVertically);
+	if (!image.valid())
+		cout << "Failed to load texture " << path << endl;
+	return image;
+}
+
+DecodedImage ImageDecoder::decodeMemory(const unsigned char* data, size_t size, int desiredChannels, bool flipVertically) {
+	DecodedImage image;
+
+	if (decodePNG(data, size, flipVertically, image)) {
+		convertChannels(image, desiredChannels);
+		return image;
+	}
+
+	// The per-thread flip flag keeps concurrent decodes on the worker pool from fighting over stb's global one.
+	int width, height, fileChannels;
+	stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
+	unsigned char* pixels = stbi_load_from_memory(data, (int)size, &width, &height, &fileChannels, desiredChannels);
+
+	if (pixels) {
+		image.width = width;
+		image.height = height;
+		image.channels = desiredChannels ? desiredChannels : fileChannels;
+		image.pixels.assign(pixels, pixels + (size_t)width * height * image.channels);
+		stbi_image_free(pixels);
+	}
+	return image;
+}
+
+vector<DecodedImage> ImageDecoder::decodeBatch(const vector<string>& paths, int desiredChannels, bool flipVertically, WorkerPool& pool) {
+	vector<DecodedImage> images(paths.size());
+
+	pool.parallelFor(paths.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			images[i] = decodeFile(paths[i].c_str(), desiredChannels, flipVertically);
+	});
+	return images;
+}
+
+// Matches stb_image's conversions: luminance uses its integer weights, missing alpha becomes opaque.
+void ImageDecoder::convertChannels(DecodedImage& image, int desiredChannels) {
+	if (desiredChannels == 0 || desiredChannels == image.channels)
+		return;
+
+	size_t count = (size_t)image.width * image.height;
+	vector<unsigned char> converted(count * desiredChannels);
+
+	for (size_t i = 0; i < count; i++) {
+		const unsigned char* src = &image.pixels[i * image.channels];
+		unsigned char* dst = &converted[i * desiredChannels];
+
+		bool hasColour = image.channels >= 3;
+		bool hasAlpha = image.channels == 2 || image.channels == 4;
+		unsigned char r = src[0];
+		unsigned char g = hasColour ? src[1] : src[0];
+		unsigned char b = hasColour ? src[2] : src[0];
+		unsigned char a = hasAlpha ? src[image.channels - 1] : 255;
+		unsigned char grey = hasColour ? (unsigned char)((r * 77 + g * 150 + b * 29) >> 8) : r;
+
+		switch (desiredChannels) {
+			case 1: dst[0] = grey; break;
+			case 2: dst[0] = grey; dst[1] = a; break;
+			case 3: dst[0] = r; dst[1] = g; dst[2] = b; break;
+			case 4: dst[0] = r; dst[1] = g; dst[2] = b; dst[3] = a; break;
+		}
+	}
+
+	image.pixels.swap(converted);
+	image.channels = desiredChannels;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Local Library Includes
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct DecodedImage {
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	vector<unsigned char> pixels;
+
+	bool valid() const { return !pixels.empty(); }
+};
+
+// Image decoding for the texture pipeline.
+//
+//		8-bit, non-interlaced PNGs (greyscale, grey+alpha, RGB, RGBA) take an in-tree path that inflates
+//		with stb's zlib and then reverses the row filters with SSE2, one whole pixel per vector operation.
+//		Baseline JPEG goes through stb_image, whose IDCT, YCbCr conversion and chroma upsampling already
+//		use SSE2 on x86/x64. Everything else falls back to stb_image unchanged.
+//
+//		Decoding is thread-safe, and decodeBatch() spreads many files across the worker pool, which is
+//		where most of the wall-clock time goes in scenes with many textures.
+class ImageDecoder {
+
+	private:
+		static bool decodePNG(const unsigned char* data, size_t size, bool flipVertically, DecodedImage& image);
+		static void convertChannels(DecodedImage& image, int desiredChannels);
+
+	public:
+		// Functions
+		// A desiredChannels of 0 keeps the file's channel count. Rows are bottom-up when flipVertically is set, as GL expects.
+		static DecodedImage decodeFile(const char* path, int desiredChannels = 0, bool flipVertically = true);
+		static DecodedImage decodeMemory(const unsigned char* data, size_t size, int desiredChannels = 0, bool flipVertically = true);
+		static vector<DecodedImage> decodeBatch(const vector<string>& paths, int desiredChannels = 0, bool flipVertically = true, WorkerPool& pool = WorkerPool::shared());
+};
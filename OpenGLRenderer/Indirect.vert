@@ -0,0 +1,23 @@
+#version 330 core
+// Default.vert for IndirectRenderer: each draw's transform and colour are fetched by its draw index.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 13) in uint drawIndex;	// baseInstance of the indirect command, or set per draw on the fallback path
+
+uniform samplerBuffer drawData;				// InstanceData as RGBA32F: four matrix columns, then the colour
+uniform int drawDataBase;					// Where this frame's data starts in the streaming buffer, in texels
+
+out vec3 vertexColor;
+out vec2 TexCoord;
+
+void main()
+{
+	int base = drawDataBase + int(drawIndex) * 5;
+	mat4 transform = mat4(texelFetch(drawData, base), texelFetch(drawData, base + 1), texelFetch(drawData, base + 2), texelFetch(drawData, base + 3));
+	vec4 color = texelFetch(drawData, base + 4);
+
+	gl_Position = transform * vec4(aPos, 1.0);
+	vertexColor = aColor * color.rgb;
+	TexCoord = aTexCoord;
+}
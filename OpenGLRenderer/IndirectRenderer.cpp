@@ -0,0 +1,291 @@
+#include "IndirectRenderer.h"
+
+// Local Library Includes
+#include "MeshOptimizer.h"
+#include "RenderableObject.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+const GLuint IndirectRenderer::drawIndexLocation;
+
+namespace {
+	struct StateKey {
+		GLuint program;
+		unsigned int vao;
+		GLenum indexType;
+		TextureKind kind;
+		unsigned int texture;
+		int index;
+
+		bool operator==(const StateKey& other) const {
+			return program == other.program && vao == other.vao && indexType == other.indexType &&
+				kind == other.kind && texture == other.texture && index == other.index;
+		}
+	};
+
+	struct StateKeyHash {
+		size_t operator()(const StateKey& key) const {
+			size_t hash = key.program;
+			hash = hash * 31 + key.vao;
+			hash = hash * 31 + key.indexType;
+			hash = hash * 31 + (size_t)key.kind;
+			hash = hash * 31 + key.texture;
+			hash = hash * 31 + (size_t)key.index;
+			return hash;
+		}
+	};
+
+	StateKey keyOf(const IndirectDraw& draw) {
+		return StateKey{ draw.program, draw.vao, draw.indexType, draw.texture.kind, draw.texture.texture, draw.texture.index };
+	}
+}
+
+IndirectRenderer::IndirectRenderer(WorkerPool& pool)
+	: commandStream(4096 * sizeof(DrawElementsIndirectCommand)), drawDataStream(4096 * sizeof(InstanceData)), pool(pool) {
+	glGenBuffers(1, &drawIndexBuffer);
+	glGenTextures(1, &drawDataTexture);
+	drawIndexCapacity = 0;
+	commands = nullptr;
+	drawData = nullptr;
+	commandCount = 0;
+	commandOffset = drawDataOffset = 0;
+	drawCalls = 0;
+
+	// GL 3.3 only promises 65536 texels, but desktop drivers allow far more.
+	maxTextureBufferTexels = 65536;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTextureBufferTexels);
+
+	useIndirect = GLExtensions::multiDrawIndirect;
+}
+
+IndirectRenderer::~IndirectRenderer() {
+	glDeleteBuffers(1, &drawIndexBuffer);
+	glDeleteTextures(1, &drawDataTexture);
+}
+
+void IndirectRenderer::add(const IndirectDraw& draw) {
+	if (draw.count > 0)
+		draws.push_back(draw);
+}
+
+void IndirectRenderer::setIndirectEnabled(bool enabled) {
+	useIndirect = enabled && GLExtensions::multiDrawIndirect;
+}
+
+// ---
+// CPU side: culling, bucketing and command building
+// ---
+void IndirectRenderer::cull(const Frustum* frustum) {
+	visible.assign(draws.size(), 1);
+	if (!frustum)
+		return;
+
+	pool.parallelFor(draws.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			visible[i] = frustum->intersectsSphere(draws[i].center, draws[i].radius) ? 1 : 0;
+	}, 1024);
+}
+
+// A counting sort by state: bucket ids in first-seen order, so the frame's submission order is stable.
+void IndirectRenderer::sortIntoBuckets() {
+	unordered_map<StateKey, size_t, StateKeyHash> bucketOf;
+	vector<size_t> drawBucket(draws.size());
+	buckets.clear();
+
+	size_t visibleCount = 0;
+	for (size_t i = 0; i < draws.size(); i++) {
+		if (!visible[i])
+			continue;
+
+		auto found = bucketOf.insert(make_pair(keyOf(draws[i]), buckets.size()));
+		if (found.second)
+			buckets.push_back(Bucket{ 0, 0, &draws[i] });
+		drawBucket[i] = found.first->second;
+		buckets[drawBucket[i]].count++;
+		visibleCount++;
+	}
+
+	// Every region of the draw data stream has to be addressable through the buffer texture.
+	size_t texelsPerDraw = sizeof(InstanceData) / sizeof(glm::vec4);
+	size_t maxDraws = (size_t)maxTextureBufferTexels / drawDataStream.framesInFlight() / texelsPerDraw;
+	if (visibleCount > maxDraws) {
+		cout << "ERROR::INDIRECT_RENDERER::TOO_MANY_DRAWS_FOR_TEXTURE_BUFFER" << endl;
+		visibleCount = maxDraws;
+	}
+
+	size_t next = 0;
+	for (Bucket& bucket : buckets) {
+		bucket.first = next;
+		next += bucket.count;
+		bucket.count = 0;
+	}
+
+	order.resize(visibleCount);
+	for (size_t i = 0; i < draws.size(); i++) {
+		if (!visible[i])
+			continue;
+
+		Bucket& bucket = buckets[drawBucket[i]];
+		if (bucket.first + bucket.count < visibleCount)
+			order[bucket.first + bucket.count++] = (unsigned int)i;
+	}
+}
+
+// Room for this frame's commands and draw data. Streams only grow between frames, before beginFrame().
+bool IndirectRenderer::allocate() {
+	commandCount = order.size();
+	size_t dataBytes = commandCount * sizeof(InstanceData);
+	size_t commandBytes = commandCount * sizeof(DrawElementsIndirectCommand);
+
+	drawDataStream.reserve(dataBytes);
+	drawDataStream.beginFrame();
+	StreamAllocation dataAllocation = drawDataStream.allocate(dataBytes, sizeof(glm::vec4));
+	drawData = (InstanceData*)dataAllocation.data;
+	drawDataOffset = dataAllocation.offset;
+
+	if (useIndirect) {
+		commandStream.reserve(commandBytes);
+		commandStream.beginFrame();
+		StreamAllocation commandAllocation = commandStream.allocate(commandBytes, sizeof(GLuint));
+		commands = (DrawElementsIndirectCommand*)commandAllocation.data;
+		commandOffset = commandAllocation.offset;
+	}
+	else {
+		// Read back while drawing, which mapped (write-combined) memory is slow at.
+		fallbackCommands.resize(commandCount);
+		commands = fallbackCommands.data();
+	}
+	return commands && drawData;
+}
+
+// Commands and per-draw data are independent per slot, so workers write them in parallel, straight into the streams.
+void IndirectRenderer::buildCommands() {
+	pool.parallelFor(commandCount, [&](size_t begin, size_t end) {
+		for (size_t slot = begin; slot < end; slot++) {
+			const IndirectDraw& draw = draws[order[slot]];
+			DrawElementsIndirectCommand command;
+			command.count = draw.count;
+			command.instanceCount = 1;
+			command.firstIndex = draw.firstIndex;
+			command.baseVertex = draw.baseVertex;
+			command.baseInstance = (GLuint)slot;	// Becomes the shader's drawIndex.
+			commands[slot] = command;
+			drawData[slot] = draw.data;
+		}
+	}, 1024);
+}
+
+// ---
+// GPU side
+// ---
+
+// The draw index attribute reads element baseInstance of 0, 1, 2, ...; it only ever grows.
+void IndirectRenderer::uploadDrawIndices() {
+	if (commandCount <= drawIndexCapacity)
+		return;
+
+	drawIndexCapacity = max(commandCount, drawIndexCapacity * 2);
+	vector<GLuint> indices(drawIndexCapacity);
+	for (size_t i = 0; i < indices.size(); i++)
+		indices[i] = (GLuint)i;
+	glBindBuffer(GL_COPY_WRITE_BUFFER, drawIndexBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+// Point location 13 of the bound VAO at the draw index buffer. Meshes' own shaders don't read location 13, so other
+//		users of the VAO (RenderableObject::Draw, arena neighbours) are unaffected.
+//		This is redone on every bind rather than remembered per VAO: GL recycles deleted VAO names, so a
+//		remembered name could belong to a fresh VAO that never had location 13 set up.
+void IndirectRenderer::prepareVao() {
+	if (!useIndirect) {
+		glDisableVertexAttribArray(drawIndexLocation);
+		return;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, drawIndexBuffer);
+	glVertexAttribIPointer(drawIndexLocation, 1, GL_UNSIGNED_INT, sizeof(GLuint), (const void*)0);
+	glVertexAttribDivisor(drawIndexLocation, 1);
+	glEnableVertexAttribArray(drawIndexLocation);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void IndirectRenderer::bindState(const IndirectDraw& state) {
+	glUseProgram(state.program);
+
+	auto found = programLocations.find(state.program);
+	if (found == programLocations.end()) {
+		ProgramLocations locations;
+		locations.drawData = glGetUniformLocation(state.program, "drawData");
+		locations.drawDataBase = glGetUniformLocation(state.program, "drawDataBase");
+		locations.textureLayer = glGetUniformLocation(state.program, "textureLayer");
+		locations.textureIndex = glGetUniformLocation(state.program, "textureIndex");
+		found = programLocations.insert(make_pair(state.program, locations)).first;
+	}
+	const ProgramLocations& locations = found->second;
+
+	// The buffer texture spans every frame's region; drawDataBase says where this frame's starts, in texels.
+	glUniform1i(locations.drawData, 1);
+	glUniform1i(locations.drawDataBase, (GLint)(drawDataOffset / sizeof(glm::vec4)));
+
+	RenderableObject::bindVertexArray(state.vao);
+	prepareVao();
+	RenderableObject::bindTexture(state.texture, locations.textureLayer, locations.textureIndex);
+}
+
+void IndirectRenderer::flush(const Frustum* frustum) {
+	drawCalls = 0;
+
+	cull(frustum);
+	sortIntoBuckets();
+
+	if (!order.empty() && allocate()) {
+		buildCommands();
+		drawDataStream.commit();
+		if (useIndirect) {
+			commandStream.commit();
+			uploadDrawIndices();
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandStream.id());
+		}
+
+		// The draw data stays on unit 1 for the whole flush; unit 0 is the one RenderableObject caches.
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_BUFFER, drawDataTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, drawDataStream.id());
+		glActiveTexture(GL_TEXTURE0);
+
+		for (const Bucket& bucket : buckets) {
+			if (bucket.count == 0)
+				continue;
+			bindState(*bucket.state);
+
+			if (useIndirect) {
+				const void* offset = (const void*)(uintptr_t)(commandOffset + bucket.first * sizeof(DrawElementsIndirectCommand));
+				glMultiDrawElementsIndirect(GL_TRIANGLES, bucket.state->indexType, offset, (GLsizei)bucket.count, sizeof(DrawElementsIndirectCommand));
+				drawCalls++;
+				continue;
+			}
+
+			// Fallback: the attribute array is disabled, so its current value is what the shader reads.
+			size_t indexSize = PackedIndices::typeSize(bucket.state->indexType);
+			for (size_t slot = bucket.first; slot < bucket.first + bucket.count; slot++) {
+				const DrawElementsIndirectCommand& command = commands[slot];
+				glVertexAttribI1ui(drawIndexLocation, command.baseInstance);
+				glDrawElementsBaseVertex(GL_TRIANGLES, command.count, bucket.state->indexType, (const void*)(uintptr_t)(command.firstIndex * indexSize), command.baseVertex);
+				drawCalls++;
+			}
+		}
+
+		// Fence this frame's regions behind the draws that read them.
+		drawDataStream.endFrame();
+		if (useIndirect) {
+			commandStream.endFrame();
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		}
+	}
+
+	draws.clear();
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Local Library Includes
+#include "Frustum.h"
+#include "GLExtensions.h"
+#include "InstancedObject.h"
+#include "StreamingBuffer.h"
+#include "TextureRef.h"
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// The record glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER, laid out as the GL spec defines it.
+struct DrawElementsIndirectCommand {
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// One draw handed to the IndirectRenderer: which state it needs, which indices it covers, and its per-draw data.
+struct IndirectDraw {
+	GLuint program;
+	unsigned int vao;
+	TextureRef texture;
+	GLenum indexType;
+	GLuint count;
+	GLuint firstIndex;
+	GLint baseVertex;
+	InstanceData data;		// Transform and colour, fetched by the shader through the draw index.
+	glm::vec3 center;		// World space bounding sphere, for culling.
+	float radius;
+};
+
+// Submits a frame's draws with one glMultiDrawElementsIndirect per state bucket instead of one call per object.
+//
+//		Draws are collected with add(), then flush() culls them against the frustum and sorts the visible ones into
+//		buckets of identical program, VAO, index type and texture. It then writes their DrawElementsIndirectCommands
+//		and per-draw data on the worker pool. Objects in the same GeometryArena page share a VAO, so they land in
+//		one bucket.
+//
+//		Each command's baseInstance is its position in the frame's draw list. A uint attribute at location 13, fed
+//		from a 0, 1, 2, ... buffer with divisor 1, turns that into a draw index in the shader (see Indirect.vert),
+//		which fetches the draw's InstanceData from a buffer texture. That works without ARB_shader_draw_parameters.
+//
+//		Commands and draw data are written by the workers straight into persistently mapped StreamingBuffers,
+//		so a frame's submission costs no copies and never waits on the GPU's previous frames.
+//
+//		Without GL 4.3 (or ARB_multi_draw_indirect and ARB_base_instance) the same commands are issued one by one,
+//		with the draw index set as the attribute's current value, so the same shaders work on either path.
+class IndirectRenderer {
+
+	private:
+		struct Bucket {
+			size_t first;	// Into the sorted command list.
+			size_t count;
+			const IndirectDraw* state;
+		};
+
+		struct ProgramLocations {
+			GLint drawData;
+			GLint drawDataBase;
+			GLint textureLayer;
+			GLint textureIndex;
+		};
+
+		vector<IndirectDraw> draws;
+		vector<DrawElementsIndirectCommand> fallbackCommands;
+		DrawElementsIndirectCommand* commands;	// This frame's: in the command stream, or fallbackCommands.
+		InstanceData* drawData;
+		size_t commandCount;
+		size_t commandOffset;					// Byte offsets of this frame's data in the streams.
+		size_t drawDataOffset;
+		vector<Bucket> buckets;
+		vector<char> visible;
+		vector<unsigned int> order;
+
+		StreamingBuffer commandStream;
+		StreamingBuffer drawDataStream;
+		unsigned int drawDataTexture, drawIndexBuffer;
+		size_t drawIndexCapacity;
+		GLint maxTextureBufferTexels;
+		unordered_map<GLuint, ProgramLocations> programLocations;
+		bool useIndirect;
+		size_t drawCalls;
+		WorkerPool& pool;
+
+		void cull(const Frustum* frustum);
+		void sortIntoBuckets();
+		bool allocate();
+		void buildCommands();
+		void uploadDrawIndices();
+		void prepareVao();
+		void bindState(const IndirectDraw& state);
+
+	public:
+		// Constructor
+		IndirectRenderer(WorkerPool& pool = WorkerPool::shared());
+		~IndirectRenderer();
+
+		IndirectRenderer(const IndirectRenderer&) = delete;
+		IndirectRenderer& operator=(const IndirectRenderer&) = delete;
+
+		// Functions
+		void add(const IndirectDraw& draw);
+
+		// Cull, bucket, build and issue everything added since the last flush. Pass nullptr to skip culling.
+		void flush(const Frustum* frustum = nullptr);
+
+		// Issue the commands one at a time even when multi-draw indirect is available (for comparison and debugging).
+		void setIndirectEnabled(bool enabled);
+
+		size_t drawCallsLastFrame() const { return drawCalls; }
+
+		static const GLuint drawIndexLocation = 13;
+};
@@ -0,0 +1,17 @@
+#version 330 core
+// Default.vert for InstancedObject: the same mesh attributes, plus a transform and colour per instance.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 8) in mat4 instanceTransform;	// Locations 8-11, one column each
+layout (location = 12) in vec4 instanceColor;
+
+out vec3 vertexColor;
+out vec2 TexCoord;
+
+void main()
+{
+	gl_Position = instanceTransform * vec4(aPos, 1.0);
+	vertexColor = aColor * instanceColor.rgb;
+	TexCoord = aTexCoord;
+}
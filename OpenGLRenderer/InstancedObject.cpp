@@ -0,0 +1,161 @@
+#include "InstancedObject.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+const size_t InstancedObject::blockSize;
+const GLuint InstancedObject::transformLocation;
+const GLuint InstancedObject::colorLocation;
+
+void InstancedObject::setupGeometry(const void* vertexData, size_t vertexCount, const VertexLayout& layout, const void* indexData, size_t indexCount, GLenum indexType) {
+	cout << "InstancedObject is being created" << endl;
+
+	this->indexType = indexType;
+	numIndices = (GLsizei)indexCount;
+	instanceCapacity = 0;
+	instanceBuffer = 0;
+
+	textureLayerLocation = glGetUniformLocation(shader_program.ID, "textureLayer");
+	textureIndexLocation = glGetUniformLocation(shader_program.ID, "textureIndex");
+
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ebo);
+	glGenBuffers(1, &instanceBuffer);
+
+	RenderableObject::bindVertexArray(vao);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, vertexCount * layout.stride, vertexData, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * PackedIndices::typeSize(indexType), indexData, GL_STATIC_DRAW);
+	layout.apply();
+
+	// The instance attributes read from their own buffer and advance once per instance rather than per vertex.
+	//		A mat4 attribute takes four consecutive locations, one column each.
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	for (GLuint column = 0; column < 4; column++) {
+		glVertexAttribPointer(transformLocation + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const void*)(offsetof(InstanceData, transform) + column * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(transformLocation + column);
+		glVertexAttribDivisor(transformLocation + column, 1);
+	}
+	glVertexAttribPointer(colorLocation, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const void*)offsetof(InstanceData, color));
+	glEnableVertexAttribArray(colorLocation);
+	glVertexAttribDivisor(colorLocation, 1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+InstancedObject::~InstancedObject() {
+	// The name may be handed out again; don't let the bind cache skip binding whatever gets it next.
+	RenderableObject::bindVertexArray(0);
+	glDeleteVertexArrays(1, &vao);
+	glDeleteBuffers(1, &vbo);
+	glDeleteBuffers(1, &ebo);
+	glDeleteBuffers(1, &instanceBuffer);
+}
+
+// ---
+// Instances
+// ---
+size_t InstancedObject::addInstance(const glm::mat4& transform, const glm::vec4& color) {
+	InstanceData instance;
+	instance.transform = transform;
+	instance.color = color;
+	instances.push_back(instance);
+
+	markDirty(instances.size() - 1, 1);
+	return instances.size() - 1;
+}
+
+void InstancedObject::removeInstance(size_t index) {
+	if (index >= instances.size())
+		return;
+
+	if (index != instances.size() - 1) {
+		instances[index] = instances.back();
+		markDirty(index, 1);
+	}
+	instances.pop_back();
+}
+
+void InstancedObject::clearInstances() {
+	instances.clear();
+}
+
+void InstancedObject::setTransform(size_t index, const glm::mat4& transform) {
+	if (index >= instances.size())
+		return;
+	instances[index].transform = transform;
+	markDirty(index, 1);
+}
+
+void InstancedObject::setColor(size_t index, const glm::vec4& color) {
+	if (index >= instances.size())
+		return;
+	instances[index].color = color;
+	markDirty(index, 1);
+}
+
+void InstancedObject::markDirty(size_t first, size_t count) {
+	if (count == 0)
+		return;
+
+	size_t lastBlock = (first + count - 1) / blockSize;
+	if (dirtyBlocks.size() <= lastBlock)
+		dirtyBlocks.resize(lastBlock + 1, 0);
+	for (size_t block = first / blockSize; block <= lastBlock; block++)
+		dirtyBlocks[block] = 1;
+}
+
+// ---
+// Drawing
+// ---
+void InstancedObject::uploadInstances() {
+	glBindBuffer(GL_COPY_WRITE_BUFFER, instanceBuffer);
+
+	// Outgrown: reallocate with room to spare and send everything, which also clears every dirty flag.
+	if (instances.size() > instanceCapacity) {
+		instanceCapacity = max(instances.size(), instanceCapacity * 2);
+		glBufferData(GL_COPY_WRITE_BUFFER, instanceCapacity * sizeof(InstanceData), NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+		fill(dirtyBlocks.begin(), dirtyBlocks.end(), 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return;
+	}
+
+	// One glBufferSubData per run of dirty blocks.
+	size_t blockCount = min(dirtyBlocks.size(), (instances.size() + blockSize - 1) / blockSize);
+	size_t block = 0;
+	while (block < blockCount) {
+		if (!dirtyBlocks[block]) {
+			block++;
+			continue;
+		}
+
+		size_t runStart = block;
+		while (block < blockCount && dirtyBlocks[block])
+			block++;
+
+		size_t first = runStart * blockSize;
+		size_t count = min(block * blockSize, instances.size()) - first;
+		glBufferSubData(GL_COPY_WRITE_BUFFER, first * sizeof(InstanceData), count * sizeof(InstanceData), &instances[first]);
+	}
+	fill(dirtyBlocks.begin(), dirtyBlocks.end(), 0);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void InstancedObject::Draw() {
+	uploadInstances();
+	if (instances.empty())
+		return;
+
+	shader_program.use();
+	RenderableObject::bindVertexArray(vao);
+	RenderableObject::bindTexture(textureRef, textureLayerLocation, textureIndexLocation);
+
+	glDrawElementsInstanced(GL_TRIANGLES, numIndices, indexType, (const void*)0, (GLsizei)instances.size());
+}
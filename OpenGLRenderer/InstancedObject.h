@@ -0,0 +1,94 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Local Library Includes
+#include "MeshOptimizer.h"
+#include "RenderableObject.h"
+#include "Shader.h"
+#include "TextureRef.h"
+#include "VertexLayout.h"
+
+// Standard Library Includes
+#include <vector>
+
+using namespace std;
+
+// What each copy of an instanced mesh gets on top of the shared vertices.
+//		Read by Instanced.vert as a mat4 at locations 8-11 and a vec4 at location 12, advancing once per instance.
+struct InstanceData {
+	glm::mat4 transform;
+	glm::vec4 color;
+};
+
+// One mesh, shader and texture drawn many times with a single glDrawElementsInstanced.
+//
+//		Geometry lives in the object's own VAO, VBO and EBO, with a second buffer holding an InstanceData per copy.
+//		The instance attributes use glVertexAttribDivisor(1), so the vertex shader sees each copy's transform and
+//		colour while the mesh is only stored once. Changes are tracked in blocks of instances, and Draw() uploads
+//		only runs of dirty blocks, so moving a few hundred of 100k copies doesn't resend the rest.
+class InstancedObject {
+
+	private:
+		unsigned int vao, vbo, ebo, instanceBuffer;
+		GLenum indexType;
+		GLsizei numIndices;
+		TextureRef textureRef;
+		Shader shader_program;
+		int textureLayerLocation, textureIndexLocation;
+
+		vector<InstanceData> instances;
+		size_t instanceCapacity;			// Instances the GPU buffer has room for.
+		vector<char> dirtyBlocks;			// One flag per blockSize instances.
+
+		static const size_t blockSize = 256;
+		static const GLuint transformLocation = 8;
+		static const GLuint colorLocation = 12;
+
+		void setupGeometry(const void* vertexData, size_t vertexCount, const VertexLayout& layout, const void* indexData, size_t indexCount, GLenum indexType);
+		void uploadInstances();
+
+	public:
+		// Constructor
+		template<typename Vertex>
+		InstancedObject(const vector<Vertex>& verts, const vector<unsigned int>& inds, const char* vertPath, const char* fragPath, const TextureRef& texRef)
+			: shader_program(vertPath, fragPath) {
+			textureRef = texRef;
+			setupGeometry(verts.data(), verts.size(), VertexLayout::of<Vertex>(), inds.data(), inds.size(), GL_UNSIGNED_INT);
+		}
+
+		template<typename Vertex>
+		InstancedObject(const vector<Vertex>& verts, const PackedIndices& inds, const char* vertPath, const char* fragPath, const TextureRef& texRef)
+			: shader_program(vertPath, fragPath) {
+			textureRef = texRef;
+			setupGeometry(verts.data(), verts.size(), VertexLayout::of<Vertex>(), inds.data(), inds.count, inds.type);
+		}
+
+		~InstancedObject();
+
+		InstancedObject(const InstancedObject&) = delete;
+		InstancedObject& operator=(const InstancedObject&) = delete;
+
+		// Functions
+		// Returns the new instance's index.
+		size_t addInstance(const glm::mat4& transform, const glm::vec4& color = glm::vec4(1.0f));
+
+		// Moves the last instance into the gap, so indices past 'index' are stable except the last one's.
+		void removeInstance(size_t index);
+		void clearInstances();
+
+		void setTransform(size_t index, const glm::mat4& transform);
+		void setColor(size_t index, const glm::vec4& color);
+
+		// Direct access for bulk updates (e.g. from worker threads); call markDirty for what was written.
+		InstanceData* instanceData() { return instances.data(); }
+		void markDirty(size_t first, size_t count);
+
+		size_t instanceCount() const { return instances.size(); }
+
+		void Draw();
+};
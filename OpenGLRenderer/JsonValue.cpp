@@ -0,0 +1,281 @@
+#include "JsonValue.h"
+
+// Standard Library Includes
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+const JsonValue JsonValue::null;
+const string JsonValue::empty;
+
+JsonValue::JsonValue() {
+	kind = Type::Null;
+	boolean = false;
+	numeric = 0.0;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+	if (kind != Type::Array || index >= elements.size())
+		return null;
+	return elements[index];
+}
+
+const JsonValue& JsonValue::operator[](const char* key) const {
+	if (kind != Type::Object)
+		return null;
+	for (const pair<string, JsonValue>& member : members) {
+		if (member.first == key)
+			return member.second;
+	}
+	return null;
+}
+
+const string& JsonValue::key(size_t index) const {
+	if (kind != Type::Object || index >= members.size())
+		return empty;
+	return members[index].first;
+}
+
+const JsonValue& JsonValue::value(size_t index) const {
+	if (kind != Type::Object || index >= members.size())
+		return null;
+	return members[index].second;
+}
+
+// ---
+// Parser
+// ---
+
+// Recursive descent over the text. Nesting is capped so hostile files can't exhaust the stack.
+class JsonParser {
+
+	private:
+		const char* begin;
+		const char* p;
+		const char* end;
+		int depth;
+
+		static const int MAX_DEPTH = 128;
+
+		void skipSpace() {
+			while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+				p++;
+		}
+
+		bool literal(const char* word) {
+			size_t length = strlen(word);
+			if ((size_t)(end - p) < length || memcmp(p, word, length) != 0)
+				return false;
+			p += length;
+			return true;
+		}
+
+		static void appendUtf8(string& out, unsigned int codepoint) {
+			if (codepoint < 0x80) {
+				out += (char)codepoint;
+			}
+			else if (codepoint < 0x800) {
+				out += (char)(0xC0 | (codepoint >> 6));
+				out += (char)(0x80 | (codepoint & 0x3F));
+			}
+			else if (codepoint < 0x10000) {
+				out += (char)(0xE0 | (codepoint >> 12));
+				out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+				out += (char)(0x80 | (codepoint & 0x3F));
+			}
+			else {
+				out += (char)(0xF0 | (codepoint >> 18));
+				out += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+				out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+				out += (char)(0x80 | (codepoint & 0x3F));
+			}
+		}
+
+		bool hex4(unsigned int& value) {
+			if (end - p < 4)
+				return false;
+			value = 0;
+			for (int i = 0; i < 4; i++) {
+				char c = *p++;
+				value <<= 4;
+				if (c >= '0' && c <= '9') value |= c - '0';
+				else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+				else return false;
+			}
+			return true;
+		}
+
+		bool parseString(string& out) {
+			p++; // Opening quote.
+			while (p < end && *p != '"') {
+				if (*p != '\\') {
+					out += *p++;
+					continue;
+				}
+
+				if (++p >= end)
+					return false;
+				char escape = *p++;
+				switch (escape) {
+					case '"': out += '"'; break;
+					case '\\': out += '\\'; break;
+					case '/': out += '/'; break;
+					case 'b': out += '\b'; break;
+					case 'f': out += '\f'; break;
+					case 'n': out += '\n'; break;
+					case 'r': out += '\r'; break;
+					case 't': out += '\t'; break;
+					case 'u': {
+						unsigned int codepoint;
+						if (!hex4(codepoint))
+							return false;
+						// Surrogate pairs encode code points above U+FFFF.
+						if (codepoint >= 0xD800 && codepoint < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+							p += 2;
+							unsigned int low;
+							if (!hex4(low))
+								return false;
+							codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+						}
+						appendUtf8(out, codepoint);
+						break;
+					}
+					default:
+						return false;
+				}
+			}
+			if (p >= end)
+				return false;
+			p++; // Closing quote.
+			return true;
+		}
+
+		bool parseNumber(double& out) {
+			const char* start = p;
+			while (p < end && (strchr("+-0123456789.eE", *p) != nullptr))
+				p++;
+
+			char buffer[64];
+			size_t length = (size_t)(p - start);
+			if (length == 0 || length >= sizeof(buffer))
+				return false;
+			memcpy(buffer, start, length);
+			buffer[length] = '\0';
+
+			char* parsed = nullptr;
+			out = strtod(buffer, &parsed);
+			return parsed == buffer + length;
+		}
+
+	public:
+		JsonParser(const char* data, size_t size) {
+			begin = p = data;
+			end = data + size;
+			depth = 0;
+		}
+
+		bool parseValue(JsonValue& value) {
+			skipSpace();
+			if (p >= end)
+				return false;
+
+			switch (*p) {
+				case '{': {
+					if (++depth > MAX_DEPTH)
+						return false;
+					value.kind = JsonValue::Type::Object;
+					p++;
+					skipSpace();
+					if (p < end && *p == '}') {
+						p++;
+						depth--;
+						return true;
+					}
+					while (true) {
+						skipSpace();
+						if (p >= end || *p != '"')
+							return false;
+						value.members.emplace_back();
+						if (!parseString(value.members.back().first))
+							return false;
+						skipSpace();
+						if (p >= end || *p != ':')
+							return false;
+						p++;
+						if (!parseValue(value.members.back().second))
+							return false;
+						skipSpace();
+						if (p < end && *p == ',') { p++; continue; }
+						if (p < end && *p == '}') { p++; break; }
+						return false;
+					}
+					depth--;
+					return true;
+				}
+				case '[': {
+					if (++depth > MAX_DEPTH)
+						return false;
+					value.kind = JsonValue::Type::Array;
+					p++;
+					skipSpace();
+					if (p < end && *p == ']') {
+						p++;
+						depth--;
+						return true;
+					}
+					while (true) {
+						value.elements.emplace_back();
+						if (!parseValue(value.elements.back()))
+							return false;
+						skipSpace();
+						if (p < end && *p == ',') { p++; continue; }
+						if (p < end && *p == ']') { p++; break; }
+						return false;
+					}
+					depth--;
+					return true;
+				}
+				case '"':
+					value.kind = JsonValue::Type::String;
+					return parseString(value.text);
+				case 't':
+					value.kind = JsonValue::Type::Bool;
+					value.boolean = true;
+					return literal("true");
+				case 'f':
+					value.kind = JsonValue::Type::Bool;
+					value.boolean = false;
+					return literal("false");
+				case 'n':
+					value.kind = JsonValue::Type::Null;
+					return literal("null");
+				default:
+					value.kind = JsonValue::Type::Number;
+					return parseNumber(value.numeric);
+			}
+		}
+
+		bool finished() {
+			skipSpace();
+			return p == end;
+		}
+
+		size_t offset() const { return (size_t)(p - begin); }
+};
+
+bool JsonValue::parse(const char* data, size_t size, JsonValue& value) {
+	value = JsonValue();
+
+	// Binary containers pad the text with spaces or NULs to keep the next chunk aligned.
+	while (size > 0 && data[size - 1] == '\0')
+		size--;
+	JsonParser parser(data, size);
+
+	if (!parser.parseValue(value) || !parser.finished()) {
+		cout << "ERROR::JSON::PARSE_FAILED_AT_BYTE " << parser.offset() << endl;
+		value = JsonValue();
+		return false;
+	}
+	return true;
+}
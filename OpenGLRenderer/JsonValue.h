@@ -0,0 +1,70 @@
+#pragma once
+
+// Standard Library Includes
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// A small JSON document tree, enough for asset headers such as glTF's.
+//		Lookups that miss (wrong key, wrong index, wrong type) return a shared null value,
+//		so chains like json["accessors"][3]["count"].number() never need checking at every step.
+class JsonValue {
+
+	public:
+		enum class Type {
+			Null,
+			Bool,
+			Number,
+			String,
+			Array,
+			Object
+		};
+
+	private:
+		Type kind;
+		bool boolean;
+		double numeric;
+		string text;
+		vector<JsonValue> elements;
+		vector<pair<string, JsonValue>> members;
+
+		static const JsonValue null;
+		static const string empty;
+
+		friend class JsonParser;
+
+	public:
+		// Constructor
+		JsonValue();
+
+		// Functions
+		// Parses a complete document. On failure prints the byte offset and returns false.
+		static bool parse(const char* data, size_t size, JsonValue& value);
+
+		Type type() const { return kind; }
+		bool isNull() const { return kind == Type::Null; }
+		bool isNumber() const { return kind == Type::Number; }
+		bool isString() const { return kind == Type::String; }
+		bool isArray() const { return kind == Type::Array; }
+		bool isObject() const { return kind == Type::Object; }
+
+		bool boolValue(bool fallback = false) const { return kind == Type::Bool ? boolean : fallback; }
+		double number(double fallback = 0.0) const { return kind == Type::Number ? numeric : fallback; }
+		long long integer(long long fallback = 0) const { return kind == Type::Number ? (long long)numeric : fallback; }
+		const string& str() const { return text; }
+
+		// Elements of an array, or members of an object.
+		size_t size() const { return kind == Type::Array ? elements.size() : (kind == Type::Object ? members.size() : 0); }
+
+		const JsonValue& operator[](size_t index) const;
+		const JsonValue& operator[](int index) const { return (*this)[(size_t)index]; }
+		const JsonValue& operator[](const char* key) const;
+		bool has(const char* key) const { return !(*this)[key].isNull(); }
+
+		// Object members by position, for keys that aren't known up front.
+		const string& key(size_t index) const;
+		const JsonValue& value(size_t index) const;
+};
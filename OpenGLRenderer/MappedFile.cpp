@@ -0,0 +1,122 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() {
+	bytes = nullptr;
+	length = 0;
+	opened = false;
+
+#ifdef _WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char* path) {
+	close();
+
+	fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize)) {
+		close();
+		return false;
+	}
+
+	length = (size_t)fileSize.QuadPart;
+	opened = true;
+
+	// Windows refuses to map zero-length files; an empty view is still a valid open.
+	if (length == 0)
+		return true;
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle)
+		bytes = (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+	if (!bytes) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes)
+		UnmapViewOfFile(bytes);
+	if (mappingHandle)
+		CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(fileHandle);
+
+	bytes = nullptr;
+	length = 0;
+	opened = false;
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const char* path) {
+	close();
+
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		::close(fd);
+		return false;
+	}
+
+	length = (size_t)info.st_size;
+
+	if (length > 0) {
+		void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (view == MAP_FAILED) {
+			::close(fd);
+			length = 0;
+			return false;
+		}
+
+		// Assets are read front to back, so let the kernel read ahead aggressively.
+		madvise(view, length, MADV_SEQUENTIAL);
+		bytes = (const unsigned char*)view;
+	}
+
+	// The mapping keeps its own reference to the file.
+	::close(fd);
+	opened = true;
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes)
+		munmap((void*)bytes, length);
+
+	bytes = nullptr;
+	length = 0;
+	opened = false;
+}
+
+#endif
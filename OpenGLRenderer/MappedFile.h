@@ -0,0 +1,37 @@
+#pragma once
+
+// Standard Library Includes
+#include <cstddef>
+
+// A read-only view of a whole file mapped into memory.
+//		Pages are faulted in by the OS as they're touched, so large assets can be parsed
+//		or handed to GL without first copying them through a stream buffer.
+class MappedFile {
+
+	private:
+		const unsigned char* bytes;
+		size_t length;
+		bool opened;
+
+#ifdef _WIN32
+		void* fileHandle;
+		void* mappingHandle;
+#endif
+
+	public:
+		// Constructor
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// Functions
+		// Maps the file, closing any previous one. Empty files open successfully with a null data().
+		bool open(const char* path);
+		void close();
+
+		bool isOpen() const { return opened; }
+		const unsigned char* data() const { return bytes; }
+		size_t size() const { return length; }
+};
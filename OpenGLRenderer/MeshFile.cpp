@@ -0,0 +1,288 @@
+#include "MeshFile.h"
+
+// Standard Library Includes
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+	const char MESH_MAGIC[4] = { 'M', 'E', 'S', 'H' };
+	const uint32_t MESH_VERSION = 1;
+
+	// Blobs start on a cache line, which also satisfies any alignment a mapped GL buffer copy could want.
+	const size_t BLOB_ALIGNMENT = 64;
+
+	const uint32_t FLAG_QUANTIZED = 1;
+
+	struct MeshHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t flags;
+		uint32_t stride;
+		uint32_t attributeCount;
+		uint32_t lodCount;
+		uint32_t indexType;
+		uint32_t reserved;
+		uint64_t vertexCount;
+		uint64_t indexCount;
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		float boundsMin[3];
+		float boundsMax[3];
+		float positionScale[3];
+		float positionOffset[3];
+		float texCoordScale[2];
+		float texCoordOffset[2];
+	};
+
+	struct MeshAttribute {
+		uint32_t location;
+		uint32_t components;
+		uint32_t type;
+		uint32_t normalized;
+		uint32_t integer;
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	struct MeshLodEntry {
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		float error;
+		uint32_t reserved;
+	};
+
+	size_t alignUp(size_t value) {
+		return (value + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+	}
+
+	size_t indexSize(uint32_t type) {
+		return type == GL_UNSIGNED_SHORT ? 2 : (type == GL_UNSIGNED_INT ? 4 : 0);
+	}
+
+	// Bytes per component for the types glVertexAttribPointer accepts here, or 0 for anything else.
+	size_t componentSize(uint32_t type, bool integer) {
+		switch (type) {
+			case GL_BYTE: case GL_UNSIGNED_BYTE: return 1;
+			case GL_SHORT: case GL_UNSIGNED_SHORT: return 2;
+			case GL_INT: case GL_UNSIGNED_INT: return 4;
+			case GL_FLOAT: return integer ? 0 : 4;
+		}
+		return 0;
+	}
+
+	// Whether 'count' elements of 'elementSize' bytes starting at 'offset' fit in 'size' bytes.
+	//		Divides rather than multiplies, so a crafted count can't wrap past the check.
+	bool blobFits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t size) {
+		return offset <= size && count <= (size - offset) / elementSize;
+	}
+
+	// GL_MAX_VERTEX_ATTRIBS and GL_MAX_VERTEX_ATTRIB_STRIDE are at least this everywhere.
+	const uint32_t MAX_ATTRIBUTE_LOCATIONS = 16;
+	const uint32_t MAX_STRIDE = 2048;
+}
+
+MeshFile::MeshFile() {
+	close();
+}
+
+void MeshFile::close() {
+	file.close();
+	vertexLayout = VertexLayout();
+	levels.clear();
+	vertices = nullptr;
+	indices = nullptr;
+	vertexTotal = 0;
+	indexTotal = 0;
+	indexFormat = GL_UNSIGNED_INT;
+	minimum = maximum = glm::vec3(0.0f);
+	dequantizationInfo = Dequantization();
+	quantized = false;
+}
+
+bool MeshFile::open(const char* path) {
+	close();
+
+	if (!file.open(path) || file.size() < sizeof(MeshHeader)) {
+		cout << "ERROR::MESH_FILE::FILE_NOT_SUCCESFULLY_READ: " << path << endl;
+		file.close();
+		return false;
+	}
+
+	MeshHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+
+	// Both counts are 32 bits, so the table size can't overflow 64.
+	uint64_t tables = sizeof(MeshHeader) + (uint64_t)header.attributeCount * sizeof(MeshAttribute) + (uint64_t)header.lodCount * sizeof(MeshLodEntry);
+
+	if (memcmp(header.magic, MESH_MAGIC, sizeof(MESH_MAGIC)) != 0 || header.version != MESH_VERSION ||
+		header.stride == 0 || header.stride > MAX_STRIDE || header.attributeCount == 0 || header.attributeCount > MAX_ATTRIBUTE_LOCATIONS ||
+		indexSize(header.indexType) == 0 || tables > file.size() || header.vertexOffset < tables || header.indexOffset < tables ||
+		!blobFits(header.vertexOffset, header.vertexCount, header.stride, file.size()) ||
+		!blobFits(header.indexOffset, header.indexCount, indexSize(header.indexType), file.size())) {
+		cout << "ERROR::MESH_FILE::INVALID_OR_OLD_VERSION: " << path << endl;
+		file.close();
+		return false;
+	}
+
+	const unsigned char* table = file.data() + sizeof(MeshHeader);
+	vertexLayout.stride = (GLsizei)header.stride;
+	for (uint32_t i = 0; i < header.attributeCount; i++) {
+		MeshAttribute stored;
+		memcpy(&stored, table + i * sizeof(MeshAttribute), sizeof(stored));
+		if ((uint64_t)stored.offset + stored.size > header.stride ||
+			(uint64_t)stored.offset + stored.components * componentSize(stored.type, stored.integer != 0) > header.stride) {
+			cout << "ERROR::MESH_FILE::ATTRIBUTE_OUTSIDE_VERTEX: " << path << endl;
+			close();
+			return false;
+		}
+
+		// Everything here goes straight to glVertexAttrib(I)Pointer, which only takes these.
+		if (stored.location >= MAX_ATTRIBUTE_LOCATIONS || stored.components < 1 || stored.components > 4 ||
+			componentSize(stored.type, stored.integer != 0) == 0) {
+			cout << "ERROR::MESH_FILE::UNSUPPORTED_ATTRIBUTE: " << path << endl;
+			close();
+			return false;
+		}
+
+		VertexAttribute attribute = { stored.location, (GLint)stored.components, (GLenum)stored.type,
+			stored.normalized != 0, stored.integer != 0, stored.offset, stored.size };
+		vertexLayout.attributes.push_back(attribute);
+	}
+
+	table += header.attributeCount * sizeof(MeshAttribute);
+	for (uint32_t i = 0; i < header.lodCount; i++) {
+		MeshLodEntry stored;
+		memcpy(&stored, table + i * sizeof(MeshLodEntry), sizeof(stored));
+		if ((uint64_t)stored.firstIndex + stored.indexCount > header.indexCount)
+			continue;
+
+		MeshLod lod;
+		lod.firstIndex = stored.firstIndex;
+		lod.indexCount = stored.indexCount;
+		lod.error = stored.error;
+		levels.push_back(lod);
+	}
+	if (levels.empty()) {
+		MeshLod full;
+		full.indexCount = (unsigned int)header.indexCount;
+		levels.push_back(full);
+	}
+
+	vertices = file.data() + header.vertexOffset;
+	indices = file.data() + header.indexOffset;
+	vertexTotal = (size_t)header.vertexCount;
+	indexTotal = (size_t)header.indexCount;
+	indexFormat = (GLenum)header.indexType;
+	minimum = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+	maximum = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+
+	quantized = (header.flags & FLAG_QUANTIZED) != 0;
+	if (quantized) {
+		dequantizationInfo.positionScale = glm::vec3(header.positionScale[0], header.positionScale[1], header.positionScale[2]);
+		dequantizationInfo.positionOffset = glm::vec3(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]);
+		dequantizationInfo.texCoordScale = glm::vec2(header.texCoordScale[0], header.texCoordScale[1]);
+		dequantizationInfo.texCoordOffset = glm::vec2(header.texCoordOffset[0], header.texCoordOffset[1]);
+	}
+	return true;
+}
+
+bool MeshFile::write(const char* path, const VertexLayout& layout, const void* vertexData, size_t vertexCount,
+	const void* indexData, size_t indexCount, GLenum indexType, const vector<MeshLod>& lods, const Dequantization* dequantization) {
+	if (indexSize(indexType) == 0 || layout.stride <= 0 || layout.attributes.empty()) {
+		cout << "ERROR::MESH_FILE::UNSUPPORTED_MESH " << path << endl;
+		return false;
+	}
+
+	MeshHeader header = {};
+	memcpy(header.magic, MESH_MAGIC, sizeof(MESH_MAGIC));
+	header.version = MESH_VERSION;
+	header.stride = (uint32_t)layout.stride;
+	header.attributeCount = (uint32_t)layout.attributes.size();
+	header.indexType = indexType;
+	header.vertexCount = vertexCount;
+	header.indexCount = indexCount;
+
+	vector<MeshLodEntry> lodTable;
+	for (const MeshLod& lod : lods)
+		lodTable.push_back({ lod.firstIndex, lod.indexCount, lod.error, 0 });
+	if (lodTable.empty())
+		lodTable.push_back({ 0, (uint32_t)indexCount, 0.0f, 0 });
+	header.lodCount = (uint32_t)lodTable.size();
+
+	// Bounds, from the float positions if there are any, otherwise from the quantization range.
+	glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+	vector<glm::vec3> positions;
+	if (dequantization) {
+		header.flags |= FLAG_QUANTIZED;
+		boundsMin = dequantization->positionOffset;
+		boundsMax = dequantization->positionOffset + dequantization->positionScale;
+
+		header.positionScale[0] = dequantization->positionScale.x;
+		header.positionScale[1] = dequantization->positionScale.y;
+		header.positionScale[2] = dequantization->positionScale.z;
+		header.positionOffset[0] = dequantization->positionOffset.x;
+		header.positionOffset[1] = dequantization->positionOffset.y;
+		header.positionOffset[2] = dequantization->positionOffset.z;
+		header.texCoordScale[0] = dequantization->texCoordScale.x;
+		header.texCoordScale[1] = dequantization->texCoordScale.y;
+		header.texCoordOffset[0] = dequantization->texCoordOffset.x;
+		header.texCoordOffset[1] = dequantization->texCoordOffset.y;
+	}
+	else if (vertexCount > 0 && layout.readPositions(vertexData, vertexCount, positions)) {
+		boundsMin = boundsMax = positions[0];
+		for (const glm::vec3& p : positions) {
+			boundsMin = glm::min(boundsMin, p);
+			boundsMax = glm::max(boundsMax, p);
+		}
+	}
+	header.boundsMin[0] = boundsMin.x; header.boundsMin[1] = boundsMin.y; header.boundsMin[2] = boundsMin.z;
+	header.boundsMax[0] = boundsMax.x; header.boundsMax[1] = boundsMax.y; header.boundsMax[2] = boundsMax.z;
+
+	vector<MeshAttribute> attributes;
+	for (const VertexAttribute& attribute : layout.attributes)
+		attributes.push_back({ attribute.location, (uint32_t)attribute.components, attribute.type,
+			attribute.normalized ? 1u : 0u, attribute.integer ? 1u : 0u, attribute.offset, attribute.size });
+
+	size_t vertexBytes = vertexCount * layout.stride;
+	size_t indexBytes = indexCount * indexSize(indexType);
+	size_t tables = sizeof(MeshHeader) + attributes.size() * sizeof(MeshAttribute) + lodTable.size() * sizeof(MeshLodEntry);
+	header.vertexOffset = alignUp(tables);
+	header.indexOffset = alignUp(header.vertexOffset + vertexBytes);
+
+	// Same temporary-then-rename approach as the texture cache, so a half-written mesh is never opened.
+	string tempPath = string(path) + ".tmp";
+	{
+		ofstream out(tempPath, ios::binary);
+		if (!out) {
+			cout << "ERROR::MESH_FILE::FILE_NOT_SUCCESSFULLY_WRITTEN " << tempPath << endl;
+			return false;
+		}
+
+		const char padding[BLOB_ALIGNMENT] = {};
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)attributes.data(), attributes.size() * sizeof(MeshAttribute));
+		out.write((const char*)lodTable.data(), lodTable.size() * sizeof(MeshLodEntry));
+		out.write(padding, header.vertexOffset - tables);
+		out.write((const char*)vertexData, vertexBytes);
+		out.write(padding, header.indexOffset - (header.vertexOffset + vertexBytes));
+		out.write((const char*)indexData, indexBytes);
+
+		if (!out) {
+			out.close();
+			remove(tempPath.c_str());
+			cout << "ERROR::MESH_FILE::FILE_NOT_SUCCESSFULLY_WRITTEN " << tempPath << endl;
+			return false;
+		}
+	}
+
+	remove(path);
+	if (rename(tempPath.c_str(), path) != 0) {
+		remove(tempPath.c_str());
+		cout << "ERROR::MESH_FILE::FILE_NOT_SUCCESSFULLY_WRITTEN " << path << endl;
+		return false;
+	}
+	return true;
+}
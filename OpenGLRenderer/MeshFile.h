@@ -0,0 +1,94 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Local Library Includes
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "VertexLayout.h"
+#include "VertexQuantizer.h"
+
+// Standard Library Includes
+#include <vector>
+
+using namespace std;
+
+// One level of detail: a range of the shared index buffer, and the error (in mesh units) it was simplified to.
+struct MeshLod {
+	unsigned int firstIndex = 0;
+	unsigned int indexCount = 0;
+	float error = 0.0f;
+};
+
+// The runtime mesh format ("MESH" files): everything needed to draw a mesh, already in GPU layout.
+//
+//		Header, attribute table and LOD table come first, then the vertex and index blobs, each starting on a
+//		64-byte boundary. Opening a file maps it and checks the tables; the blobs are never parsed, and
+//		vertexData()/indexData() point straight into the mapping, ready for glBufferData or a single memcpy
+//		into a mapped or queued buffer. The file stays mapped while the MeshFile is open.
+class MeshFile {
+
+	private:
+		MappedFile file;
+		VertexLayout vertexLayout;
+		vector<MeshLod> levels;
+		const unsigned char* vertices;
+		const unsigned char* indices;
+		size_t vertexTotal;
+		size_t indexTotal;
+		GLenum indexFormat;
+		glm::vec3 minimum, maximum;
+		Dequantization dequantizationInfo;
+		bool quantized;
+
+	public:
+		// Constructor
+		MeshFile();
+
+		MeshFile(const MeshFile&) = delete;
+		MeshFile& operator=(const MeshFile&) = delete;
+
+		// Functions
+		bool open(const char* path);
+		void close();
+		bool isOpen() const { return vertices != nullptr; }
+
+		const VertexLayout& layout() const { return vertexLayout; }
+		const void* vertexData() const { return vertices; }
+		size_t vertexCount() const { return vertexTotal; }
+		size_t vertexBytes() const { return vertexTotal * vertexLayout.stride; }
+
+		const void* indexData() const { return indices; }
+		size_t indexCount() const { return indexTotal; }			// Every LOD's indices together.
+		GLenum indexType() const { return indexFormat; }
+
+		// Never empty for an open file; LOD 0 is the full mesh.
+		const vector<MeshLod>& lods() const { return levels; }
+
+		glm::vec3 boundsMin() const { return minimum; }
+		glm::vec3 boundsMax() const { return maximum; }
+
+		// Set for meshes written from a QuantizedMesh.
+		bool isQuantized() const { return quantized; }
+		const Dequantization& dequantization() const { return dequantizationInfo; }
+
+		// Writes a mesh. Without LODs, one covering every index is stored.
+		//		Bounds come from the float positions at location 0, or from the dequantization range.
+		static bool write(const char* path, const VertexLayout& layout, const void* vertexData, size_t vertexCount,
+			const void* indexData, size_t indexCount, GLenum indexType, const vector<MeshLod>& lods = vector<MeshLod>(), const Dequantization* dequantization = nullptr);
+
+		template<typename Vertex>
+		static bool write(const char* path, const vector<Vertex>& vertices, const PackedIndices& indices, const vector<MeshLod>& lods = vector<MeshLod>()) {
+			return write(path, VertexLayout::of<Vertex>(), vertices.data(), vertices.size(), indices.data(), indices.count, indices.type, lods);
+		}
+
+		static bool write(const char* path, const QuantizedMesh& mesh, const vector<MeshLod>& lods = vector<MeshLod>()) {
+			PackedIndices indices = MeshOptimizer::packIndices(mesh.indices, mesh.vertices.size());
+			return write(path, VertexLayout::of<QuantizedVertex>(), mesh.vertices.data(), mesh.vertices.size(),
+				indices.data(), indices.count, indices.type, lods, &mesh.dequantization);
+		}
+};
@@ -0,0 +1,238 @@
+#include "MeshOptimizer.h"
+
+// Standard Library Includes
+#include <algorithm>
+
+// ---
+// Analysis
+// ---
+VertexCacheStats MeshOptimizer::analyzeVertexCache(const vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize) {
+	VertexCacheStats stats;
+	if (indices.size() < 3 || vertexCount == 0)
+		return stats;
+
+	// A vertex is in the FIFO while fewer than cacheSize others have been inserted after it.
+	vector<size_t> insertedAt(vertexCount, 0);
+	vector<char> referenced(vertexCount, 0);
+	size_t clock = cacheSize + 1;
+	size_t unique = 0;
+
+	for (unsigned int index : indices) {
+		if (index >= vertexCount)
+			continue;
+
+		if (clock - insertedAt[index] > cacheSize) {
+			insertedAt[index] = clock++;
+			stats.transformed++;
+		}
+		if (!referenced[index]) {
+			referenced[index] = 1;
+			unique++;
+		}
+	}
+
+	stats.acmr = (float)stats.transformed / (float)(indices.size() / 3);
+	stats.atvr = unique > 0 ? (float)stats.transformed / (float)unique : 0.0f;
+	return stats;
+}
+
+// ---
+// Vertex cache
+// ---
+vector<unsigned int> MeshOptimizer::optimizeVertexCache(const vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize, vector<size_t>* clusters) {
+	size_t triangleCount = indices.size() / 3;
+	vector<unsigned int> output;
+	output.reserve(triangleCount * 3);
+
+	for (unsigned int index : indices) {
+		if (index >= vertexCount) {
+			cout << "ERROR::MESH_OPTIMIZER::INDEX_OUT_OF_RANGE" << endl;
+			return indices;
+		}
+	}
+
+	// Triangles around each vertex, packed into one array, and how many of them are still to be emitted.
+	vector<unsigned int> liveTriangles(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		liveTriangles[indices[i]]++;
+
+	vector<unsigned int> adjacencyStart(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+		adjacencyStart[v + 1] = adjacencyStart[v] + liveTriangles[v];
+
+	vector<unsigned int> adjacency(triangleCount * 3);
+	vector<unsigned int> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+
+	vector<unsigned int> cachedAt(vertexCount, 0);
+	unsigned int clock = cacheSize + 1;
+	vector<char> emitted(triangleCount, 0);
+	vector<unsigned int> deadEnds;
+	vector<unsigned int> candidates;
+	size_t cursor = 0;
+
+	// Fan out from one vertex at a time, emitting all of its remaining triangles.
+	auto nextUnfinished = [&]() -> long long {
+		while (!deadEnds.empty()) {
+			unsigned int vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveTriangles[vertex] > 0)
+				return vertex;
+		}
+		while (cursor < vertexCount) {
+			if (liveTriangles[cursor] > 0)
+				return (long long)cursor;
+			cursor++;
+		}
+		return -1;
+	};
+
+	long long fanning = nextUnfinished();
+	if (clusters && fanning >= 0)
+		clusters->push_back(0);
+
+	while (fanning >= 0) {
+		candidates.clear();
+
+		for (unsigned int a = adjacencyStart[fanning]; a < adjacencyStart[fanning + 1]; a++) {
+			unsigned int triangle = adjacency[a];
+			if (emitted[triangle])
+				continue;
+
+			for (int corner = 0; corner < 3; corner++) {
+				unsigned int vertex = indices[triangle * 3 + corner];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+
+				if (clock - cachedAt[vertex] > cacheSize)
+					cachedAt[vertex] = clock++;
+			}
+			emitted[triangle] = 1;
+		}
+
+		// Prefer the candidate that has been in the cache longest, as long as fanning it
+		//		(at most two new vertices per remaining triangle) won't push it out first.
+		long long best = -1;
+		int bestPriority = -1;
+		for (unsigned int vertex : candidates) {
+			if (liveTriangles[vertex] == 0)
+				continue;
+
+			int priority = 0;
+			unsigned int age = clock - cachedAt[vertex];
+			if (age + 2 * liveTriangles[vertex] <= cacheSize)
+				priority = (int)age;
+
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = vertex;
+			}
+		}
+
+		// Nothing local is left: jump elsewhere, which is where one cluster ends and the next begins.
+		if (best < 0) {
+			best = nextUnfinished();
+			if (clusters && best >= 0 && clusters->back() != output.size() / 3)
+				clusters->push_back(output.size() / 3);
+		}
+		fanning = best;
+	}
+
+	return output;
+}
+
+// ---
+// Overdraw
+// ---
+void MeshOptimizer::optimizeOverdraw(vector<unsigned int>& indices, const vector<glm::vec3>& positions, const vector<size_t>& clusters) {
+	size_t triangleCount = indices.size() / 3;
+	if (clusters.size() < 2 || triangleCount == 0)
+		return;
+
+	glm::vec3 meshCentroid(0.0f);
+	for (unsigned int index : indices)
+		meshCentroid = meshCentroid + positions[index];
+	meshCentroid = meshCentroid / (float)indices.size();
+
+	struct Cluster {
+		size_t begin, end;
+		float occlusion;
+	};
+	vector<Cluster> sorted;
+	sorted.reserve(clusters.size());
+
+	for (size_t c = 0; c < clusters.size(); c++) {
+		Cluster cluster;
+		cluster.begin = clusters[c];
+		cluster.end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+
+		// Area weighted centroid and normal of the cluster.
+		glm::vec3 centroid(0.0f), normal(0.0f);
+		float area = 0.0f;
+		for (size_t t = cluster.begin; t < cluster.end; t++) {
+			const glm::vec3& a = positions[indices[t * 3 + 0]];
+			const glm::vec3& b = positions[indices[t * 3 + 1]];
+			const glm::vec3& c2 = positions[indices[t * 3 + 2]];
+			glm::vec3 cross = glm::cross(b - a, c2 - a);
+			float triangleArea = glm::length(cross);
+
+			centroid = centroid + (a + b + c2) * (triangleArea / 3.0f);
+			normal = normal + cross;
+			area += triangleArea;
+		}
+
+		cluster.occlusion = 0.0f;
+		float normalLength = glm::length(normal);
+		if (area > 0.0f && normalLength > 0.0f)
+			cluster.occlusion = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+		sorted.push_back(cluster);
+	}
+
+	// Clusters on the outside of the mesh facing outwards tend to hide the rest, so they go first.
+	stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.occlusion > b.occlusion; });
+
+	vector<unsigned int> output;
+	output.reserve(indices.size());
+	for (const Cluster& cluster : sorted)
+		output.insert(output.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+	indices.swap(output);
+}
+
+// ---
+// Vertex fetch and index packing
+// ---
+vector<unsigned int> MeshOptimizer::optimizeVertexFetch(vector<unsigned int>& indices, size_t vertexCount) {
+	vector<unsigned int> remap(vertexCount, ~0u);
+	unsigned int next = 0;
+
+	for (unsigned int& index : indices) {
+		if (index >= vertexCount)
+			continue;
+		if (remap[index] == ~0u)
+			remap[index] = next++;
+		index = remap[index];
+	}
+	return remap;
+}
+
+PackedIndices MeshOptimizer::packIndices(const vector<unsigned int>& indices, size_t vertexCount) {
+	PackedIndices packed;
+	packed.count = indices.size();
+
+	if (vertexCount <= 65536) {
+		packed.type = GL_UNSIGNED_SHORT;
+		packed.bytes.resize(indices.size() * sizeof(unsigned short));
+		unsigned short* shorts = (unsigned short*)packed.bytes.data();
+		for (size_t i = 0; i < indices.size(); i++)
+			shorts[i] = (unsigned short)indices[i];
+	}
+	else {
+		packed.type = GL_UNSIGNED_INT;
+		packed.bytes.resize(indices.size() * sizeof(unsigned int));
+		memcpy(packed.bytes.data(), indices.data(), packed.bytes.size());
+	}
+	return packed;
+}
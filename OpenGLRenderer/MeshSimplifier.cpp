@@ -0,0 +1,383 @@
+#include "MeshSimplifier.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+	// The sum of squared distances to a set of planes, as a symmetric 4x4 matrix (upper triangle).
+	struct Quadric {
+		double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+		double b0 = 0, b1 = 0, b2 = 0;
+		double c = 0;
+		double area = 0;
+
+		void addPlane(const glm::vec3& n, float d, double weight) {
+			a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z;
+			a11 += weight * n.y * n.y; a12 += weight * n.y * n.z; a22 += weight * n.z * n.z;
+			b0 += weight * n.x * d; b1 += weight * n.y * d; b2 += weight * n.z * d;
+			c += weight * d * d;
+			area += weight;
+		}
+
+		void add(const Quadric& q) {
+			a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2;
+			c += q.c;
+			area += q.area;
+		}
+
+		// Area weighted mean squared distance from p to the planes.
+		double error(const glm::vec3& p) const {
+			double x = p.x, y = p.y, z = p.z;
+			double sum = a00 * x * x + a11 * y * y + a22 * z * z
+				+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+				+ 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return area > 0.0 ? max(sum, 0.0) / area : 0.0;
+		}
+	};
+
+	struct Collapse {
+		unsigned int from;
+		unsigned int to;
+		float cost;		// Squared error in mesh units.
+	};
+
+	struct PositionKey {
+		uint32_t x, y, z;
+		bool operator==(const PositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+	};
+
+	struct PositionHash {
+		size_t operator()(const PositionKey& key) const {
+			return (size_t)(key.x * 73856093u ^ key.y * 19349663u ^ key.z * 83492791u);
+		}
+	};
+
+	PositionKey keyOf(const glm::vec3& p) {
+		PositionKey key;
+		memcpy(&key.x, &p.x, 4);
+		memcpy(&key.y, &p.y, 4);
+		memcpy(&key.z, &p.z, 4);
+		return key;
+	}
+
+	// What collapses carry from one level to the next: locked vertices, and each vertex's quadric. The quadrics
+	//		start from the original triangles and are only ever merged, so they keep measuring distance to the
+	//		original surface however many levels a vertex has moved through.
+	struct SimplifierState {
+		vector<char> locked;
+		vector<Quadric> quadrics;
+		float attributeScaleSquared = 0.0f;
+	};
+
+	void prepare(const SimplifierMesh& mesh, const vector<unsigned int>& triangles, float attributeWeight, SimplifierState& state) {
+		const vector<glm::vec3>& positions = mesh.positions;
+		size_t vertexCount = positions.size();
+
+		// ---
+		// Locked vertices: seams (several vertices at one position) and anything on an open or non-manifold edge.
+		// ---
+		vector<char>& locked = state.locked;
+		locked.assign(vertexCount, 0);
+		unordered_map<PositionKey, unsigned int, PositionHash> firstAtPosition;
+		vector<unsigned int> canonical(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++) {
+			auto inserted = firstAtPosition.insert(make_pair(keyOf(positions[v]), (unsigned int)v));
+			canonical[v] = inserted.first->second;
+			if (!inserted.second) {
+				locked[v] = 1;
+				locked[inserted.first->second] = 1;
+			}
+		}
+
+		unordered_map<uint64_t, int> edges;
+		auto edgeKey = [&](unsigned int a, unsigned int b) { return ((uint64_t)canonical[a] << 32) | canonical[b]; };
+		for (size_t i = 0; i < triangles.size(); i += 3) {
+			for (int e = 0; e < 3; e++)
+				edges[edgeKey(triangles[i + e], triangles[i + (e + 1) % 3])]++;
+		}
+		for (size_t i = 0; i < triangles.size(); i += 3) {
+			for (int e = 0; e < 3; e++) {
+				unsigned int a = triangles[i + e], b = triangles[i + (e + 1) % 3];
+				auto opposite = edges.find(edgeKey(b, a));
+				if (opposite == edges.end() || opposite->second != 1 || edges[edgeKey(a, b)] != 1) {
+					locked[a] = 1;
+					locked[b] = 1;
+				}
+			}
+		}
+
+		// ---
+		// Plane quadrics, area weighted, and the scale attribute differences are measured against.
+		// ---
+		vector<Quadric>& quadrics = state.quadrics;
+		quadrics.assign(vertexCount, Quadric());
+		for (size_t i = 0; i < triangles.size(); i += 3) {
+			const glm::vec3& p0 = positions[triangles[i]];
+			const glm::vec3& p1 = positions[triangles[i + 1]];
+			const glm::vec3& p2 = positions[triangles[i + 2]];
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float doubleArea = glm::length(normal);
+			if (doubleArea <= 0.0f)
+				continue;
+
+			normal = normal / doubleArea;
+			float d = -glm::dot(normal, p0);
+			for (int c = 0; c < 3; c++)
+				quadrics[triangles[i + c]].addPlane(normal, d, doubleArea * 0.5);
+		}
+
+		glm::vec3 minPos = positions.empty() ? glm::vec3(0.0f) : positions[0], maxPos = minPos;
+		for (const glm::vec3& p : positions) {
+			minPos = glm::min(minPos, p);
+			maxPos = glm::max(maxPos, p);
+		}
+		float attributeScale = attributeWeight * glm::length(maxPos - minPos);
+		state.attributeScaleSquared = attributeScale * attributeScale;
+	}
+
+	// Collapse edges of 'triangles' in place, cheapest first, until the index count reaches the target or the next
+	//		collapse would cost more than maxCost. 'resultError' is raised to the largest error of any collapse made.
+	void collapseEdges(const SimplifierMesh& mesh, SimplifierState& state, vector<unsigned int>& triangles, size_t targetIndexCount,
+		float maxCost, float& resultError) {
+		const vector<glm::vec3>& positions = mesh.positions;
+		size_t vertexCount = positions.size();
+		const vector<char>& locked = state.locked;
+		vector<Quadric>& quadrics = state.quadrics;
+
+		auto attributeError = [&](unsigned int a, unsigned int b) {
+			float sum = 0.0f;
+			const float* x = mesh.attributes.data() + a * mesh.attributeCount;
+			const float* y = mesh.attributes.data() + b * mesh.attributeCount;
+			for (size_t k = 0; k < mesh.attributeCount; k++)
+				sum += (x[k] - y[k]) * (x[k] - y[k]);
+			return sum * state.attributeScaleSquared;
+		};
+
+		// ---
+		// Passes of greedy collapses. Each pass sorts every candidate by cost and takes those that don't touch the
+		//		neighbourhood of a collapse already made in the pass, so the flip test always sees current triangles.
+		// ---
+		vector<unsigned int> remap(vertexCount);
+		vector<char> touched(vertexCount);
+		vector<unsigned int> adjacencyStart(vertexCount + 1);
+		vector<unsigned int> adjacency;
+		vector<Collapse> collapses;
+
+		while (triangles.size() > targetIndexCount) {
+			// Triangles around each vertex.
+			fill(adjacencyStart.begin(), adjacencyStart.end(), 0);
+			for (unsigned int index : triangles)
+				adjacencyStart[index + 1]++;
+			for (size_t v = 0; v < vertexCount; v++)
+				adjacencyStart[v + 1] += adjacencyStart[v];
+			adjacency.resize(triangles.size());
+			vector<unsigned int> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+			for (size_t i = 0; i < triangles.size(); i++)
+				adjacency[cursor[triangles[i]]++] = (unsigned int)(i / 3);
+
+			collapses.clear();
+			for (size_t i = 0; i < triangles.size(); i += 3) {
+				for (int e = 0; e < 3; e++) {
+					unsigned int a = triangles[i + e], b = triangles[i + (e + 1) % 3];
+					for (int direction = 0; direction < 2; direction++) {
+						unsigned int from = direction ? b : a, to = direction ? a : b;
+						if (locked[from])
+							continue;
+
+						Quadric merged = quadrics[from];
+						merged.add(quadrics[to]);
+						float cost = (float)merged.error(positions[to]) + attributeError(from, to);
+						if (cost <= maxCost)
+							collapses.push_back({ from, to, cost });
+					}
+				}
+			}
+			if (collapses.empty())
+				break;
+			sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+			for (size_t v = 0; v < vertexCount; v++)
+				remap[v] = (unsigned int)v;
+			fill(touched.begin(), touched.end(), 0);
+
+			// Each collapse removes about two triangles.
+			size_t wanted = (triangles.size() - targetIndexCount) / 6 + 1;
+			size_t made = 0;
+
+			for (const Collapse& collapse : collapses) {
+				if (made >= wanted)
+					break;
+				if (touched[collapse.from] || touched[collapse.to])
+					continue;
+
+				// Moving 'from' onto 'to' must not flip or flatten any triangle that survives.
+				bool flips = false;
+				for (unsigned int a = adjacencyStart[collapse.from]; a < adjacencyStart[collapse.from + 1] && !flips; a++) {
+					const unsigned int* t = &triangles[adjacency[a] * 3];
+					if (t[0] == collapse.to || t[1] == collapse.to || t[2] == collapse.to)
+						continue;
+
+					glm::vec3 p[3], q[3];
+					for (int c = 0; c < 3; c++) {
+						p[c] = positions[t[c]];
+						q[c] = positions[t[c] == collapse.from ? collapse.to : t[c]];
+					}
+					glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+					glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+					if (glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after))
+						flips = true;
+				}
+				if (flips)
+					continue;
+
+				remap[collapse.from] = collapse.to;
+				quadrics[collapse.to].add(quadrics[collapse.from]);
+				resultError = max(resultError, sqrtf(collapse.cost));
+				made++;
+
+				touched[collapse.to] = 1;
+				for (unsigned int a = adjacencyStart[collapse.from]; a < adjacencyStart[collapse.from + 1]; a++) {
+					const unsigned int* t = &triangles[adjacency[a] * 3];
+					touched[t[0]] = touched[t[1]] = touched[t[2]] = 1;
+				}
+			}
+			if (made == 0)
+				break;
+
+			// Apply the pass and drop triangles that collapsed to a line.
+			size_t write = 0;
+			for (size_t i = 0; i < triangles.size(); i += 3) {
+				unsigned int a = remap[triangles[i]], b = remap[triangles[i + 1]], c = remap[triangles[i + 2]];
+				if (a == b || b == c || a == c)
+					continue;
+				triangles[write++] = a;
+				triangles[write++] = b;
+				triangles[write++] = c;
+			}
+			triangles.resize(write);
+		}
+	}
+
+	bool indicesInRange(const vector<unsigned int>& triangles, size_t vertexCount) {
+		for (unsigned int index : triangles) {
+			if (index >= vertexCount)
+				return false;
+		}
+		return true;
+	}
+}
+
+SimplifierMesh SimplifierMesh::fromLayout(const VertexLayout& layout, const void* vertexData, size_t vertexCount, const vector<unsigned int>& indices) {
+	SimplifierMesh mesh;
+	mesh.indices = indices;
+	layout.readPositions(vertexData, vertexCount, mesh.positions);
+
+	// Every float attribute except the position is compared when scoring collapses.
+	vector<const VertexAttribute*> compared;
+	for (const VertexAttribute& attribute : layout.attributes) {
+		if (attribute.location != 0 && attribute.type == GL_FLOAT && !attribute.integer) {
+			compared.push_back(&attribute);
+			mesh.attributeCount += attribute.components;
+		}
+	}
+
+	mesh.attributes.resize(vertexCount * mesh.attributeCount);
+	const unsigned char* base = (const unsigned char*)vertexData;
+	for (size_t v = 0; v < vertexCount; v++) {
+		float* out = mesh.attributes.data() + v * mesh.attributeCount;
+		for (const VertexAttribute* attribute : compared) {
+			memcpy(out, base + v * layout.stride + attribute->offset, attribute->components * sizeof(float));
+			out += attribute->components;
+		}
+	}
+	return mesh;
+}
+
+vector<unsigned int> MeshSimplifier::simplify(const SimplifierMesh& mesh, const vector<unsigned int>& indices, size_t targetIndexCount,
+	float targetError, float attributeWeight, float& resultError) {
+	resultError = 0.0f;
+	vector<unsigned int> triangles(indices.begin(), indices.begin() + indices.size() / 3 * 3);
+	if (!indicesInRange(triangles, mesh.positions.size()))
+		return triangles;
+
+	SimplifierState state;
+	prepare(mesh, triangles, attributeWeight, state);
+	collapseEdges(mesh, state, triangles, targetIndexCount, targetError * targetError, resultError);
+	return triangles;
+}
+
+void MeshSimplifier::buildLods(SimplifierMesh& mesh, const LodSettings& settings) {
+	vector<unsigned int> full = mesh.indices;
+	mesh.lods.clear();
+
+	MeshLod first;
+	first.indexCount = (unsigned int)full.size();
+	mesh.lods.push_back(first);
+
+	glm::vec3 minPos = mesh.positions.empty() ? glm::vec3(0.0f) : mesh.positions[0], maxPos = minPos;
+	for (const glm::vec3& p : mesh.positions) {
+		minPos = glm::min(minPos, p);
+		maxPos = glm::max(maxPos, p);
+	}
+	float diagonal = glm::length(maxPos - minPos);
+
+	vector<unsigned int> previous(full.begin(), full.begin() + full.size() / 3 * 3);
+	if (!indicesInRange(previous, mesh.positions.size()))
+		return;
+
+	// Each level starts from the previous one, but the quadrics are the original mesh's, merged along with the
+	//		vertices, so a level's error is measured against LOD 0 rather than the level before it.
+	//		A rejected level's collapses are thrown away with its quadrics.
+	SimplifierState state;
+	prepare(mesh, previous, settings.attributeWeight, state);
+
+	float accumulatedError = 0.0f;
+	for (float target : settings.errorTargets) {
+		size_t targetCount = (size_t)(previous.size() / 3 * settings.reduction) * 3;
+		float levelError = accumulatedError;
+		float maxCost = target * diagonal;
+		SimplifierState levelState = state;
+		vector<unsigned int> level = previous;
+		collapseEdges(mesh, levelState, level, targetCount, maxCost * maxCost, levelError);
+
+		if (level.empty() || level.size() > previous.size() * settings.minimumGain)
+			continue;
+
+		accumulatedError = levelError;
+		state.quadrics.swap(levelState.quadrics);
+		MeshLod lod;
+		lod.firstIndex = (unsigned int)mesh.indices.size();
+		lod.indexCount = (unsigned int)level.size();
+		lod.error = accumulatedError;
+		mesh.indices.insert(mesh.indices.end(), level.begin(), level.end());
+		mesh.lods.push_back(lod);
+		previous.swap(level);
+	}
+}
+
+void MeshSimplifier::buildLods(vector<SimplifierMesh>& meshes, const LodSettings& settings, WorkerPool& pool) {
+	pool.parallelFor(meshes.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			buildLods(meshes[i], settings);
+	});
+}
+
+// An error of e units at distance d covers e / (2 d tan(fovY / 2)) of the viewport's height.
+size_t MeshSimplifier::selectLod(const vector<MeshLod>& lods, float distance, float fovY, int viewportHeight, float maxPixelError) {
+	if (lods.empty() || distance <= 0.0f)
+		return 0;
+
+	float pixelsPerUnit = viewportHeight / (2.0f * distance * tanf(fovY * 0.5f));
+	size_t chosen = 0;
+	for (size_t i = 1; i < lods.size(); i++) {
+		if (lods[i].error * pixelsPerUnit <= maxPixelError)
+			chosen = i;
+	}
+	return chosen;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Local Library Includes
+#include "MeshFile.h"
+#include "VertexLayout.h"
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <vector>
+
+using namespace std;
+
+struct LodSettings {
+	// Error allowed at each level, as a fraction of the mesh's bounding box diagonal. One LOD is made per entry.
+	vector<float> errorTargets = { 0.002f, 0.008f, 0.03f, 0.1f };
+	float reduction = 0.5f;			// Each level aims for at most this fraction of the previous level's triangles.
+	float attributeWeight = 0.01f;	// A full-range change in a vertex attribute counts like this fraction of the diagonal in error.
+	float minimumGain = 0.9f;		// Levels keeping more than this fraction of the previous level's triangles are skipped.
+};
+
+// A mesh as the simplifier sees it: positions, the float attributes of each vertex (colour, UV, normal, ...)
+//		and the indices. buildLods() replaces the indices with every level concatenated and fills in the LOD table.
+struct SimplifierMesh {
+	vector<glm::vec3> positions;
+	vector<float> attributes;
+	size_t attributeCount = 0;		// Floats per vertex in 'attributes'.
+	vector<unsigned int> indices;
+	vector<MeshLod> lods;
+
+	static SimplifierMesh fromLayout(const VertexLayout& layout, const void* vertexData, size_t vertexCount, const vector<unsigned int>& indices);
+
+	template<typename Vertex>
+	static SimplifierMesh from(const vector<Vertex>& vertices, const vector<unsigned int>& indices) {
+		return fromLayout(VertexLayout::of<Vertex>(), vertices.data(), vertices.size(), indices);
+	}
+};
+
+// Quadric error metric simplification (Garland and Heckbert 1997) by half-edge collapse.
+//
+//		Vertices are only ever merged into other existing vertices, so every LOD indexes the original vertex buffer
+//		and a mesh's levels can live in one index buffer side by side. Each collapse is scored by the plane quadrics
+//		of the merged vertices plus how much the moving vertex's attributes differ from the one it merges into,
+//		so UV and normal detail survives longer than flat interior geometry. Open borders and attribute seams
+//		(vertices sharing a position) never move, which keeps silhouettes of open meshes and texture seams intact.
+class MeshSimplifier {
+
+	public:
+		// Functions
+		// Collapse edges, cheapest first, until the index count reaches the target or the next collapse would exceed
+		//		targetError (in mesh units). 'resultError' receives the largest error of any collapse made.
+		static vector<unsigned int> simplify(const SimplifierMesh& mesh, const vector<unsigned int>& indices, size_t targetIndexCount,
+			float targetError, float attributeWeight, float& resultError);
+
+		static void buildLods(SimplifierMesh& mesh, const LodSettings& settings = LodSettings());
+
+		// Many meshes at once, one per worker at a time.
+		static void buildLods(vector<SimplifierMesh>& meshes, const LodSettings& settings = LodSettings(), WorkerPool& pool = WorkerPool::shared());
+
+		// The coarsest LOD whose error, seen from 'distance', covers at most maxPixelError pixels.
+		static size_t selectLod(const vector<MeshLod>& lods, float distance, float fovY, int viewportHeight, float maxPixelError = 1.0f);
+};
@@ -0,0 +1,234 @@
+#include "MeshletBuilder.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// ---
+// Building
+// ---
+MeshletMesh MeshletBuilder::build(const vector<unsigned int>& indices, const vector<glm::vec3>& positions, unsigned int maxVertices, unsigned int maxTriangles) {
+	MeshletMesh mesh;
+	size_t vertexCount = positions.size();
+	size_t triangleCount = indices.size() / 3;
+
+	// Local vertex numbers are stored in a byte.
+	maxVertices = max(3u, min(maxVertices, 256u));
+	maxTriangles = max(1u, maxTriangles);
+
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		if (indices[i] >= vertexCount) {
+			cout << "ERROR::MESHLET_BUILDER::INDEX_OUT_OF_RANGE" << endl;
+			return mesh;
+		}
+	}
+
+	// Triangles around each vertex.
+	vector<unsigned int> adjacencyStart(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		adjacencyStart[indices[i] + 1]++;
+	for (size_t v = 0; v < vertexCount; v++)
+		adjacencyStart[v + 1] += adjacencyStart[v];
+	vector<unsigned int> adjacency(triangleCount * 3);
+	vector<unsigned int> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		adjacency[cursor[indices[i]]++] = (unsigned int)(i / 3);
+
+	vector<char> emitted(triangleCount, 0);
+	vector<int> localIndex(vertexCount, -1);	// Vertex number within the meshlet being built.
+	vector<unsigned int> candidates;
+	size_t nextInOrder = 0;
+
+	Meshlet current = {};
+	auto finish = [&]() {
+		if (current.triangleCount == 0)
+			return;
+		for (unsigned int v = 0; v < current.vertexCount; v++)
+			localIndex[mesh.vertices[current.vertexOffset + v]] = -1;
+		computeBounds(current, mesh, positions);
+		mesh.meshlets.push_back(current);
+
+		current = {};
+		current.vertexOffset = (unsigned int)mesh.vertices.size();
+		current.triangleOffset = (unsigned int)(mesh.triangles.size() / 3);
+		candidates.clear();
+	};
+
+	auto newVertices = [&](unsigned int triangle) {
+		unsigned int count = 0;
+		for (int c = 0; c < 3; c++)
+			count += localIndex[indices[triangle * 3 + c]] < 0 ? 1 : 0;
+		return count;
+	};
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+		// Prefer the neighbouring triangle that needs the fewest new vertices; it keeps clusters compact and round.
+		unsigned int best = ~0u, bestNew = 4;
+		size_t write = 0;
+		for (size_t i = 0; i < candidates.size(); i++) {
+			unsigned int triangle = candidates[i];
+			if (emitted[triangle])
+				continue;
+			candidates[write++] = triangle;
+
+			unsigned int added = newVertices(triangle);
+			if (added < bestNew) {
+				best = triangle;
+				bestNew = added;
+			}
+		}
+		candidates.resize(write);
+
+		// No neighbours left: continue with the next triangle in the mesh's own order.
+		if (best == ~0u) {
+			while (emitted[nextInOrder])
+				nextInOrder++;
+			best = (unsigned int)nextInOrder;
+			bestNew = newVertices(best);
+		}
+
+		if (current.vertexCount + bestNew > maxVertices || current.triangleCount >= maxTriangles) {
+			finish();
+			bestNew = newVertices(best);
+		}
+
+		for (int c = 0; c < 3; c++) {
+			unsigned int vertex = indices[best * 3 + c];
+			if (localIndex[vertex] < 0) {
+				localIndex[vertex] = (int)current.vertexCount++;
+				mesh.vertices.push_back(vertex);
+
+				for (unsigned int a = adjacencyStart[vertex]; a < adjacencyStart[vertex + 1]; a++) {
+					if (!emitted[adjacency[a]])
+						candidates.push_back(adjacency[a]);
+				}
+			}
+			mesh.triangles.push_back((unsigned char)localIndex[vertex]);
+			mesh.indices.push_back(vertex);
+		}
+		emitted[best] = 1;
+		current.triangleCount++;
+	}
+	finish();
+
+	return mesh;
+}
+
+void MeshletBuilder::computeBounds(Meshlet& meshlet, const MeshletMesh& mesh, const vector<glm::vec3>& positions) {
+	const unsigned int* vertices = &mesh.vertices[meshlet.vertexOffset];
+
+	// Sphere around the box of the vertices; within a few percent of the optimum for compact clusters.
+	glm::vec3 boxMin = positions[vertices[0]], boxMax = boxMin;
+	for (unsigned int v = 1; v < meshlet.vertexCount; v++) {
+		boxMin = glm::min(boxMin, positions[vertices[v]]);
+		boxMax = glm::max(boxMax, positions[vertices[v]]);
+	}
+	meshlet.center = (boxMin + boxMax) * 0.5f;
+	meshlet.radius = 0.0f;
+	for (unsigned int v = 0; v < meshlet.vertexCount; v++)
+		meshlet.radius = max(meshlet.radius, glm::length(positions[vertices[v]] - meshlet.center));
+
+	// Normal cone: the average facing, and how far the least aligned triangle strays from it.
+	vector<glm::vec3> normals;
+	normals.reserve(meshlet.triangleCount);
+	glm::vec3 sum(0.0f);
+	for (unsigned int t = 0; t < meshlet.triangleCount; t++) {
+		const unsigned char* local = &mesh.triangles[(meshlet.triangleOffset + t) * 3];
+		const glm::vec3& p0 = positions[vertices[local[0]]];
+		glm::vec3 normal = glm::cross(positions[vertices[local[1]]] - p0, positions[vertices[local[2]]] - p0);
+		float length = glm::length(normal);
+		if (length <= 0.0f)
+			continue;
+		normals.push_back(normal / length);
+		sum += normals.back();
+	}
+
+	meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	meshlet.coneCutoff = 1.0f;
+	float sumLength = glm::length(sum);
+	if (normals.empty() || sumLength <= 0.0f)
+		return;
+
+	meshlet.coneAxis = sum / sumLength;
+	float minDot = 1.0f;
+	for (const glm::vec3& normal : normals)
+		minDot = min(minDot, glm::dot(normal, meshlet.coneAxis));
+
+	// Normals more than 90 degrees apart: some triangle always faces the camera.
+	if (minDot > 0.0f)
+		meshlet.coneCutoff = sqrtf(1.0f - minDot * minDot);
+}
+
+// ---
+// Culling
+// ---
+
+// Every triangle faces away when the direction from the camera to any point of the cluster lies within the
+//		cone's complement. Against the bounding sphere that is: dot(center - camera, axis) >= cutoff * distance + radius.
+bool MeshletCuller::isBackFacing(const Meshlet& meshlet, const glm::vec3& cameraPos) {
+	if (meshlet.coneCutoff >= 1.0f)
+		return false;
+
+	glm::vec3 toCenter = meshlet.center - cameraPos;
+	return glm::dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius;
+}
+
+void MeshletCuller::cull(const MeshletMesh& mesh, const Frustum& frustum, const glm::vec3& cameraPos, vector<unsigned int>& visible, WorkerPool* pool, bool coneCulling) {
+	visible.clear();
+	size_t count = mesh.meshlets.size();
+
+	auto test = [&](size_t i) {
+		const Meshlet& meshlet = mesh.meshlets[i];
+		return frustum.intersectsSphere(meshlet.center, meshlet.radius) && !(coneCulling && isBackFacing(meshlet, cameraPos));
+	};
+
+	// A few thousand clusters test faster on one thread than it takes to hand them out.
+	const size_t chunk = 4096;
+	if (!pool || pool->size() < 2 || count <= chunk) {
+		for (size_t i = 0; i < count; i++) {
+			if (test(i))
+				visible.push_back((unsigned int)i);
+		}
+		return;
+	}
+
+	// Flags in parallel, then a serial pass keeps the result in cluster order.
+	vector<char> flags(count);
+	pool->parallelFor(count, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			flags[i] = test(i) ? 1 : 0;
+	}, chunk);
+
+	for (size_t i = 0; i < count; i++) {
+		if (flags[i])
+			visible.push_back((unsigned int)i);
+	}
+}
+
+void MeshletCuller::compactIndices(const MeshletMesh& mesh, const vector<unsigned int>& visible, vector<unsigned int>& indices) {
+	indices.clear();
+	for (unsigned int m : visible) {
+		const Meshlet& meshlet = mesh.meshlets[m];
+		auto first = mesh.indices.begin() + meshlet.triangleOffset * 3;
+		indices.insert(indices.end(), first, first + meshlet.triangleCount * 3);
+	}
+}
+
+void MeshletCuller::drawRanges(const MeshletMesh& mesh, const vector<unsigned int>& visible, vector<GLuint>& firstIndices, vector<GLsizei>& counts) {
+	firstIndices.clear();
+	counts.clear();
+	for (unsigned int m : visible) {
+		const Meshlet& meshlet = mesh.meshlets[m];
+		GLuint first = meshlet.triangleOffset * 3;
+		GLsizei count = (GLsizei)(meshlet.triangleCount * 3);
+
+		// Neighbouring clusters are adjacent in the index buffer; one range covers the run.
+		if (!counts.empty() && firstIndices.back() + (GLuint)counts.back() == first)
+			counts.back() += count;
+		else {
+			firstIndices.push_back(first);
+			counts.push_back(count);
+		}
+	}
+}
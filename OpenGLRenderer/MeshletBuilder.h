@@ -0,0 +1,80 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Local Library Includes
+#include "Frustum.h"
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <vector>
+
+using namespace std;
+
+// A small cluster of neighbouring triangles, with the bounds used to cull it as a whole.
+struct Meshlet {
+	unsigned int vertexOffset;		// Into MeshletMesh::vertices.
+	unsigned int vertexCount;
+	unsigned int triangleOffset;	// Into MeshletMesh::triangles, in triangles. Also where the cluster's indices start, divided by 3.
+	unsigned int triangleCount;
+
+	glm::vec3 center;				// Bounding sphere.
+	float radius;
+
+	// Normal cone: every triangle's normal lies within the cone around coneAxis. coneCutoff is the sine of its
+	//		half-angle, or 1 when the normals spread too far for the cluster ever to face away as a whole.
+	glm::vec3 coneAxis;
+	float coneCutoff;
+};
+
+struct MeshletMesh {
+	vector<Meshlet> meshlets;
+	vector<unsigned int> vertices;		// Each meshlet's vertices, as indices into the original vertex buffer.
+	vector<unsigned char> triangles;	// Three meshlet-local vertex numbers per triangle.
+
+	// The same triangles as ordinary indices, cluster after cluster. This is what gets uploaded for drawing,
+	//		so a meshlet's draw is the index range [triangleOffset * 3, (triangleOffset + triangleCount) * 3).
+	vector<unsigned int> indices;
+};
+
+// Splits meshes into meshlets for culling finer than a whole object.
+//
+//		Clusters grow greedily across shared edges, always taking the neighbouring triangle that adds the fewest
+//		new vertices, until either limit is reached. 64 vertices and 124 triangles is the usual size: small enough
+//		that culled clusters save real work, big enough that the per-cluster test stays cheap. Run MeshOptimizer
+//		first; building follows the triangle order when a cluster runs out of neighbours.
+class MeshletBuilder {
+
+	public:
+		// Functions
+		static MeshletMesh build(const vector<unsigned int>& indices, const vector<glm::vec3>& positions,
+			unsigned int maxVertices = 64, unsigned int maxTriangles = 124);
+
+		// Recompute one meshlet's bounding sphere and normal cone.
+		static void computeBounds(Meshlet& meshlet, const MeshletMesh& mesh, const vector<glm::vec3>& positions);
+};
+
+// Per-frame meshlet visibility. Frustum and camera are given in the mesh's own space.
+class MeshletCuller {
+
+	public:
+		// Functions
+		// Indices (into mesh.meshlets) of the clusters that are inside the frustum. Large meshes are split across the pool.
+		//		With coneCulling, clusters facing entirely away from the camera are dropped too. Only turn it on when
+		//		back faces are culled anyway (glEnable(GL_CULL_FACE)), or open and double-sided meshes lose geometry.
+		static void cull(const MeshletMesh& mesh, const Frustum& frustum, const glm::vec3& cameraPos, vector<unsigned int>& visible,
+			WorkerPool* pool = nullptr, bool coneCulling = false);
+
+		static bool isBackFacing(const Meshlet& meshlet, const glm::vec3& cameraPos);
+
+		// The visible clusters' indices packed together, for a single glDrawElements.
+		static void compactIndices(const MeshletMesh& mesh, const vector<unsigned int>& visible, vector<unsigned int>& indices);
+
+		// One (first index, count) range per run of consecutive visible clusters, for glMultiDrawElements
+		//		or indirect draw commands against the full index buffer.
+		static void drawRanges(const MeshletMesh& mesh, const vector<unsigned int>& visible, vector<GLuint>& firstIndices, vector<GLsizei>& counts);
+};
@@ -0,0 +1,401 @@
+#include "MipmapGenerator.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cmath>
+
+// SSE2 is baseline on x64, so the vector paths are always compiled there.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_SSE2
+#include <emmintrin.h>
+#endif
+
+// ---
+// Colour space helpers
+// ---
+namespace {
+
+	const float PI = 3.14159265358979f;
+	const int ENCODE_TABLE_SIZE = 4096;
+
+	struct SRGBTables {
+		float toLinear[256];
+		unsigned char toSRGB[ENCODE_TABLE_SIZE + 1];
+
+		SRGBTables() {
+			for (int i = 0; i < 256; i++) {
+				float c = i / 255.0f;
+				toLinear[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for (int i = 0; i <= ENCODE_TABLE_SIZE; i++) {
+				float l = (float)i / ENCODE_TABLE_SIZE;
+				float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+				toSRGB[i] = (unsigned char)(c * 255.0f + 0.5f);
+			}
+		}
+	};
+
+	const SRGBTables& srgbTables() {
+		static SRGBTables tables;
+		return tables;
+	}
+
+	// Which channel holds alpha, or -1 if the format has none.
+	int alphaChannel(int channels) {
+		if (channels == 2) return 1;
+		if (channels == 4) return 3;
+		return -1;
+	}
+
+	// ---
+	// Filter kernels. 'x' is measured in destination texels.
+	// ---
+	float sinc(float x) {
+		if (fabsf(x) < 1e-5f)
+			return 1.0f;
+		x *= PI;
+		return sinf(x) / x;
+	}
+
+	// Zeroth order modified Bessel function, used by the Kaiser window.
+	float bessel0(float x) {
+		float sum = 1.0f, term = 1.0f;
+		for (int k = 1; k < 20; k++) {
+			term *= (x / (2.0f * k)) * (x / (2.0f * k));
+			sum += term;
+		}
+		return sum;
+	}
+
+	float filterSupport(MipFilter filter) {
+		switch (filter) {
+			case MipFilter::Box: return 0.5f;
+			case MipFilter::Kaiser: return 3.0f;
+			case MipFilter::Lanczos: return 3.0f;
+		}
+		return 0.5f;
+	}
+
+	float filterWeight(MipFilter filter, float x) {
+		float support = filterSupport(filter);
+		if (fabsf(x) > support)
+			return 0.0f;
+
+		switch (filter) {
+			case MipFilter::Box:
+				return 1.0f;
+			case MipFilter::Lanczos:
+				return sinc(x) * sinc(x / support);
+			case MipFilter::Kaiser: {
+				const float alpha = 4.0f;
+				float t = x / support;
+				return sinc(x) * bessel0(alpha * sqrtf(1.0f - t * t)) / bessel0(alpha);
+			}
+		}
+		return 0.0f;
+	}
+
+	// Precomputed source indices and weights for every output texel along one axis.
+	//		Every output uses the same number of taps so the inner loops have no branches.
+	struct FilterTaps {
+		int tapCount = 0;
+		vector<int> indices;
+		vector<float> weights;
+	};
+
+	FilterTaps buildTaps(int srcSize, int dstSize, MipFilter filter, bool wrap) {
+		FilterTaps taps;
+		float scale = (float)srcSize / dstSize;
+		float filterScale = max(1.0f, scale); // Widen the kernel when shrinking, keep it when enlarging.
+		float support = filterSupport(filter) * filterScale;
+
+		taps.tapCount = (int)ceilf(support * 2.0f) + 1;
+		taps.indices.assign((size_t)dstSize * taps.tapCount, 0);
+		taps.weights.assign((size_t)dstSize * taps.tapCount, 0.0f);
+
+		for (int i = 0; i < dstSize; i++) {
+			float center = (i + 0.5f) * scale;
+			int first = (int)floorf(center - support);
+			float total = 0.0f;
+
+			for (int t = 0; t < taps.tapCount; t++) {
+				int src = first + t;
+				float w = filterWeight(filter, (src + 0.5f - center) / filterScale);
+
+				if (wrap)
+					src = ((src % srcSize) + srcSize) % srcSize;
+				else
+					src = min(max(src, 0), srcSize - 1);
+
+				taps.indices[(size_t)i * taps.tapCount + t] = src;
+				taps.weights[(size_t)i * taps.tapCount + t] = w;
+				total += w;
+			}
+
+			// Normalise so flat colours stay flat.
+			if (total != 0.0f) {
+				for (int t = 0; t < taps.tapCount; t++)
+					taps.weights[(size_t)i * taps.tapCount + t] /= total;
+			}
+		}
+		return taps;
+	}
+
+	// A level kept in linear float so repeated downsampling doesn't accumulate 8-bit rounding.
+	struct FloatImage {
+		int width = 0;
+		int height = 0;
+		vector<float> data;
+	};
+
+	FloatImage decodeToFloat(const unsigned char* pixels, int width, int height, int channels, bool sRGB, WorkerPool& pool) {
+		FloatImage image;
+		image.width = width;
+		image.height = height;
+		image.data.resize((size_t)width * height * channels);
+
+		const float* toLinear = srgbTables().toLinear;
+		int alpha = alphaChannel(channels);
+
+		pool.parallelFor((size_t)height, [&](size_t begin, size_t end) {
+			for (size_t y = begin; y < end; y++) {
+				const unsigned char* src = pixels + y * width * channels;
+				float* dst = &image.data[y * width * channels];
+
+				for (int i = 0; i < width * channels; i++) {
+					bool colour = sRGB && (i % channels) != alpha;
+					dst[i] = colour ? toLinear[src[i]] : src[i] / 255.0f;
+				}
+			}
+		}, 16);
+		return image;
+	}
+
+	// Separable resample: horizontal pass into a scratch image, then a vertical pass.
+	FloatImage resample(const FloatImage& src, int channels, int dstWidth, int dstHeight, MipFilter filter, bool wrap, WorkerPool& pool) {
+		FilterTaps xTaps = buildTaps(src.width, dstWidth, filter, wrap);
+		FilterTaps yTaps = buildTaps(src.height, dstHeight, filter, wrap);
+
+		// 1. Horizontal pass, one source row per iteration.
+		vector<float> scratch((size_t)dstWidth * src.height * channels);
+		pool.parallelFor((size_t)src.height, [&](size_t begin, size_t end) {
+			for (size_t y = begin; y < end; y++) {
+				const float* row = &src.data[y * src.width * channels];
+				float* out = &scratch[y * dstWidth * channels];
+
+				for (int x = 0; x < dstWidth; x++) {
+					const int* idx = &xTaps.indices[(size_t)x * xTaps.tapCount];
+					const float* w = &xTaps.weights[(size_t)x * xTaps.tapCount];
+
+					for (int c = 0; c < channels; c++) {
+						float sum = 0.0f;
+						for (int t = 0; t < xTaps.tapCount; t++)
+							sum += w[t] * row[idx[t] * channels + c];
+						out[x * channels + c] = sum;
+					}
+				}
+			}
+		}, 8);
+
+		// 2. Vertical pass. Each output row is a weighted sum of whole scratch rows,
+		//		which is contiguous memory and maps directly onto 4-wide vector adds.
+		FloatImage dst;
+		dst.width = dstWidth;
+		dst.height = dstHeight;
+		dst.data.assign((size_t)dstWidth * dstHeight * channels, 0.0f);
+
+		size_t rowLength = (size_t)dstWidth * channels;
+		pool.parallelFor((size_t)dstHeight, [&](size_t begin, size_t end) {
+			for (size_t y = begin; y < end; y++) {
+				float* out = &dst.data[y * rowLength];
+
+				for (int t = 0; t < yTaps.tapCount; t++) {
+					float weight = yTaps.weights[y * yTaps.tapCount + t];
+					if (weight == 0.0f)
+						continue;
+
+					const float* in = &scratch[(size_t)yTaps.indices[y * yTaps.tapCount + t] * rowLength];
+					size_t i = 0;
+#ifdef MIP_SSE2
+					__m128 w4 = _mm_set1_ps(weight);
+					for (; i + 4 <= rowLength; i += 4)
+						_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(w4, _mm_loadu_ps(in + i))));
+#endif
+					for (; i < rowLength; i++)
+						out[i] += weight * in[i];
+				}
+			}
+		}, 8);
+
+		return dst;
+	}
+
+	// Fraction of texels whose scaled alpha passes the cutoff.
+	float alphaCoverage(const FloatImage& image, int channels, float cutoff, float scale) {
+		int alpha = alphaChannel(channels);
+		size_t count = (size_t)image.width * image.height;
+		size_t passed = 0;
+
+		for (size_t i = 0; i < count; i++) {
+			if (image.data[i * channels + alpha] * scale > cutoff)
+				passed++;
+		}
+		return (float)passed / count;
+	}
+
+	// Binary search for the alpha scale that reproduces the coverage of level 0.
+	float findAlphaScale(const FloatImage& image, int channels, float cutoff, float targetCoverage) {
+		float low = 0.0f, high = 4.0f, best = 1.0f;
+		float bestError = 1.0f;
+
+		for (int i = 0; i < 12; i++) {
+			float mid = (low + high) * 0.5f;
+			float coverage = alphaCoverage(image, channels, cutoff, mid);
+			float error = fabsf(coverage - targetCoverage);
+
+			if (error < bestError) {
+				bestError = error;
+				best = mid;
+			}
+
+			if (coverage < targetCoverage)
+				low = mid;
+			else
+				high = mid;
+		}
+		return best;
+	}
+
+	MipLevel encodeToBytes(const FloatImage& image, int channels, bool sRGB, float alphaScale, WorkerPool& pool) {
+		MipLevel level;
+		level.width = image.width;
+		level.height = image.height;
+		level.pixels.resize(image.data.size());
+
+		const unsigned char* toSRGB = srgbTables().toSRGB;
+		int alpha = alphaChannel(channels);
+		size_t rowLength = (size_t)image.width * channels;
+
+		pool.parallelFor((size_t)image.height, [&](size_t begin, size_t end) {
+			for (size_t y = begin; y < end; y++) {
+				const float* src = &image.data[y * rowLength];
+				unsigned char* dst = &level.pixels[y * rowLength];
+
+				for (size_t i = 0; i < rowLength; i++) {
+					int c = (int)(i % channels);
+					float v = (c == alpha) ? src[i] * alphaScale : src[i];
+					v = min(max(v, 0.0f), 1.0f);
+
+					if (sRGB && c != alpha)
+						dst[i] = toSRGB[(int)(v * ENCODE_TABLE_SIZE + 0.5f)];
+					else
+						dst[i] = (unsigned char)(v * 255.0f + 0.5f);
+				}
+			}
+		}, 16);
+		return level;
+	}
+}
+
+// ---
+// MipChain
+// ---
+size_t MipChain::byteSize() const {
+	size_t total = 0;
+	for (const MipLevel& level : levels)
+		total += level.pixels.size();
+	return total;
+}
+
+// ---
+// MipmapGenerator
+// ---
+MipChain MipmapGenerator::generate(const unsigned char* pixels, int width, int height, int channels, const MipSettings& settings, WorkerPool& pool) {
+	MipChain chain;
+	chain.channels = channels;
+
+	if (!pixels || width <= 0 || height <= 0 || channels < 1 || channels > 4)
+		return chain;
+
+	// Level 0 is the source image, copied as-is.
+	MipLevel base;
+	base.width = width;
+	base.height = height;
+	base.pixels.assign(pixels, pixels + (size_t)width * height * channels);
+	chain.levels.push_back(std::move(base));
+
+	bool useCoverage = settings.preserveAlphaCoverage && alphaChannel(channels) >= 0;
+	FloatImage current = decodeToFloat(pixels, width, height, channels, settings.sRGB, pool);
+	float targetCoverage = useCoverage ? alphaCoverage(current, channels, settings.alphaCutoff, 1.0f) : 0.0f;
+
+	// Each level is filtered from the float copy of the previous one, never from 8-bit data.
+	while ((current.width > 1 || current.height > 1) && (settings.maxLevels == 0 || (int)chain.levels.size() < settings.maxLevels)) {
+		int nextWidth = max(1, current.width / 2);
+		int nextHeight = max(1, current.height / 2);
+
+		current = resample(current, channels, nextWidth, nextHeight, settings.filter, settings.wrap, pool);
+
+		float alphaScale = useCoverage ? findAlphaScale(current, channels, settings.alphaCutoff, targetCoverage) : 1.0f;
+		chain.levels.push_back(encodeToBytes(current, channels, settings.sRGB, alphaScale, pool));
+	}
+
+	return chain;
+}
+
+future<MipChain> MipmapGenerator::generateAsync(const unsigned char* pixels, int width, int height, int channels, const MipSettings& settings, WorkerPool& pool) {
+	WorkerPool* workers = &pool;
+	return pool.async([=]() {
+		return MipmapGenerator::generate(pixels, width, height, channels, settings, *workers);
+	});
+}
+
+MipLevel MipmapGenerator::resize(const unsigned char* pixels, int width, int height, int channels, int newWidth, int newHeight, const MipSettings& settings, WorkerPool& pool) {
+	FloatImage source = decodeToFloat(pixels, width, height, channels, settings.sRGB, pool);
+	FloatImage resized = resample(source, channels, newWidth, newHeight, settings.filter, settings.wrap, pool);
+	return encodeToBytes(resized, channels, settings.sRGB, 1.0f, pool);
+}
+
+void MipmapGenerator::upload(GLenum target, const MipChain& chain) {
+	if (chain.levels.empty())
+		return;
+
+	// Rows of RGB or odd-width data aren't 4-byte aligned.
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (size_t i = 0; i < chain.levels.size(); i++) {
+		const MipLevel& level = chain.levels[i];
+		glTexImage2D(target, (GLint)i, internalFormat(chain.channels), level.width, level.height, 0, pixelFormat(chain.channels), GL_UNSIGNED_BYTE, level.pixels.data());
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, (GLint)chain.levels.size() - 1);
+
+	// Greyscale images would otherwise sample as pure red.
+	if (chain.channels == 1) {
+		GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+		glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+	}
+	else if (chain.channels == 2) {
+		GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+		glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+	}
+}
+
+GLenum MipmapGenerator::pixelFormat(int channels) {
+	switch (channels) {
+		case 1: return GL_RED;
+		case 2: return GL_RG;
+		case 3: return GL_RGB;
+		default: return GL_RGBA;
+	}
+}
+
+GLenum MipmapGenerator::internalFormat(int channels) {
+	switch (channels) {
+		case 1: return GL_R8;
+		case 2: return GL_RG8;
+		case 3: return GL_RGB8;
+		default: return GL_RGBA8;
+	}
+}
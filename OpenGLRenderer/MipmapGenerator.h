@@ -0,0 +1,67 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// Local Library Includes
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <future>
+#include <vector>
+
+using namespace std;
+
+// Reconstruction filters used when shrinking a level.
+//		Box matches glGenerateMipmap, Kaiser and Lanczos keep more detail without ringing too hard.
+enum class MipFilter {
+	Box,
+	Kaiser,
+	Lanczos
+};
+
+struct MipSettings {
+	MipFilter filter = MipFilter::Kaiser;
+	bool sRGB = true;					// Colour channels are gamma encoded, so filter them in linear space.
+	bool wrap = true;					// Sample across the edges like GL_REPEAT does. Use false for clamped textures.
+	bool preserveAlphaCoverage = false;	// Keep the fraction of texels passing alphaCutoff the same on every level (foliage, fences).
+	float alphaCutoff = 0.5f;
+	int maxLevels = 0;					// 0 generates the full chain down to 1x1.
+	int maxDimension = 0;				// Longest side of level 0. Larger sources are resampled down first (TextureLoader). 0 keeps the source size.
+};
+
+struct MipLevel {
+	int width;
+	int height;
+	vector<unsigned char> pixels;
+};
+
+// A full chain of 8-bit levels, level 0 first, ready to be handed to glTexImage2D.
+struct MipChain {
+	int channels = 0;
+	vector<MipLevel> levels;
+
+	size_t byteSize() const;
+};
+
+// Builds mip chains on the CPU instead of calling glGenerateMipmap on the render thread.
+//		Rows are filtered in parallel on a WorkerPool, and the inner loops use SSE2 where available.
+class MipmapGenerator {
+
+	public:
+		// Functions
+		static MipChain generate(const unsigned char* pixels, int width, int height, int channels, const MipSettings& settings = MipSettings(), WorkerPool& pool = WorkerPool::shared());
+
+		// Runs generate() as a pool job. The pixels must stay alive until the future is ready.
+		static future<MipChain> generateAsync(const unsigned char* pixels, int width, int height, int channels, const MipSettings& settings = MipSettings(), WorkerPool& pool = WorkerPool::shared());
+
+		// Resample a single image to an arbitrary size using the same filters.
+		static MipLevel resize(const unsigned char* pixels, int width, int height, int channels, int newWidth, int newHeight, const MipSettings& settings = MipSettings(), WorkerPool& pool = WorkerPool::shared());
+
+		// Upload every level of the chain into the texture currently bound to 'target'.
+		static void upload(GLenum target, const MipChain& chain);
+
+		// Matching client formats for a channel count.
+		static GLenum pixelFormat(int channels);
+		static GLenum internalFormat(int channels);
+};
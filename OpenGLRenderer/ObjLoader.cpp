@@ -0,0 +1,473 @@
+#include "ObjLoader.h"
+
+// Local Library Includes
+#include "MappedFile.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+namespace {
+	const size_t CHUNK_BYTES = 1024 * 1024;
+	const uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+
+	// One face corner: 0-based indices into the position, UV and normal arrays, -1 when absent.
+	struct Corner {
+		int position, texCoord, normal;
+
+		bool operator==(const Corner& other) const {
+			return position == other.position && texCoord == other.texCoord && normal == other.normal;
+		}
+	};
+
+	struct Chunk {
+		const char* begin;
+		const char* end;
+		size_t positions = 0, texCoords = 0, normals = 0;				// Lines of each kind in this chunk.
+		size_t positionBase = 0, texCoordBase = 0, normalBase = 0;		// How many came before it.
+		vector<Corner> corners;											// Three per triangle.
+		bool hasColors = false;
+		bool failed = false;
+	};
+
+	inline bool isSpace(char c) { return c == ' ' || c == '\t'; }
+
+	inline const char* skipSpace(const char* p, const char* end) {
+		while (p < end && isSpace(*p))
+			p++;
+		return p;
+	}
+
+	inline const char* lineEnd(const char* p, const char* end) {
+		const char* newline = (const char*)memchr(p, '\n', end - p);
+		return newline ? newline : end;
+	}
+
+	// True when all eight bytes are '0'..'9'.
+	inline bool eightDigits(uint64_t chunk) {
+		return ((chunk & 0xF0F0F0F0F0F0F0F0ull) == 0x3030303030303030ull) &&
+			(((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) == 0x3030303030303030ull);
+	}
+
+	// Eight ASCII digits (first digit in the lowest byte) to their value, combining pairs, then quads, then halves.
+	inline uint32_t parseEightDigits(uint64_t chunk) {
+		chunk -= 0x3030303030303030ull;
+		chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FFull;
+		chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFFull;
+		chunk = (chunk * 10000 + (chunk >> 32)) & 0x00000000FFFFFFFFull;
+		return (uint32_t)chunk;
+	}
+
+	const double POWERS_OF_TEN[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	// Reads an OBJ index ("12", "-3") and turns it into a 0-based index given how many elements came before it.
+	inline const char* parseIndex(const char* p, const char* end, size_t defined, int& index) {
+		bool negative = (p < end && *p == '-');
+		if (negative)
+			p++;
+
+		long long value = 0;
+		const char* digits = p;
+		while (p < end && *p >= '0' && *p <= '9')
+			value = value * 10 + (*p++ - '0');
+
+		if (p == digits)
+			index = -1;
+		else if (negative)
+			index = (int)((long long)defined - value);
+		else
+			index = (int)(value - 1);
+		return p;
+	}
+
+	inline uint32_t hashCorner(const Corner& corner) {
+		uint32_t h = (uint32_t)corner.position * 0x9E3779B1u;
+		h ^= (uint32_t)corner.texCoord * 0x85EBCA77u + (h << 6) + (h >> 2);
+		h ^= (uint32_t)corner.normal * 0xC2B2AE3Du + (h << 6) + (h >> 2);
+		return h ^ (h >> 15);
+	}
+
+	// Counts the element lines so each chunk can be given its base offsets before anything is parsed.
+	void countElements(Chunk& chunk) {
+		for (const char* p = chunk.begin; p < chunk.end;) {
+			const char* end = lineEnd(p, chunk.end);
+			const char* q = skipSpace(p, end);
+
+			if (end - q >= 2 && q[0] == 'v') {
+				if (isSpace(q[1]))
+					chunk.positions++;
+				else if (q[1] == 't' && end - q >= 3 && isSpace(q[2]))
+					chunk.texCoords++;
+				else if (q[1] == 'n' && end - q >= 3 && isSpace(q[2]))
+					chunk.normals++;
+			}
+			p = end + 1;
+		}
+	}
+
+	void parseChunk(Chunk& chunk, vector<glm::vec3>& positions, vector<glm::vec3>& colors, vector<glm::vec2>& texCoords, vector<glm::vec3>& normals) {
+		size_t positionCount = chunk.positionBase;
+		size_t texCoordCount = chunk.texCoordBase;
+		size_t normalCount = chunk.normalBase;
+		vector<Corner> face;
+
+		for (const char* p = chunk.begin; p < chunk.end;) {
+			const char* end = lineEnd(p, chunk.end);
+			const char* q = skipSpace(p, end);
+			p = end + 1;
+
+			if (q >= end || *q == '#')
+				continue;
+
+			if (q[0] == 'v' && end - q >= 2 && isSpace(q[1])) {
+				float values[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+				int count = 0;
+				q = skipSpace(q + 2, end);
+				while (count < 6 && q < end) {
+					const char* next = ObjLoader::parseFloat(q, end, values[count]);
+					if (next == q)
+						break;
+					q = skipSpace(next, end);
+					count++;
+				}
+
+				// Four values is x y z w; six is x y z r g b.
+				positions[positionCount] = glm::vec3(values[0], values[1], values[2]);
+				colors[positionCount] = (count >= 6) ? glm::vec3(values[3], values[4], values[5]) : glm::vec3(1.0f);
+				chunk.hasColors = chunk.hasColors || count >= 6;
+				positionCount++;
+			}
+			else if (q[0] == 'v' && end - q >= 3 && q[1] == 't' && isSpace(q[2])) {
+				float values[2] = { 0.0f, 0.0f };
+				q = skipSpace(q + 3, end);
+				for (int i = 0; i < 2 && q < end; i++)
+					q = skipSpace(ObjLoader::parseFloat(q, end, values[i]), end);
+				texCoords[texCoordCount++] = glm::vec2(values[0], values[1]);
+			}
+			else if (q[0] == 'v' && end - q >= 3 && q[1] == 'n' && isSpace(q[2])) {
+				float values[3] = { 0.0f, 0.0f, 0.0f };
+				q = skipSpace(q + 3, end);
+				for (int i = 0; i < 3 && q < end; i++)
+					q = skipSpace(ObjLoader::parseFloat(q, end, values[i]), end);
+				normals[normalCount++] = glm::vec3(values[0], values[1], values[2]);
+			}
+			else if (q[0] == 'f' && end - q >= 2 && isSpace(q[1])) {
+				// Corners are "v", "v/vt", "v//vn" or "v/vt/vn".
+				face.clear();
+				q = skipSpace(q + 2, end);
+				while (q < end && *q != '\r' && *q != '#') {
+					Corner corner = { -1, -1, -1 };
+					q = parseIndex(q, end, positionCount, corner.position);
+					if (q < end && *q == '/') {
+						q = parseIndex(q + 1, end, texCoordCount, corner.texCoord);
+						if (q < end && *q == '/')
+							q = parseIndex(q + 1, end, normalCount, corner.normal);
+					}
+
+					if (corner.position < 0 || corner.position >= (int)positions.size() ||
+						corner.texCoord >= (int)texCoords.size() || corner.normal >= (int)normals.size()) {
+						chunk.failed = true;
+						break;
+					}
+					face.push_back(corner);
+					q = skipSpace(q, end);
+				}
+
+				for (size_t i = 2; i < face.size(); i++) {
+					chunk.corners.push_back(face[0]);
+					chunk.corners.push_back(face[i - 1]);
+					chunk.corners.push_back(face[i]);
+				}
+			}
+		}
+	}
+}
+
+const char* ObjLoader::parseFloat(const char* p, const char* end, float& value) {
+	const char* start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = (*p == '-');
+		p++;
+	}
+
+	uint64_t mantissa = 0;
+	int digits = 0;		// Significant digits held in the mantissa.
+	int exponent = 0;
+	bool anyDigits = false;
+	bool exact = true;	// False when digits had to be dropped.
+
+	// Integer part, then fraction. Runs of eight digits are handled in one step.
+	for (int part = 0; part < 2; part++) {
+		while (true) {
+			if (end - p >= 8 && digits <= 10) {
+				uint64_t chunk;
+				memcpy(&chunk, p, 8);
+				if (eightDigits(chunk)) {
+					mantissa = mantissa * 100000000ull + parseEightDigits(chunk);
+					digits += (mantissa != 0) ? 8 : 0;
+					exponent -= (part == 1) ? 8 : 0;
+					p += 8;
+					anyDigits = true;
+					continue;
+				}
+			}
+			if (p >= end || *p < '0' || *p > '9')
+				break;
+
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				digits += (mantissa != 0) ? 1 : 0;
+				exponent -= (part == 1) ? 1 : 0;
+			}
+			else {
+				exact = false;
+				exponent += (part == 0) ? 1 : 0;
+			}
+			p++;
+			anyDigits = true;
+		}
+
+		if (part == 0) {
+			if (p < end && *p == '.')
+				p++;
+			else
+				break;
+		}
+	}
+
+	if (!anyDigits) {
+		// "nan", "inf" and friends are rare enough to leave to the C library.
+		char buffer[32];
+		size_t length = min<size_t>(sizeof(buffer) - 1, end - start);
+		memcpy(buffer, start, length);
+		buffer[length] = '\0';
+		char* parsed = nullptr;
+		value = strtof(buffer, &parsed);
+		return start + (parsed - buffer);
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char* e = p + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == '-' || *e == '+')) {
+			negativeExponent = (*e == '-');
+			e++;
+		}
+		if (e < end && *e >= '0' && *e <= '9') {
+			int written = 0;
+			while (e < end && *e >= '0' && *e <= '9') {
+				if (written < 10000)
+					written = written * 10 + (*e - '0');
+				e++;
+			}
+			exponent += negativeExponent ? -written : written;
+			p = e;
+		}
+	}
+
+	// Exact in double when the mantissa fits in 53 bits and the power of ten is exactly representable.
+	double result;
+	if (exact && mantissa < (1ull << 53) && exponent >= -22 && exponent <= 22) {
+		result = (double)mantissa;
+		result = (exponent < 0) ? result / POWERS_OF_TEN[-exponent] : result * POWERS_OF_TEN[exponent];
+	}
+	else {
+		char buffer[64];
+		size_t length = min<size_t>(sizeof(buffer) - 1, p - start);
+		memcpy(buffer, start, length);
+		buffer[length] = '\0';
+		result = strtod(buffer, nullptr);
+		negative = false;
+	}
+
+	value = (float)(negative ? -result : result);
+	return p;
+}
+
+bool ObjLoader::load(const char* path, ObjMesh& mesh, WorkerPool& pool) {
+	MappedFile file;
+	if (!file.open(path)) {
+		cout << "ERROR::OBJ_LOADER::FILE_NOT_SUCCESFULLY_READ: " << path << endl;
+		return false;
+	}
+	return parse((const char*)file.data(), file.size(), mesh, pool);
+}
+
+bool ObjLoader::parse(const char* data, size_t size, ObjMesh& mesh, WorkerPool& pool) {
+	mesh = ObjMesh();
+	if (!data || size == 0)
+		return false;
+
+	// ---
+	// Line-aligned chunks, and how many elements each defines.
+	// ---
+	vector<Chunk> chunks;
+	const char* end = data + size;
+	for (const char* p = data; p < end;) {
+		const char* chunkEnd = (end - p > (ptrdiff_t)CHUNK_BYTES) ? lineEnd(p + CHUNK_BYTES, end) : end;
+		if (chunkEnd < end)
+			chunkEnd++;
+
+		Chunk chunk;
+		chunk.begin = p;
+		chunk.end = chunkEnd;
+		chunks.push_back(std::move(chunk));
+		p = chunkEnd;
+	}
+
+	pool.parallelFor(chunks.size(), [&](size_t begin, size_t finish) {
+		for (size_t i = begin; i < finish; i++)
+			countElements(chunks[i]);
+	});
+
+	size_t positionCount = 0, texCoordCount = 0, normalCount = 0;
+	for (Chunk& chunk : chunks) {
+		chunk.positionBase = positionCount;
+		chunk.texCoordBase = texCoordCount;
+		chunk.normalBase = normalCount;
+		positionCount += chunk.positions;
+		texCoordCount += chunk.texCoords;
+		normalCount += chunk.normals;
+	}
+
+	// ---
+	// Parse every chunk straight into the shared element arrays.
+	// ---
+	vector<glm::vec3> positions(positionCount), colors(positionCount), normals(normalCount);
+	vector<glm::vec2> texCoords(texCoordCount);
+
+	pool.parallelFor(chunks.size(), [&](size_t begin, size_t finish) {
+		for (size_t i = begin; i < finish; i++)
+			parseChunk(chunks[i], positions, colors, texCoords, normals);
+	});
+
+	vector<size_t> cornerBase(chunks.size() + 1, 0);
+	for (size_t i = 0; i < chunks.size(); i++) {
+		if (chunks[i].failed)
+			cout << "ERROR::OBJ_LOADER::FACE_INDEX_OUT_OF_RANGE" << endl;
+		mesh.hasColors = mesh.hasColors || chunks[i].hasColors;
+		cornerBase[i + 1] = cornerBase[i] + chunks[i].corners.size();
+	}
+
+	size_t cornerCount = cornerBase.back();
+	if (cornerCount == 0 || cornerCount >= EMPTY_SLOT) {
+		cout << "ERROR::OBJ_LOADER::NO_FACES" << endl;
+		return false;
+	}
+
+	vector<Corner> corners(cornerCount);
+	pool.parallelFor(chunks.size(), [&](size_t begin, size_t finish) {
+		for (size_t i = begin; i < finish; i++) {
+			copy(chunks[i].corners.begin(), chunks[i].corners.end(), corners.begin() + cornerBase[i]);
+			vector<Corner>().swap(chunks[i].corners);
+		}
+	});
+
+	// ---
+	// Deduplicate corners. Each slot of the open-addressing table ends up holding the earliest corner with its
+	//		triplet: a new triplet claims an empty slot with a CAS, and later duplicates lower the slot with an atomic min.
+	// ---
+	size_t tableSize = 1;
+	while (tableSize < cornerCount * 2)
+		tableSize <<= 1;
+	size_t mask = tableSize - 1;
+
+	unique_ptr<atomic<uint32_t>[]> table(new atomic<uint32_t>[tableSize]);
+	pool.parallelFor(tableSize, [&](size_t begin, size_t finish) {
+		for (size_t i = begin; i < finish; i++)
+			table[i].store(EMPTY_SLOT, memory_order_relaxed);
+	}, 65536);
+
+	pool.parallelFor(cornerCount, [&](size_t begin, size_t finish) {
+		for (size_t i = begin; i < finish; i++) {
+			uint32_t corner = (uint32_t)i;
+			size_t slot = hashCorner(corners[i]) & mask;
+
+			while (true) {
+				uint32_t current = table[slot].load();
+				if (current == EMPTY_SLOT) {
+					if (table[slot].compare_exchange_strong(current, corner))
+						break;
+				}
+				if (current != EMPTY_SLOT) {
+					if (corners[current] == corners[i]) {
+						while (corner < current && !table[slot].compare_exchange_weak(current, corner)) {}
+						break;
+					}
+					slot = (slot + 1) & mask;
+				}
+			}
+		}
+	}, 4096);
+
+	// Each corner's representative, then vertex numbers given to representatives in file order.
+	vector<uint32_t> representative(cornerCount);
+	pool.parallelFor(cornerCount, [&](size_t begin, size_t finish) {
+		for (size_t i = begin; i < finish; i++) {
+			size_t slot = hashCorner(corners[i]) & mask;
+			while (!(corners[table[slot].load(memory_order_relaxed)] == corners[i]))
+				slot = (slot + 1) & mask;
+			representative[i] = table[slot].load(memory_order_relaxed);
+		}
+	}, 4096);
+	table.reset();
+
+	size_t blockCount = max<size_t>(1, min<size_t>(cornerCount / 4096, pool.size() * 4 + 1));
+	size_t blockSize = (cornerCount + blockCount - 1) / blockCount;
+	vector<size_t> blockVertices(blockCount + 1, 0);
+
+	pool.parallelFor(blockCount, [&](size_t begin, size_t finish) {
+		for (size_t block = begin; block < finish; block++) {
+			size_t first = block * blockSize, last = min(cornerCount, first + blockSize);
+			for (size_t i = first; i < last; i++)
+				blockVertices[block + 1] += (representative[i] == i) ? 1 : 0;
+		}
+	});
+	for (size_t block = 0; block < blockCount; block++)
+		blockVertices[block + 1] += blockVertices[block];
+
+	mesh.vertices.resize(blockVertices.back());
+	mesh.indices.resize(cornerCount);
+	mesh.hasTexCoords = texCoordCount > 0;
+	mesh.hasNormals = normalCount > 0;
+
+	pool.parallelFor(blockCount, [&](size_t begin, size_t finish) {
+		for (size_t block = begin; block < finish; block++) {
+			size_t first = block * blockSize, last = min(cornerCount, first + blockSize);
+			uint32_t next = (uint32_t)blockVertices[block];
+
+			for (size_t i = first; i < last; i++) {
+				if (representative[i] != i)
+					continue;
+
+				const Corner& corner = corners[i];
+				MeshVertex& vertex = mesh.vertices[next];
+				vertex.position = positions[corner.position];
+				vertex.color = colors[corner.position];
+				vertex.texCoord = (corner.texCoord >= 0) ? texCoords[corner.texCoord] : glm::vec2(0.0f);
+				vertex.normal = (corner.normal >= 0) ? normals[corner.normal] : glm::vec3(0.0f);
+
+				// Representatives are their own lowest corner, so their slot can carry the vertex number for now.
+				mesh.indices[i] = next++;
+			}
+		}
+	});
+
+	pool.parallelFor(cornerCount, [&](size_t begin, size_t finish) {
+		for (size_t i = begin; i < finish; i++) {
+			if (representative[i] != i)
+				mesh.indices[i] = mesh.indices[representative[i]];
+		}
+	}, 4096);
+
+	return true;
+}
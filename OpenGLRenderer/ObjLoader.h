@@ -0,0 +1,39 @@
+#pragma once
+
+// Local Library Includes
+#include "VertexLayout.h"
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <vector>
+
+using namespace std;
+
+struct ObjMesh {
+	vector<MeshVertex> vertices;
+	vector<unsigned int> indices;
+	bool hasTexCoords = false;
+	bool hasNormals = false;	// Normals are zero when the file has none.
+	bool hasColors = false;		// "v x y z r g b" vertex colours; white otherwise.
+};
+
+// Wavefront OBJ loading for large files.
+//
+//		The file is mapped and cut into line-aligned chunks. A first pass counts the v/vt/vn lines in each chunk
+//		so every chunk knows where its elements start; a second pass parses the chunks in parallel straight into
+//		the final arrays. Faces are fan-triangulated, and each distinct position/UV/normal triplet becomes one
+//		vertex through a lock-free hash table shared by all workers. Vertices are numbered in the order their
+//		triplets first appear in the file, so the output doesn't depend on thread timing.
+//
+//		Groups, objects, smoothing groups and materials are ignored; the whole file becomes one mesh.
+class ObjLoader {
+
+	public:
+		// Functions
+		static bool load(const char* path, ObjMesh& mesh, WorkerPool& pool = WorkerPool::shared());
+		static bool parse(const char* data, size_t size, ObjMesh& mesh, WorkerPool& pool = WorkerPool::shared());
+
+		// Parses a decimal float at p (sign, digits, fraction, exponent). Returns the first unparsed character,
+		//		or p itself if there was no number. Eight digits at a time are converted with 64-bit SWAR arithmetic.
+		static const char* parseFloat(const char* p, const char* end, float& value);
+};
@@ -0,0 +1,22 @@
+#version 330 core
+// Default.vert for VertexPullingPool: no vertex attributes, every vertex is fetched by gl_VertexID.
+//		glDrawElementsBaseVertex makes gl_VertexID index + baseVertex, the vertex's slot in the pool.
+
+uniform samplerBuffer pulledVertices;	// PulledVertex as RGBA32F: position + u, colour + v, normal + alpha
+
+out vec3 vertexColor;
+out vec2 TexCoord;
+out vec3 Normal;
+
+void main()
+{
+	int base = gl_VertexID * 3;
+	vec4 positionU = texelFetch(pulledVertices, base);
+	vec4 colorV = texelFetch(pulledVertices, base + 1);
+	vec4 normalAlpha = texelFetch(pulledVertices, base + 2);
+
+	gl_Position = vec4(positionU.xyz, 1.0);
+	vertexColor = colorV.rgb;
+	TexCoord = vec2(positionU.w, colorV.w);
+	Normal = normalAlpha.xyz;
+}
@@ -0,0 +1,29 @@
+#version 330 core
+// Pulled.vert for IndirectRenderer: the vertex is fetched by gl_VertexID as in Pulled.vert, and the draw's
+//		transform and colour by its draw index as in Indirect.vert. Location 13 is the pool VAO's only attribute.
+layout (location = 13) in uint drawIndex;	// baseInstance of the indirect command, or set per draw on the fallback path
+
+uniform samplerBuffer pulledVertices;		// PulledVertex as RGBA32F: position + u, colour + v, normal + alpha
+uniform samplerBuffer drawData;				// InstanceData as RGBA32F: four matrix columns, then the colour
+uniform int drawDataBase;					// Where this frame's data starts in the streaming buffer, in texels
+
+out vec3 vertexColor;
+out vec2 TexCoord;
+out vec3 Normal;
+
+void main()
+{
+	int draw = drawDataBase + int(drawIndex) * 5;
+	mat4 transform = mat4(texelFetch(drawData, draw), texelFetch(drawData, draw + 1), texelFetch(drawData, draw + 2), texelFetch(drawData, draw + 3));
+	vec4 color = texelFetch(drawData, draw + 4);
+
+	int base = gl_VertexID * 3;
+	vec4 positionU = texelFetch(pulledVertices, base);
+	vec4 colorV = texelFetch(pulledVertices, base + 1);
+	vec4 normalAlpha = texelFetch(pulledVertices, base + 2);
+
+	gl_Position = transform * vec4(positionU.xyz, 1.0);
+	vertexColor = colorV.rgb * color.rgb;
+	TexCoord = vec2(positionU.w, colorV.w);
+	Normal = mat3(transform) * normalAlpha.xyz;
+}
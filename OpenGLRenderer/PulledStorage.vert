@@ -0,0 +1,26 @@
+#version 430 core
+// Pulled.vert reading the pool as a shader storage buffer (GL 4.3), which skips the texture unit's format conversion.
+
+struct PulledVertex {
+	vec4 positionU;		// position + u
+	vec4 colorV;		// colour + v
+	vec4 normalAlpha;	// normal + alpha
+};
+
+layout (std430, binding = 0) readonly buffer PulledVertices {	// VertexPullingPool::storageBinding
+	PulledVertex pulledVertices[];
+};
+
+out vec3 vertexColor;
+out vec2 TexCoord;
+out vec3 Normal;
+
+void main()
+{
+	PulledVertex vertex = pulledVertices[gl_VertexID];
+
+	gl_Position = vec4(vertex.positionU.xyz, 1.0);
+	vertexColor = vertex.colorV.rgb;
+	TexCoord = vec2(vertex.positionU.w, vertex.colorV.w);
+	Normal = vertex.normalAlpha.xyz;
+}
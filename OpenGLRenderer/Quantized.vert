@@ -0,0 +1,33 @@
+#version 330 core
+// Default.vert for QuantizedVertex data (see VertexQuantizer.h).
+//		Attributes arrive as 0..1 values from unsigned normalized integers and are scaled back per mesh.
+layout (location = 0) in vec4 aPos;			// unorm16 xyz across the mesh bounds
+layout (location = 1) in vec4 aColor;		// RGBA8
+layout (location = 2) in vec2 aTexCoord;	// unorm16 across the mesh's UV range
+layout (location = 3) in vec2 aNormal;		// unorm16 octahedral
+
+uniform vec3 dequantPositionScale;
+uniform vec3 dequantPositionOffset;
+uniform vec4 dequantTexCoord;				// xy scale, zw offset
+
+out vec3 vertexColor;
+out vec2 TexCoord;
+out vec3 Normal;
+
+vec3 decodeOctahedral(vec2 encoded)
+{
+	vec2 e = encoded * 2.0 - 1.0;
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+	return normalize(n);
+}
+
+void main()
+{
+	vec3 position = aPos.xyz * dequantPositionScale + dequantPositionOffset;
+	gl_Position = vec4(position, 1.0);
+	vertexColor = aColor.rgb;
+	TexCoord = aTexCoord * dequantTexCoord.xy + dequantTexCoord.zw;
+	Normal = decodeOctahedral(aNormal);
+}
@@ -0,0 +1,78 @@
+#include "RenderTarget.h"
+
+// Standard Library Includes
+#include <iostream>
+
+using namespace std;
+
+RenderTarget::RenderTarget(int width, int height, GLenum colorFormat) {
+	this->width = width;
+	this->height = height;
+
+	glGenFramebuffers(1, &fbo);
+	glGenTextures(1, &colorTexture);
+	glGenRenderbuffers(1, &depthBuffer);
+
+	if (!allocate(colorFormat)) {
+		cout << "ERROR::RENDER_TARGET::FORMAT_NOT_RENDERABLE falling back to RGBA16F" << endl;
+		if (!allocate(GL_RGBA16F))
+			cout << "ERROR::RENDER_TARGET::FRAMEBUFFER_INCOMPLETE" << endl;
+	}
+}
+
+RenderTarget::~RenderTarget() {
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteTextures(1, &colorTexture);
+	glDeleteRenderbuffers(1, &depthBuffer);
+}
+
+bool RenderTarget::allocate(GLenum format) {
+	colorFormat = format;
+
+	// Only the base level is ever written, and the blit reads it texel for texel.
+	glBindTexture(GL_TEXTURE_2D, colorTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_RGB, GL_FLOAT, NULL);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return complete;
+}
+
+void RenderTarget::resize(int width, int height) {
+	if (width <= 0 || height <= 0 || (width == this->width && height == this->height))
+		return;
+
+	this->width = width;
+	this->height = height;
+	allocate(colorFormat);
+}
+
+void RenderTarget::bind() {
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glViewport(0, 0, width, height);
+}
+
+void RenderTarget::blitToScreen(int screenWidth, int screenHeight) {
+	// Float to fixed point is a legal blit; values above 1.0 clamp until a tonemapping pass replaces this.
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+	GLenum filter = (screenWidth == width && screenHeight == height) ? GL_NEAREST : GL_LINEAR;
+	glBlitFramebuffer(0, 0, width, height, 0, 0, screenWidth, screenHeight, GL_COLOR_BUFFER_BIT, filter);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// An offscreen colour + depth framebuffer the scene can be drawn into and then blitted to the window.
+//		The default colour format is R11F_G11F_B10F: floating point, so lighting can exceed 1.0, but
+//		32 bits per pixel instead of RGBA16F's 64, which halves the bandwidth of every write and read.
+//		If the driver can't render to the requested format it falls back to RGBA16F.
+class RenderTarget {
+
+	private:
+		GLuint fbo;
+		GLuint colorTexture;
+		GLuint depthBuffer;
+		GLenum colorFormat;
+		int width;
+		int height;
+
+		bool allocate(GLenum format);
+
+	public:
+		// Constructor
+		RenderTarget(int width, int height, GLenum colorFormat = GL_R11F_G11F_B10F);
+		~RenderTarget();
+
+		RenderTarget(const RenderTarget&) = delete;
+		RenderTarget& operator=(const RenderTarget&) = delete;
+
+		// Functions
+		// Reallocates only when the size actually changes. Zero sizes (minimised window) are ignored.
+		void resize(int width, int height);
+
+		// Draw into this target; also sets the viewport to cover it.
+		void bind();
+
+		// Copy the colour buffer into the window's framebuffer, which is left bound afterwards.
+		void blitToScreen(int screenWidth, int screenHeight);
+
+		GLuint texture() const { return colorTexture; }
+		GLenum format() const { return colorFormat; }
+};
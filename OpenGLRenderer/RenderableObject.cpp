@@ -1,67 +1,217 @@
 #include "RenderableObject.h"
 
+// Local Library Includes
+#include "IndirectRenderer.h"
+#include "VertexPullingPool.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// The texture most recently bound by Draw(), shared across every RenderableObject.
+unsigned int RenderableObject::boundTexture = 0;
+
+// The VAO most recently bound by Draw() or DrawGeometry(). Objects in the same arena page share one.
+unsigned int RenderableObject::boundVao = 0;
+
+// Where constructors send their uploads, or nullptr to upload on the spot.
+UploadQueue* RenderableObject::uploadQueue = nullptr;
+
+// Where constructors place their geometry, or nullptr for buffers of their own.
+GeometryArena* RenderableObject::geometryArena = nullptr;
+
+// Where constructors convert their geometry for vertex pulling, or nullptr. Checked before the arena.
+VertexPullingPool* RenderableObject::vertexPullingPool = nullptr;
+
 // Member functions definitions including constructor
 RenderableObject::RenderableObject(vector<float>& verts, vector<unsigned int>& inds, unsigned int indexCount, const char* vertPath, const char* fragPath, const char* texPath) {
 	cout << "RenderableObject is being created" << endl;
 
-	// TEMP hard coded values for testing purposes
-	float squareVerts[] = {
-		// positions			// colors				// tex co-ords
-		0.5f,  0.5f, 0.0f,		1.0f, 0.0f, 0.0f,		1.0f, 1.0f,
-		0.5f, -0.5f, 0.0f,		0.0f, 1.0f, 0.0f,		1.0f, 0.0f,
-		-0.5f, -0.5f, 0.0f,		0.0f, 0.0f, 1.0f,		0.0f, 0.0f,
-		-0.5f,  0.5f, 0.0f,		0.0f, 0.0f, 0.0f,		0.0f, 1.0f
-	};
+	loadTexture(texPath);
+	setupGeometry(verts.data(), defaultVertexCount(verts), VertexLayout::of<DefaultVertex>(), inds.data(), min<size_t>(indexCount, inds.size()));
 
-	unsigned int squareIndices[] = { // note that we start from 0!
-		0, 1, 3,   // first triangle
-		1, 2, 3    // second triangle
-	};
+	transformation_vector = glm::vec4(0.0, 0.0, 0.0, 1.0);
+	setupShader(vertPath, fragPath);
+}
 
-	float* vertArray = &verts[0]; // Create a pointer to the values stored in the vector. C++ guarantees vector arrays are stored contiguously
-	unsigned int* indexArray = &inds[0];
+// Objects built from an atlas region share the page texture instead of owning one.
+//		Their UVs are rewritten at ingestion time so Draw() never needs to know about the atlas.
+RenderableObject::RenderableObject(vector<float>& verts, vector<unsigned int>& inds, unsigned int indexCount, const char* vertPath, const char* fragPath, const TextureAtlas& atlas, const string& regionName) {
+	cout << "RenderableObject is being created from atlas region " << regionName << endl;
 
-	// ..:: Initialization code (done once (unless your object frequently changes)) ::..
-	unsigned int VBO, EBO, VAO;
-	glGenVertexArrays(1, &VAO);
+	const AtlasRegion* region = atlas.find(regionName);
+	if (region) {
+		textureRef.texture = atlas.pageTexture(region->page);
+	}
+	else
+	{
+		std::cout << "Failed to find atlas region " << regionName << std::endl;
+	}
 
-	// 1. Create an ID for a new VBO & EBO to send to the Vertex Shader for rendering, stored in the GPU.
-	glGenBuffers(1, &VBO);
-	glGenBuffers(1, &EBO);
+	// Atlas regions only cover part of the page, so squash the UVs into that rectangle.
+	vector<float> remapped = verts;
+	if (region)
+		TextureAtlas::remapUVs(remapped, sizeof(DefaultVertex) / sizeof(float), offsetof(DefaultVertex, texCoord) / sizeof(float), *region);
 
-	// ------------- TEXTURES ----------------
-	glGenTextures(1, &texture); // Takes in how many textures are required, stores them in an unsigned int array
-	glActiveTexture(GL_TEXTURE0); // Activate the texture unit before binding it. Default is 0.
-	glBindTexture(GL_TEXTURE_2D, texture);
+	setupGeometry(remapped.data(), defaultVertexCount(remapped), VertexLayout::of<DefaultVertex>(), inds.data(), min<size_t>(indexCount, inds.size()));
 
-	// Set how textures will be wrapped if a vertex falls outside the given coordinates
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	transformation_vector = glm::vec4(0.0, 0.0, 0.0, 1.0);
+	setupShader(vertPath, fragPath);
+}
 
-	// Set how texels are interpolated when scaling the image up or down
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST); // Textures downscaled
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Textures upscaled
+// Objects whose texture lives in a shared TextureArray layer or a BindlessTextureTable slot.
+//		The fragment shader must match the reference: TextureArray.frag for arrays,
+//		and BindlessTextureTable::fragmentShader() for bindless (which already handles the fallback).
+RenderableObject::RenderableObject(vector<float>& verts, vector<unsigned int>& inds, unsigned int indexCount, const char* vertPath, const char* fragPath, const TextureRef& texRef) {
+	cout << "RenderableObject is being created" << endl;
+
+	textureRef = texRef;
+
+	setupGeometry(verts.data(), defaultVertexCount(verts), VertexLayout::of<DefaultVertex>(), inds.data(), min<size_t>(indexCount, inds.size()));
+
+	transformation_vector = glm::vec4(0.0, 0.0, 0.0, 1.0);
+	setupShader(vertPath, fragPath);
+}
+
+RenderableObject::RenderableObject(const QuantizedMesh& mesh, const char* vertPath, const char* fragPath, const char* texPath) {
+	cout << "RenderableObject is being created" << endl;
+
+	loadTexture(texPath);
+
+	// Set before the geometry, which a vertex pulling pool dequantizes as it converts.
+	dequantization = mesh.dequantization;
+	setupGeometry(mesh.vertices.data(), mesh.vertices.size(), VertexLayout::of<QuantizedVertex>(), mesh.indices.data(), mesh.indices.size());
+
+	// The positions aren't floats, so the bounds come from the range they were quantized over.
+	boundsCenter = dequantization.positionOffset + dequantization.positionScale * 0.5f;
+	boundsRadius = glm::length(dequantization.positionScale) * 0.5f;
+
+	transformation_vector = glm::vec4(0.0, 0.0, 0.0, 1.0);
+	setupShader(vertPath, fragPath);
+}
+
+RenderableObject::RenderableObject(const MeshFile& mesh, const char* vertPath, const char* fragPath, const char* texPath) {
+	cout << "RenderableObject is being created" << endl;
+
+	loadTexture(texPath);
+
+	if (mesh.isQuantized())
+		dequantization = mesh.dequantization();
+	setupGeometry(mesh.vertexData(), mesh.vertexCount(), mesh.layout(), mesh.indexData(), mesh.indexCount(), mesh.indexType());
+
+	// Every LOD shares the uploaded index buffer; start with the full detail one.
+	setLods(mesh.lods());
 
-	// Fill the data by passing references into the stbi_load functions.
-	int imgWidth, imgHeight, nrChannels;
-	stbi_set_flip_vertically_on_load(true); // accounts for conversion between 1.0y and 0.0y to prevent upside-down textures.
-	unsigned char* textureData = stbi_load(texPath, &imgWidth, &imgHeight, &nrChannels, 0);
+	boundsCenter = (mesh.boundsMin() + mesh.boundsMax()) * 0.5f;
+	boundsRadius = glm::length(mesh.boundsMax() - mesh.boundsMin()) * 0.5f;
+
+	transformation_vector = glm::vec4(0.0, 0.0, 0.0, 1.0);
+	setupShader(vertPath, fragPath);
+}
+
+RenderableObject::RenderableObject(const GlbPrimitive& primitive, const char* vertPath, const char* fragPath, const char* texPath) {
+	cout << "RenderableObject is being created" << endl;
 
-	if (textureData) {
-		// This function call applies the image to the currently bound texture object.
-		// After the image is loaded, we generate the mipmaps to account for distant objects.
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imgWidth, imgHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-		glGenerateMipmap(GL_TEXTURE_2D);
+	loadTexture(texPath);
+
+	// The geometry is already on the GPU in the file's own formats; just draw from the model's VAO.
+	vao = primitive.vao;
+	vbo = 0;
+	ebo = primitive.indexBuffer;
+	baseVertex = 0;
+	firstIndex = primitive.firstIndex;
+	lodOffset = 0;
+	indexType = primitive.indexType;
+	numIndices = (unsigned int)primitive.indexCount;
+	whiteVertexColor = !primitive.hasColor;
+	vertexCount = 0;
+	indexCapacity = 0;		// The model's buffers aren't ours to update.
+
+	boundsCenter = (primitive.boundsMin + primitive.boundsMax) * 0.5f;
+	boundsRadius = glm::length(primitive.boundsMax - primitive.boundsMin) * 0.5f;
+
+	transformation_vector = glm::vec4(0.0, 0.0, 0.0, 1.0);
+	setupShader(vertPath, fragPath);
+}
+
+void RenderableObject::setupShader(const char* vertPath, const char* fragPath) {
+	shader_program = Shader(vertPath, fragPath);
+
+	// Looked up once here rather than every Draw(). Shaders without these uniforms just get -1.
+	textureLayerLocation = glGetUniformLocation(shader_program.ID, "textureLayer");
+	textureIndexLocation = glGetUniformLocation(shader_program.ID, "textureIndex");
+	positionScaleLocation = glGetUniformLocation(shader_program.ID, "dequantPositionScale");
+	positionOffsetLocation = glGetUniformLocation(shader_program.ID, "dequantPositionOffset");
+	texCoordTransformLocation = glGetUniformLocation(shader_program.ID, "dequantTexCoord");
+	BindlessTextureTable::attachToProgram(shader_program.ID);
+
+	// Pulling shaders read the pool's buffer texture, which stays bound to its own unit.
+	int pulledVerticesLocation = glGetUniformLocation(shader_program.ID, "pulledVertices");
+	if (pulledVerticesLocation != -1) {
+		shader_program.use();
+		glUniform1i(pulledVerticesLocation, VertexPullingPool::textureUnit);
 	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
+}
+
+// Vertex data handed over as plain floats is read as DefaultVertex: position, colour, texture co-ordinates.
+size_t RenderableObject::defaultVertexCount(const vector<float>& verts) {
+	const size_t floatsPerVertex = sizeof(DefaultVertex) / sizeof(float);
+	if (verts.size() % floatsPerVertex != 0)
+		cout << "ERROR::RENDERABLE_OBJECT::VERTEX_DATA_NOT_A_MULTIPLE_OF_DEFAULT_VERTEX" << endl;
+	return verts.size() / floatsPerVertex;
+}
+
+void RenderableObject::setupGeometry(const void* vertexData, size_t vertexCount, const VertexLayout& layout, const void* indexData, size_t indexCount, GLenum indexType) {
+	computeBounds(vertexData, vertexCount, layout);
+	numIndices = (unsigned int)indexCount;
+	vertexLayout = layout;
+	this->vertexCount = vertexCount;
+	indexCapacity = indexCount;
+	baseVertex = 0;
+	firstIndex = 0;
+	lodOffset = 0;
+	this->indexType = indexType;
+
+	// With a vertex pulling pool the mesh is converted to the pool's format, already dequantized, and drawn
+	//		from the pool's attribute-less VAO. Vertices can't be updated in place (vbo stays 0); indices can.
+	if (vertexPullingPool) {
+		if (uploadQueue && !uploads)
+			uploads = make_shared<UploadTicket>();
+
+		PulledMesh mesh = vertexPullingPool->add(layout, vertexData, vertexCount, indexData, indexCount, indexType, dequantization, uploadQueue, uploads);
+		vao = vertexPullingPool->vertexArray();
+		vbo = 0;
+		ebo = vertexPullingPool->indexBufferId();
+		baseVertex = max(mesh.baseVertex, 0);
+		firstIndex = mesh.firstIndex;
+		this->indexType = GL_UNSIGNED_INT;
+		if (!mesh.valid())
+			numIndices = 0;
+		return;
 	}
-	
-	// Once we've generated the texture and mipmaps, we free the image memory
-	stbi_image_free(textureData);
 
+	// With an arena the mesh is copied into a shared page whose VAO already has this layout set up.
+	if (geometryArena) {
+		if (uploadQueue && !uploads)
+			uploads = make_shared<UploadTicket>();
+
+		GeometryRange range = geometryArena->allocate(layout, vertexData, vertexCount, indexData, indexCount, indexType, uploadQueue, uploads);
+		vao = range.vao;
+		vbo = range.vertexBuffer;
+		ebo = range.indexBuffer;
+		baseVertex = range.baseVertex;
+		firstIndex = range.firstIndex;
+		return;
+	}
 
+	// ..:: Initialization code (done once (unless your object frequently changes)) ::..
+	unsigned int VBO, EBO, VAO;
+	glGenVertexArrays(1, &VAO);
+
+	// 1. Create an ID for a new VBO & EBO to send to the Vertex Shader for rendering, stored in the GPU.
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
 	// ------------------ Vertex Array Object --------------------
 	glBindVertexArray(VAO);
 
@@ -69,61 +219,301 @@ RenderableObject::RenderableObject(vector<float>& verts, vector<unsigned int>& i
 	//		Any buffer calls made on GL_ARRAY_BUFFER will refer to and configure our VBO until it is re-bound.
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
-	// Copy the previously defined vertex data into the bound buffer's memory.
+	// Copy the caller's vertex data into the bound buffer's memory, exactly as laid out in their vertex struct.
 	//		The graphics card will manage the data as follows:
 	//			GL_STREAM_DRAW: the data is set only once, and used by the GPU at most a few times.
 	//			GL_STATIC_DRAW: the data is set only once, and used many times.
 	//			GL_DYNAMIC_DRAW : the data is changed a lot, and used many times.
-	glBufferData(GL_ARRAY_BUFFER, sizeof(squareVerts), squareVerts, GL_STATIC_DRAW);
+	//
+	//		With an upload queue, only the storage is allocated here (cheap, nothing is copied);
+	//		the contents follow within the queue's per-frame budget.
+	size_t vertexBytes = vertexCount * layout.stride;
+	size_t indexBytes = indexCount * PackedIndices::typeSize(indexType);
+	glBufferData(GL_ARRAY_BUFFER, vertexBytes, uploadQueue ? NULL : vertexData, GL_STATIC_DRAW);
 
 	// Next, we bind our index array in the same way as our VBO
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(squareIndices), squareIndices, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, uploadQueue ? NULL : indexData, GL_STATIC_DRAW);
+
+	if (uploadQueue) {
+		if (!uploads)
+			uploads = make_shared<UploadTicket>();
+
+		const unsigned char* vertexBegin = (const unsigned char*)vertexData;
+		const unsigned char* indexBegin = (const unsigned char*)indexData;
+		uploadQueue->uploadBuffer(VBO, 0, vector<unsigned char>(vertexBegin, vertexBegin + vertexBytes), UploadPriority::High, uploads);
+		uploadQueue->uploadBuffer(EBO, 0, vector<unsigned char>(indexBegin, indexBegin + indexBytes), UploadPriority::High, uploads);
+	}
 
 	// 2. OpenGL does not yet know how it should interpret the vertex data in memory.
-	//		Now we define how it should connect the vertex data to the vertex shader's attributes
-	// ---
-	//		The first parameter specifies which vertex attribute we want to configure. Remember that we specified the location of the position vertex attribute in the vertex shader with layout (location = 0). This sets the location of the vertex attribute to 0 and since we want to pass data to this vertex attribute, we pass in 0.
-	//		The next argument specifies the size of the vertex attribute.The vertex attribute is a vec3 so it is composed of 3 values.
-	//		The third argument specifies the type of the data which is GL_FLOAT(a vec * in GLSL consists of floating point values).
-	//		The next argument specifies if we want the data to be normalized.If we're inputting integer data types (int, byte) and we've set this to GL_TRUE, the integer data is normalized to 0 (or -1 for signed data) and 1 when converted to float.This is not relevant for us so we'll leave this at GL_FALSE.
-	//		The fifth argument is known as the stride and tells us the space between consecutive vertex attributes.Since the next set of position data is located exactly 3 times the size of a float away we specify that value as the stride.Note that since we know that the array is tightly packed(there is no space between the next vertex attribute value) we could've also specified the stride as 0 to let OpenGL determine the stride (this only works when values are tightly packed). Whenever we have more vertex attributes we have to carefully define the spacing between each vertex attribute.
-	//		The last parameter is of type void*and thus requires that weird cast.This is the offset of where the position data begins in the buffer.Since the position data is at the start of the data array this value is just 0. We will explore this parameter in more detail later on
-	// ---
-	
-	// Here, I'm defining the attributes as variables to clearly label HOW these values are being used below.
-	int positionAttributeID = 0;
-	int posAttributeSize = 3; // 3 - x, y, z.
-	int posOffset = 0;
-
-	int colorAttributeID = 1;
-	int colAttributeSize = 3; // 3 - r, g, b. Could be 4 if 'a' is also needed
-	int colOffset = posAttributeSize;
-
-	int textureAttributeID = 2;
-	int texAttributeSize = 2; // 2 - Only need a 2D coord for UV's
-	int texOffset = (posAttributeSize + colAttributeSize);
-
-	int attributeOffset = (posAttributeSize + colAttributeSize + texAttributeSize); // The sum of all attribute sizes
-
-	// Vertex Position Attribute
-	glVertexAttribPointer(positionAttributeID, posAttributeSize, GL_FLOAT, GL_FALSE, attributeOffset * sizeof(float), (void*)posOffset); // 0 is the offset.
-	glEnableVertexAttribArray(positionAttributeID);
-
-	// Vertex Color Attribute
-	glVertexAttribPointer(colorAttributeID, colAttributeSize, GL_FLOAT, GL_FALSE, attributeOffset * sizeof(float), (void*)(colOffset * sizeof(float))); // Start at the END of position attribute
-	glEnableVertexAttribArray(colorAttributeID);
-
-	// Texture Coordinate Attribute
-	glVertexAttribPointer(textureAttributeID, texAttributeSize, GL_FLOAT, GL_FALSE, attributeOffset * sizeof(float), (void*)(texOffset * sizeof(float)));
-	glEnableVertexAttribArray(textureAttributeID);
+	//		Each attribute needs its shader location, component count and type, whether integers are normalized,
+	//		the stride between consecutive vertices and the byte offset of the attribute within a vertex.
+	//		All of that comes from the vertex type's VertexLayout, worked out at compile time from its members,
+	//		so there are no hand-computed offsets here to fall out of step with the data.
+	layout.apply();
+	boundVao = VAO;
 
 	vao = VAO;
 	vbo = VBO;
 	ebo = EBO;
-	transformation_vector = glm::vec4(0.0, 0.0, 0.0, 1.0);
-	shader_program = Shader(vertPath, fragPath);
-	numIndices = indexCount;
+}
+
+// A bounding sphere around the positions (location 0), used to estimate on-screen size.
+void RenderableObject::computeBounds(const void* vertexData, size_t vertexCount, const VertexLayout& layout) {
+	boundsCenter = glm::vec3(0.0f);
+	boundsRadius = 0.0f;
+
+	vector<glm::vec3> positions;
+	if (vertexCount == 0 || !layout.readPositions(vertexData, vertexCount, positions))
+		return;
+
+	glm::vec3 minPos = positions[0], maxPos = positions[0];
+	for (const glm::vec3& p : positions) {
+		minPos = glm::min(minPos, p);
+		maxPos = glm::max(maxPos, p);
+	}
+	boundsCenter = (minPos + maxPos) * 0.5f;
+	boundsRadius = glm::length(maxPos - minPos) * 0.5f;
+}
+
+void RenderableObject::loadTexture(const char* texPath) {
+	// ------------- TEXTURES ----------------
+	textureRef = TextureRef();
+	glGenTextures(1, &textureRef.texture); // Takes in how many textures are required, stores them in an unsigned int array
+	glActiveTexture(GL_TEXTURE0); // Activate the texture unit before binding it. Default is 0.
+	glBindTexture(GL_TEXTURE_2D, textureRef.texture);
+	boundTexture = textureRef.texture;
+
+	// Set how textures will be wrapped if a vertex falls outside the given coordinates
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	// Set how texels are interpolated when scaling the image up or down
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST); // Textures downscaled
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Textures upscaled
+
+	// Decode the image and build the mip chain on the CPU rather than with glGenerateMipmap, which can stall the driver.
+	//		The generator filters in linear space, so distant objects don't darken the way box-filtered sRGB mips do.
+	//		After the chain is built, every level is applied to the currently bound texture object.
+	MipChain mipChain = TextureLoader::loadMipChain(texPath, TextureCategory::Default);
+	if (uploadQueue) {
+		if (!uploads)
+			uploads = make_shared<UploadTicket>();
+		uploadQueue->uploadMipChain(textureRef.texture, std::move(mipChain), UploadPriority::Normal, uploads);
+	}
+	else {
+		MipmapGenerator::upload(GL_TEXTURE_2D, mipChain);
+	}
+}
+
+// Forget which texture and VAO Draw() last bound. Called at the start of each frame,
+//		since uploads and other systems bind textures behind our back between frames.
+void RenderableObject::beginFrame() {
+	boundTexture = 0;
+	boundVao = 0;
+
+	if (vertexPullingPool)
+		vertexPullingPool->bind();
+}
+
+void RenderableObject::bindVertexArray(unsigned int vertexArray) {
+	if (vertexArray != boundVao) {
+		glBindVertexArray(vertexArray);
+		boundVao = vertexArray;
+	}
+}
+
+void RenderableObject::bindTexture(const TextureRef& ref, int layerLocation, int indexLocation) {
+	switch (ref.kind) {
+		case TextureKind::Single:
+			bindTexture2D(ref.texture);
+			break;
+		case TextureKind::Array:
+			if (ref.texture != boundTexture) {
+				glBindTexture(GL_TEXTURE_2D_ARRAY, ref.texture);
+				boundTexture = ref.texture;
+			}
+			glUniform1i(layerLocation, ref.index);
+			break;
+		case TextureKind::Bindless:
+			glUniform1i(indexLocation, ref.index);
+			break;
+		case TextureKind::Virtual:
+			break;
+	}
+}
+
+void RenderableObject::bindTexture2D(unsigned int texture) {
+	if (texture != boundTexture) {
+		glBindTexture(GL_TEXTURE_2D, texture);
+		boundTexture = texture;
+	}
+}
+
+void RenderableObject::setUploadQueue(UploadQueue* queue) {
+	uploadQueue = queue;
+}
+
+void RenderableObject::setGeometryArena(GeometryArena* arena) {
+	geometryArena = arena;
+}
+
+void RenderableObject::setVertexPullingPool(VertexPullingPool* pool) {
+	vertexPullingPool = pool;
+}
+
+void RenderableObject::setLods(const vector<MeshLod>& levels) {
+	lods = levels;
+	if (lods.empty())
+		return;
+
+	lodOffset = lods[0].firstIndex;
+	numIndices = lods[0].indexCount;
+}
+
+size_t RenderableObject::selectLod(const glm::vec3& cameraPos, float fovY, int viewportHeight, float maxPixelError) {
+	if (lods.size() < 2)
+		return 0;
+
+	// Measure to the nearest point of the bounding sphere, so no part of the mesh shows more error than allowed.
+	//		Draw() keeps nudging transformation_vector, but nothing renders with it, so the sphere stays where it was built.
+	float distance = glm::length(boundsCenter - cameraPos) - boundsRadius;
+	size_t level = MeshSimplifier::selectLod(lods, distance, fovY, viewportHeight, maxPixelError);
+
+	lodOffset = lods[level].firstIndex;
+	numIndices = lods[level].indexCount;
+	return level;
+}
+
+void RenderableObject::setMeshlets(shared_ptr<const MeshletMesh> clusters) {
+	meshlets = clusters;
+	visibleMeshlets.clear();
+	meshletCounts.clear();
+	meshletOffsets.clear();
+	meshletBaseVertices.clear();
+	if (!meshlets)
+		return;
+
+	meshletCounts.push_back((GLsizei)meshlets->indices.size());
+	meshletOffsets.push_back((const void*)(uintptr_t)(firstIndex * PackedIndices::typeSize(indexType)));
+	meshletBaseVertices.push_back(baseVertex);
+}
+
+size_t RenderableObject::cullMeshlets(const glm::mat4& viewProjection, const glm::vec3& cameraPos, WorkerPool* pool, bool coneCulling) {
+	if (!meshlets)
+		return 0;
+
+	// Meshlet bounds are in model space, and so is the drawn geometry (no shader applies transformation_vector),
+	//		so the frustum and camera are used as they are.
+	Frustum frustum = Frustum::fromMatrix(viewProjection);
+	MeshletCuller::cull(*meshlets, frustum, cameraPos, visibleMeshlets, pool, coneCulling);
+	MeshletCuller::drawRanges(*meshlets, visibleMeshlets, meshletFirstIndices, meshletCounts);
+
+	size_t indexSize = PackedIndices::typeSize(indexType);
+	meshletOffsets.resize(meshletCounts.size());
+	meshletBaseVertices.assign(meshletCounts.size(), baseVertex);
+	for (size_t i = 0; i < meshletCounts.size(); i++)
+		meshletOffsets[i] = (const void*)(uintptr_t)((firstIndex + meshletFirstIndices[i]) * indexSize);
+
+	return visibleMeshlets.size();
+}
+
+// ---
+// Updates after construction
+// ---
+void RenderableObject::updateVertices(size_t firstVertex, const void* data, size_t count) {
+	// Pulled and GLB objects have no vertex buffer of their own to edit.
+	if (vbo == 0) {
+		cout << "ERROR::RENDERABLE_OBJECT::VERTEX_UPDATES_NOT_SUPPORTED" << endl;
+		return;
+	}
+	if (firstVertex > vertexCount || count > vertexCount - firstVertex) {
+		cout << "ERROR::RENDERABLE_OBJECT::VERTEX_UPDATE_OUT_OF_RANGE" << endl;
+		return;
+	}
+
+	// In an arena page the object's vertices start at baseVertex.
+	size_t stride = vertexLayout.stride;
+	pendingVertices.write((baseVertex + firstVertex) * stride, data, count * stride);
+
+	// Moved vertices may leave the bounding sphere; grow it so culling and LOD selection stay conservative.
+	vector<glm::vec3> positions;
+	if (vertexLayout.readPositions(data, count, positions)) {
+		for (const glm::vec3& p : positions)
+			boundsRadius = max(boundsRadius, glm::length(p - boundsCenter));
+	}
+}
+
+void RenderableObject::updateIndices(size_t first, const vector<unsigned int>& inds) {
+	if (ebo == 0) {
+		cout << "ERROR::RENDERABLE_OBJECT::INDEX_UPDATES_NOT_SUPPORTED" << endl;
+		return;
+	}
+	if (first > indexCapacity || inds.size() > indexCapacity - first) {
+		cout << "ERROR::RENDERABLE_OBJECT::INDEX_UPDATE_OUT_OF_RANGE" << endl;
+		return;
+	}
+	for (unsigned int index : inds) {
+		if (index >= vertexCount) {
+			cout << "ERROR::RENDERABLE_OBJECT::INDEX_UPDATE_VERTEX_OUT_OF_RANGE" << endl;
+			return;
+		}
+	}
+
+	size_t offset = (firstIndex + first) * PackedIndices::typeSize(indexType);
+	if (indexType == GL_UNSIGNED_INT) {
+		pendingIndices.write(offset, inds.data(), inds.size() * sizeof(unsigned int));
+		return;
+	}
+
+	// Narrower index types hold the same values, since every index was checked against the vertex count.
+	vector<unsigned char> packed(inds.size() * PackedIndices::typeSize(indexType));
+	for (size_t i = 0; i < inds.size(); i++) {
+		if (indexType == GL_UNSIGNED_SHORT) {
+			unsigned short value = (unsigned short)inds[i];
+			memcpy(&packed[i * 2], &value, 2);
+		}
+		else
+			packed[i] = (unsigned char)inds[i];
+	}
+	pendingIndices.write(offset, packed.data(), packed.size());
+}
+
+// Queued initial uploads would land on top of the edits, so wait for them first.
+void RenderableObject::flushUpdates() {
+	if (uploads && !uploads->ready())
+		return;
+
+	pendingVertices.flush(vbo);
+	pendingIndices.flush(ebo);
+}
+
+void RenderableObject::submit(IndirectRenderer& renderer) const {
+	if (uploads && !uploads->ready())
+		return;
+
+	IndirectDraw draw;
+	draw.program = shader_program.ID;
+	draw.vao = vao;
+	draw.texture = textureRef;
+	draw.indexType = indexType;
+	draw.count = numIndices;
+	draw.firstIndex = firstIndex + lodOffset;
+	draw.baseVertex = baseVertex;
+	draw.data.transform = glm::mat4(1.0f);
+	draw.data.color = glm::vec4(1.0f);
+	// Geometry is drawn in model space (the identity transform above), so cull in it too; transformation_vector
+	//		isn't applied by any shader.
+	draw.center = boundsCenter;
+	draw.radius = boundsRadius;
+	renderer.add(draw);
+}
+
+void RenderableObject::requestTextureDetail(TextureStreamer& streamer, const glm::vec3& cameraPos, float fovY, int viewportHeight) const {
+	if (textureRef.kind != TextureKind::Single)
+		return;
+
+	streamer.requestPixels(textureRef.texture, TextureStreamer::projectedPixels(boundsCenter, boundsRadius, cameraPos, fovY, viewportHeight));
 }
 
 void RenderableObject::translate(glm::vec3 translation) {
@@ -154,6 +544,11 @@ void RenderableObject::scale(glm::vec3 scale) {
 }
 
 void RenderableObject::Draw() {
+	// Still waiting on the upload queue; drawing now would show an empty buffer or an incomplete texture.
+	if (uploads && !uploads->ready())
+		return;
+
+	flushUpdates();
 	translate(glm::vec3(1.0f, 1.0f, 0.0f));
 
 	// TEST - Changing uniforms over time.
@@ -171,16 +566,55 @@ void RenderableObject::Draw() {
 	// This must be done AFTER "using" the program.
 	glUniform4f(vertColorLocation, 0.0f, green, 0.0f, 1.0f);
 
+	// Quantized meshes are scaled back to their own units in the vertex shader.
+	if (positionScaleLocation != -1) {
+		glUniform3f(positionScaleLocation, dequantization.positionScale.x, dequantization.positionScale.y, dequantization.positionScale.z);
+		glUniform3f(positionOffsetLocation, dequantization.positionOffset.x, dequantization.positionOffset.y, dequantization.positionOffset.z);
+		glUniform4f(texCoordTransformLocation, dequantization.texCoordScale.x, dequantization.texCoordScale.y, dequantization.texCoordOffset.x, dequantization.texCoordOffset.y);
+	}
+
 	// 2. Bind the VAO of the object we want to draw.
-	glBindVertexArray(vao);
+	//		Objects in the same arena page share a VAO, so back to back draws skip the switch.
+	bindVertexArray(vao);
 
 	// 3. Bind the texture to the object
-	glBindTexture(GL_TEXTURE_2D, texture);
+	//		Objects sharing an atlas page or texture array skip the bind entirely when drawn back to back,
+	//		and bindless objects never bind at all - they just tell the shader which handle to use.
+	bindTexture(textureRef, textureLayerLocation, textureIndexLocation);
 
 	// 4. Draw the object.
 	//		Use DrawArrays for ordered, and DrawElements for indexed.
 	//glDrawArrays(GL_TRIANGLES, 0, 6);
-	glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, 0);
+	drawElements();
 	// 5. Unbind the VAO
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Issue just the geometry with whatever program is already bound.
+//		Used by passes that replace the object's own shader, such as the virtual texture feedback pass.
+void RenderableObject::DrawGeometry() {
+	if (uploads && !uploads->ready())
+		return;
+
+	flushUpdates();
+	bindVertexArray(vao);
+	drawElements();
+}
+
+// BaseVertex offsets the mesh's indices to where its vertices sit in a shared arena buffer.
+void RenderableObject::drawElements() {
+	// The generic attribute value is context state, so anything drawn since may have changed it.
+	if (whiteVertexColor)
+		glVertexAttrib4f(1, 1.0f, 1.0f, 1.0f, 1.0f);
+
+	if (meshlets) {
+		if (!meshletCounts.empty())
+			glMultiDrawElementsBaseVertex(GL_TRIANGLES, meshletCounts.data(), indexType, meshletOffsets.data(), (GLsizei)meshletCounts.size(), meshletBaseVertices.data());
+		return;
+	}
+	glDrawElementsBaseVertex(GL_TRIANGLES, numIndices, indexType, (const void*)(uintptr_t)((firstIndex + lodOffset) * PackedIndices::typeSize(indexType)), baseVertex);
+}
+
+unsigned int RenderableObject::shaderProgram() const {
+	return shader_program.ID;
 }
\ No newline at end of file
@@ -10,36 +10,215 @@
 #include <glm/gtc/type_ptr.hpp>
 
 // Local Library Includes
+#include "BindlessTextureTable.h"
+#include "DirtyRangeSet.h"
+#include "GeometryArena.h"
+#include "GlbModel.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
+#include "MipmapGenerator.h"
 #include "Shader.h"
+#include "TextureArray.h"
+#include "TextureAtlas.h"
+#include "TextureLoader.h"
+#include "TextureRef.h"
+#include "TextureStreamer.h"
+#include "UploadQueue.h"
+#include "VertexLayout.h"
+#include "VertexQuantizer.h"
 #include "stb_image.h"
 
 // Standard Library Includes
 #include <iostream>
+#include <memory>
+#include <string>
 #include <vector>
 
 using namespace std;
 
+class IndirectRenderer;
+class VertexPullingPool;
+
 class RenderableObject {
 
 	private:
 		unsigned int vao, vbo, ebo;
-		unsigned int texture;
+		GLint baseVertex;		// Where the mesh starts when it lives in a shared GeometryArena page, otherwise 0.
+		GLuint firstIndex;
+		GLenum indexType;		// GL_UNSIGNED_SHORT for meshes packed by MeshOptimizer::packIndices.
+		TextureRef textureRef;
 		Shader shader_program;
+		int textureLayerLocation, textureIndexLocation;
+		int positionScaleLocation, positionOffsetLocation, texCoordTransformLocation;
+		Dequantization dequantization;	// Identity unless the object was built from a QuantizedMesh.
 		glm::vec4 transformation_vector;
+		glm::vec3 boundsCenter;	// Model space, which is also where the geometry is drawn: no shader applies transformation_vector.
+		float boundsRadius;
+		bool whiteVertexColor = false;	// Set the generic colour attribute to white before drawing (GLB primitives without COLOR_0).
+		vector<MeshLod> lods;	// Ranges of the object's indices, finest first. Empty for single-level meshes.
+		GLuint lodOffset;		// Where the selected LOD starts, relative to firstIndex.
+
+		// Clusters for finer-than-object culling, and the index ranges that survived the last cullMeshlets().
+		shared_ptr<const MeshletMesh> meshlets;
+		vector<unsigned int> visibleMeshlets;
+		vector<GLuint> meshletFirstIndices;
+		vector<GLsizei> meshletCounts;
+		vector<const void*> meshletOffsets;
+		vector<GLint> meshletBaseVertices;
 
 		vector<float>* vertices;
 		vector<int>* indices;
 		
 		unsigned int numIndices;
 
+		// What updateVertices/updateIndices need to place and check writes, and the writes not yet sent.
+		VertexLayout vertexLayout;
+		size_t vertexCount;
+		size_t indexCapacity;
+		DirtyRangeSet pendingVertices, pendingIndices;
+
+		// Outstanding uploads when the object was created through an UploadQueue. Draw() waits for them.
+		shared_ptr<UploadTicket> uploads;
+
+		static unsigned int boundTexture;
+		static unsigned int boundVao;
+		static UploadQueue* uploadQueue;
+		static GeometryArena* geometryArena;
+		static VertexPullingPool* vertexPullingPool;
+
+		void loadTexture(const char* texPath);
+		void setupGeometry(const void* vertexData, size_t vertexCount, const VertexLayout& layout, const void* indexData, size_t indexCount, GLenum indexType = GL_UNSIGNED_INT);
+		void computeBounds(const void* vertexData, size_t vertexCount, const VertexLayout& layout);
+		void setupShader(const char* vertPath, const char* fragPath);
+		void drawElements();
+
+		static size_t defaultVertexCount(const vector<float>& verts);
+
 	public:
 		// Constructor
 		RenderableObject(vector<float>& verts, vector<unsigned int>& inds, unsigned int indexCount, const char* vertPath, const char* fragPath, const char* texPath);
+		RenderableObject(vector<float>& verts, vector<unsigned int>& inds, unsigned int indexCount, const char* vertPath, const char* fragPath, const TextureAtlas& atlas, const string& regionName);
+		RenderableObject(vector<float>& verts, vector<unsigned int>& inds, unsigned int indexCount, const char* vertPath, const char* fragPath, const TextureRef& texRef);
+
+		// A primitive of a loaded GlbModel. The model keeps ownership of the buffers and must outlive the object.
+		RenderableObject(const GlbPrimitive& primitive, const char* vertPath, const char* fragPath, const char* texPath);
+
+		// A mesh in the runtime format. Its blobs are uploaded (or queued) straight from the mapped file,
+		//		which only needs to stay open until the constructor returns.
+		RenderableObject(const MeshFile& mesh, const char* vertPath, const char* fragPath, const char* texPath);
+
+		// Quantized meshes need a vertex shader that undoes the quantization, such as Quantized.vert.
+		RenderableObject(const QuantizedMesh& mesh, const char* vertPath, const char* fragPath, const char* texPath);
+
+		// Meshes in any vertex format with an attributes() description (see VertexLayout.h).
+		//		The vertices are uploaded as they are, with no per-vertex conversion.
+		template<typename Vertex>
+		RenderableObject(const vector<Vertex>& verts, const vector<unsigned int>& inds, const char* vertPath, const char* fragPath, const char* texPath) {
+			cout << "RenderableObject is being created" << endl;
+
+			loadTexture(texPath);
+			setupGeometry(verts.data(), verts.size(), VertexLayout::of<Vertex>(), inds.data(), inds.size());
+
+			transformation_vector = glm::vec4(0.0, 0.0, 0.0, 1.0);
+			setupShader(vertPath, fragPath);
+		}
+
+		// Meshes that went through MeshOptimizer, with indices in whatever type packIndices chose.
+		template<typename Vertex>
+		RenderableObject(const vector<Vertex>& verts, const PackedIndices& inds, const char* vertPath, const char* fragPath, const char* texPath) {
+			cout << "RenderableObject is being created" << endl;
+
+			loadTexture(texPath);
+			setupGeometry(verts.data(), verts.size(), VertexLayout::of<Vertex>(), inds.data(), inds.count, inds.type);
+
+			transformation_vector = glm::vec4(0.0, 0.0, 0.0, 1.0);
+			setupShader(vertPath, fragPath);
+		}
+
+		template<typename Vertex>
+		RenderableObject(const vector<Vertex>& verts, const vector<unsigned int>& inds, const char* vertPath, const char* fragPath, const TextureRef& texRef) {
+			cout << "RenderableObject is being created" << endl;
+
+			textureRef = texRef;
+			setupGeometry(verts.data(), verts.size(), VertexLayout::of<Vertex>(), inds.data(), inds.size());
+
+			transformation_vector = glm::vec4(0.0, 0.0, 0.0, 1.0);
+			setupShader(vertPath, fragPath);
+		}
 
 		// Functions
 		void translate(glm::vec3 translation);
 		void rotate(glm::vec3 rotation);
 		void scale(glm::vec3 scale);
 		void Draw();
+		void DrawGeometry();
+		unsigned int shaderProgram() const;
+
+		// Index ranges of the object's levels of detail, e.g. from MeshSimplifier::buildLods. The indices the object
+		//		was created with must hold every level. Selects the finest level.
+		void setLods(const vector<MeshLod>& levels);
+
+		// Pick the coarsest LOD whose simplification error stays under maxPixelError pixels from the camera.
+		//		Returns the chosen level.
+		size_t selectLod(const glm::vec3& cameraPos, float fovY, int viewportHeight, float maxPixelError = 1.0f);
+
+		// Draw through meshlets instead of the whole index range. The object must have been created with
+		//		the meshlet mesh's indices. Until the first cullMeshlets() every cluster is drawn.
+		void setMeshlets(shared_ptr<const MeshletMesh> clusters);
+
+		// Keep only the clusters inside the frustum, drawn as one glMultiDrawElementsBaseVertex. Returns how many survived.
+		//		coneCulling also drops clusters facing away from the camera; see MeshletCuller::cull for when that is safe.
+		size_t cullMeshlets(const glm::mat4& viewProjection, const glm::vec3& cameraPos, WorkerPool* pool = nullptr, bool coneCulling = false);
+
+		// Overwrite part of the vertices or indices after construction. Writes are collected, merged where they
+		//		touch, and sent once by the next Draw() (or flushUpdates(), before submit()), so editing a few vertices of a big mesh
+		//		costs a few small uploads rather than a new object. Vertex data must be in the object's own format.
+		void updateVertices(size_t firstVertex, const void* data, size_t count);
+
+		template<typename Vertex>
+		void updateVertices(size_t firstVertex, const vector<Vertex>& verts) {
+			if (VertexLayout::of<Vertex>() != vertexLayout) {
+				cout << "ERROR::RENDERABLE_OBJECT::UPDATE_VERTEX_FORMAT_MISMATCH" << endl;
+				return;
+			}
+			updateVertices(firstVertex, verts.data(), verts.size());
+		}
+
+		// Indices are converted to the object's index type.
+		void updateIndices(size_t first, const vector<unsigned int>& inds);
+
+		void flushUpdates();
+
+		// Queue this object's current LOD as one draw of an IndirectRenderer flush, drawn with an identity transform
+		//		and white tint. Needs a shader that reads the draw index, such as Indirect.vert
+		//		(PulledIndirect.vert for pulled objects); quantized objects still use Draw().
+		void submit(IndirectRenderer& renderer) const;
+
+		// Tell the streamer how large this object's texture appears from the camera this frame.
+		void requestTextureDetail(TextureStreamer& streamer, const glm::vec3& cameraPos, float fovY, int viewportHeight) const;
+
+		const TextureRef& texture() const { return textureRef; }
+
+		static void beginFrame();
+
+		// Bind through the same cache Draw() uses, so other drawers (batches) don't leave it stale.
+		static void bindVertexArray(unsigned int vertexArray);
+		static void bindTexture(const TextureRef& ref, int layerLocation, int indexLocation);
+		static void bindTexture2D(unsigned int texture);	// A plain GL_TEXTURE_2D on unit 0, e.g. to upload into it.
+
+		// Queue new objects' buffer and texture data instead of uploading it inside the constructor.
+		//		Objects don't draw until their data has arrived. Pass nullptr to upload immediately again.
+		static void setUploadQueue(UploadQueue* queue);
+
+		// Place new objects' geometry in shared arena buffers instead of giving each its own VAO, VBO and EBO.
+		//		Pass nullptr to go back to per-object buffers.
+		static void setGeometryArena(GeometryArena* arena);
+
+		// Convert new objects' geometry into a VertexPullingPool instead, for shaders like Pulled.vert that fetch
+		//		vertices by gl_VertexID. Takes precedence over the arena. Every pulled object shares the pool's one VAO
+		//		whatever its vertex format, so Draw() never switches VAOs between them. Pass nullptr to stop.
+		static void setVertexPullingPool(VertexPullingPool* pool);
 
 };
\ No newline at end of file
@@ -0,0 +1,317 @@
+#include "StaticBatcher.h"
+
+// Local Library Includes
+#include "MeshOptimizer.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BATCHER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+	// Inverse transpose of the upper 3x3, up to scale: its columns are the cross products of the matrix's columns.
+	//		Normals are renormalized afterwards, so the missing 1/determinant only matters for its sign.
+	glm::mat4 normalMatrix(const glm::mat4& m) {
+		glm::vec3 a(m[0]), b(m[1]), c(m[2]);
+		float determinant = glm::dot(a, glm::cross(b, c));
+		float sign = determinant < 0.0f ? -1.0f : 1.0f;
+
+		glm::mat4 result(1.0f);
+		result[0] = glm::vec4(glm::cross(b, c) * sign, 0.0f);
+		result[1] = glm::vec4(glm::cross(c, a) * sign, 0.0f);
+		result[2] = glm::vec4(glm::cross(a, b) * sign, 0.0f);
+		result[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		return result;
+	}
+
+	void normalizeVectors(unsigned char* data, size_t stride, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			float v[3];
+			memcpy(v, data + i * stride, sizeof(v));
+			float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+			if (length > 0.0f) {
+				v[0] /= length;
+				v[1] /= length;
+				v[2] /= length;
+			}
+			memcpy(data + i * stride, v, sizeof(v));
+		}
+	}
+
+	bool isFloat3(const VertexAttribute* attribute) {
+		return attribute && attribute->type == GL_FLOAT && !attribute->integer && attribute->components == 3;
+	}
+}
+
+StaticBatcher::StaticBatcher(WorkerPool& pool) : pool(pool) {
+	nextId = 1;
+	drawCalls = 0;
+}
+
+StaticBatcher::~StaticBatcher() {
+	for (unique_ptr<Batch>& batch : batches)
+		destroy(*batch);
+}
+
+// ---
+// Membership
+// ---
+StaticBatcher::Batch* StaticBatcher::batchFor(GLuint program, const TextureRef& texture, const VertexLayout& layout) {
+	for (unique_ptr<Batch>& batch : batches) {
+		if (batch->program == program && batch->texture.kind == texture.kind && batch->texture.texture == texture.texture &&
+			batch->texture.index == texture.index && batch->layout == layout)
+			return batch.get();
+	}
+
+	unique_ptr<Batch> batch(new Batch());
+	batch->program = program;
+	batch->texture = texture;
+	batch->layout = layout;
+	batch->textureLayerLocation = glGetUniformLocation(program, "textureLayer");
+	batch->textureIndexLocation = glGetUniformLocation(program, "textureIndex");
+	batch->dirty = true;
+	batch->vao = batch->vbo = batch->ebo = 0;
+	batch->indexType = GL_UNSIGNED_INT;
+	batch->indexCount = 0;
+	batches.push_back(std::move(batch));
+	return batches.back().get();
+}
+
+unsigned int StaticBatcher::add(GLuint program, const TextureRef& texture, const VertexLayout& layout, const void* vertexData, size_t vertexCount,
+	const vector<unsigned int>& indices, const glm::mat4& transform) {
+	if (vertexCount == 0 || indices.size() < 3)
+		return 0;
+	if (!isFloat3(layout.find(0))) {
+		cout << "ERROR::STATIC_BATCHER::POSITION_NOT_FLOAT3" << endl;
+		return 0;
+	}
+	for (unsigned int index : indices) {
+		if (index >= vertexCount) {
+			cout << "ERROR::STATIC_BATCHER::INDEX_OUT_OF_RANGE" << endl;
+			return 0;
+		}
+	}
+
+	Batch* batch = batchFor(program, texture, layout);
+
+	Member member;
+	member.id = nextId++;
+	member.vertices.assign((const unsigned char*)vertexData, (const unsigned char*)vertexData + vertexCount * layout.stride);
+	member.vertexCount = vertexCount;
+	member.indices.assign(indices.begin(), indices.end() - indices.size() % 3);
+	member.transform = transform;
+	member.firstIndex = 0;
+	member.indexCount = 0;
+	batch->members.push_back(std::move(member));
+	batch->dirty = true;
+
+	owners[batch->members.back().id] = batch;
+	return batch->members.back().id;
+}
+
+bool StaticBatcher::remove(unsigned int id) {
+	auto owner = owners.find(id);
+	if (owner == owners.end())
+		return false;
+
+	Batch* batch = owner->second;
+	owners.erase(owner);
+	batch->members.erase(remove_if(batch->members.begin(), batch->members.end(), [id](const Member& member) { return member.id == id; }), batch->members.end());
+	batch->dirty = true;
+
+	if (batch->members.empty()) {
+		destroy(*batch);
+		batches.erase(find_if(batches.begin(), batches.end(), [batch](const unique_ptr<Batch>& b) { return b.get() == batch; }));
+	}
+	return true;
+}
+
+// ---
+// Building
+// ---
+void StaticBatcher::transformPoints(const glm::mat4& matrix, unsigned char* data, size_t stride, size_t count, float w) {
+#ifdef BATCHER_SSE2
+	// result = c0 * x + c1 * y + c2 * z + c3 * w, one column per register.
+	__m128 c0 = _mm_setr_ps(matrix[0].x, matrix[0].y, matrix[0].z, matrix[0].w);
+	__m128 c1 = _mm_setr_ps(matrix[1].x, matrix[1].y, matrix[1].z, matrix[1].w);
+	__m128 c2 = _mm_setr_ps(matrix[2].x, matrix[2].y, matrix[2].z, matrix[2].w);
+	__m128 c3 = _mm_mul_ps(_mm_setr_ps(matrix[3].x, matrix[3].y, matrix[3].z, matrix[3].w), _mm_set1_ps(w));
+
+	for (size_t i = 0; i < count; i++) {
+		float* p = (float*)(data + i * stride);
+		float xyz[4];
+		memcpy(xyz, p, 3 * sizeof(float));
+
+		__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(xyz[0])), _mm_mul_ps(c1, _mm_set1_ps(xyz[1]))),
+			_mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(xyz[2])), c3));
+		_mm_storeu_ps(xyz, r);
+		memcpy(p, xyz, 3 * sizeof(float));
+	}
+#else
+	for (size_t i = 0; i < count; i++) {
+		float xyz[3];
+		memcpy(xyz, data + i * stride, sizeof(xyz));
+		glm::vec4 r = matrix * glm::vec4(xyz[0], xyz[1], xyz[2], w);
+		xyz[0] = r.x;
+		xyz[1] = r.y;
+		xyz[2] = r.z;
+		memcpy(data + i * stride, xyz, sizeof(xyz));
+	}
+#endif
+}
+
+void StaticBatcher::rebuild(Batch& batch) {
+	const VertexLayout& layout = batch.layout;
+	GLuint positionOffset = layout.find(0)->offset;
+	const VertexAttribute* normal = layout.find(3);
+	bool hasNormals = isFloat3(normal);
+
+	// Where each member lands in the merged buffers.
+	vector<size_t> vertexStart(batch.members.size() + 1, 0);
+	vector<size_t> indexStart(batch.members.size() + 1, 0);
+	for (size_t m = 0; m < batch.members.size(); m++) {
+		vertexStart[m + 1] = vertexStart[m] + batch.members[m].vertexCount;
+		indexStart[m + 1] = indexStart[m] + batch.members[m].indices.size();
+	}
+	size_t vertexCount = vertexStart.back();
+	size_t indexCount = indexStart.back();
+
+	vector<unsigned char> vertices(vertexCount * layout.stride);
+	vector<unsigned int> indices(indexCount);
+
+	// Members are independent, so each worker copies, transforms and bounds its own.
+	pool.parallelFor(batch.members.size(), [&](size_t begin, size_t end) {
+		for (size_t m = begin; m < end; m++) {
+			Member& member = batch.members[m];
+			unsigned char* out = vertices.data() + vertexStart[m] * layout.stride;
+			memcpy(out, member.vertices.data(), member.vertices.size());
+
+			transformPoints(member.transform, out + positionOffset, layout.stride, member.vertexCount);
+			if (hasNormals) {
+				transformPoints(normalMatrix(member.transform), out + normal->offset, layout.stride, member.vertexCount, 0.0f);
+				normalizeVectors(out + normal->offset, layout.stride, member.vertexCount);
+			}
+
+			// A mirroring transform turns every triangle inside out; swap two corners to keep the front faces.
+			glm::vec3 a(member.transform[0]), b(member.transform[1]), c(member.transform[2]);
+			bool mirrored = glm::dot(a, glm::cross(b, c)) < 0.0f;
+			unsigned int* outIndices = indices.data() + indexStart[m];
+			unsigned int base = (unsigned int)vertexStart[m];
+			for (size_t i = 0; i < member.indices.size(); i += 3) {
+				outIndices[i] = member.indices[i] + base;
+				outIndices[i + 1] = member.indices[mirrored ? i + 2 : i + 1] + base;
+				outIndices[i + 2] = member.indices[mirrored ? i + 1 : i + 2] + base;
+			}
+
+			float xyz[3];
+			memcpy(xyz, out + positionOffset, sizeof(xyz));
+			member.boundsMin = member.boundsMax = glm::vec3(xyz[0], xyz[1], xyz[2]);
+			for (size_t v = 1; v < member.vertexCount; v++) {
+				memcpy(xyz, out + v * layout.stride + positionOffset, sizeof(xyz));
+				glm::vec3 p(xyz[0], xyz[1], xyz[2]);
+				member.boundsMin = glm::min(member.boundsMin, p);
+				member.boundsMax = glm::max(member.boundsMax, p);
+			}
+			member.firstIndex = (GLuint)indexStart[m];
+			member.indexCount = (GLsizei)member.indices.size();
+		}
+	}, 8);
+
+	batch.boundsMin = batch.members[0].boundsMin;
+	batch.boundsMax = batch.members[0].boundsMax;
+	for (const Member& member : batch.members) {
+		batch.boundsMin = glm::min(batch.boundsMin, member.boundsMin);
+		batch.boundsMax = glm::max(batch.boundsMax, member.boundsMax);
+	}
+
+	// 16-bit indices whenever the whole batch fits.
+	PackedIndices packed = MeshOptimizer::packIndices(indices, vertexCount);
+
+	// The VAO is kept across rebuilds; only the buffers' contents are replaced.
+	if (!batch.vao) {
+		glGenVertexArrays(1, &batch.vao);
+		glGenBuffers(1, &batch.vbo);
+		glGenBuffers(1, &batch.ebo);
+
+		RenderableObject::bindVertexArray(batch.vao);
+		glBindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.ebo);
+		layout.apply();
+	}
+	else {
+		RenderableObject::bindVertexArray(batch.vao);
+		glBindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+	}
+
+	glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, packed.bytes.size(), packed.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	batch.indexType = packed.type;
+	batch.indexCount = (GLsizei)indexCount;
+	batch.dirty = false;
+}
+
+void StaticBatcher::destroy(Batch& batch) {
+	if (!batch.vao)
+		return;
+
+	// A deleted VAO's name can come back from glGenVertexArrays; don't let the bind cache think it's still bound.
+	RenderableObject::bindVertexArray(0);
+	glDeleteVertexArrays(1, &batch.vao);
+	glDeleteBuffers(1, &batch.vbo);
+	glDeleteBuffers(1, &batch.ebo);
+	batch.vao = batch.vbo = batch.ebo = 0;
+}
+
+// ---
+// Drawing
+// ---
+void StaticBatcher::draw(const Frustum* frustum) {
+	drawCalls = 0;
+
+	for (unique_ptr<Batch>& owned : batches) {
+		Batch& batch = *owned;
+		if (batch.dirty)
+			rebuild(batch);
+		if (frustum && !frustum->intersectsBox(batch.boundsMin, batch.boundsMax))
+			continue;
+
+		// Runs of visible members; everything visible is one range and one glDrawElements.
+		size_t indexSize = PackedIndices::typeSize(batch.indexType);
+		rangeCounts.clear();
+		rangeOffsets.clear();
+		GLuint rangeEnd = ~0u;
+		for (const Member& member : batch.members) {
+			if (frustum && !frustum->intersectsBox(member.boundsMin, member.boundsMax))
+				continue;
+
+			if (member.firstIndex == rangeEnd)
+				rangeCounts.back() += member.indexCount;
+			else {
+				rangeCounts.push_back(member.indexCount);
+				rangeOffsets.push_back((const void*)(uintptr_t)(member.firstIndex * indexSize));
+			}
+			rangeEnd = member.firstIndex + member.indexCount;
+		}
+		if (rangeCounts.empty())
+			continue;
+
+		glUseProgram(batch.program);
+		RenderableObject::bindVertexArray(batch.vao);
+		RenderableObject::bindTexture(batch.texture, batch.textureLayerLocation, batch.textureIndexLocation);
+
+		if (rangeCounts.size() == 1)
+			glDrawElements(GL_TRIANGLES, rangeCounts[0], batch.indexType, rangeOffsets[0]);
+		else
+			glMultiDrawElements(GL_TRIANGLES, rangeCounts.data(), batch.indexType, rangeOffsets.data(), (GLsizei)rangeCounts.size());
+		drawCalls++;
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Local Library Includes
+#include "Frustum.h"
+#include "RenderableObject.h"
+#include "TextureRef.h"
+#include "VertexLayout.h"
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Merges static geometry that shares a shader program, texture and vertex layout into one buffer per group,
+//		so hundreds of props cost one draw instead of hundreds.
+//
+//		Each member's vertices are transformed into world space when the batch is built: positions by the member's
+//		matrix and normals (location 3, when they are floats) by its inverse transpose, in parallel across the pool
+//		with SSE2. Members keep their world bounds, so a batch whose box is off screen is skipped whole and one
+//		that is partly visible draws only the members that are, as runs of a glMultiDrawElements. Adding or removing
+//		a member marks its batch for rebuild, which happens at the next draw().
+//
+//		Members keep a CPU copy of their source geometry for rebuilds. Batched objects should no longer be drawn on their own.
+class StaticBatcher {
+
+	private:
+		struct Member {
+			unsigned int id;
+			vector<unsigned char> vertices;		// Source vertices, in the batch's layout.
+			size_t vertexCount;
+			vector<unsigned int> indices;
+			glm::mat4 transform;
+
+			// Filled in by rebuild().
+			GLuint firstIndex;
+			GLsizei indexCount;
+			glm::vec3 boundsMin, boundsMax;		// World space.
+		};
+
+		struct Batch {
+			GLuint program;
+			TextureRef texture;
+			VertexLayout layout;
+			int textureLayerLocation, textureIndexLocation;
+			vector<Member> members;
+			bool dirty;
+
+			unsigned int vao, vbo, ebo;
+			GLenum indexType;
+			GLsizei indexCount;
+			glm::vec3 boundsMin, boundsMax;
+		};
+
+		vector<unique_ptr<Batch>> batches;
+		map<unsigned int, Batch*> owners;	// Member id -> the batch holding it.
+		unsigned int nextId;
+		WorkerPool& pool;
+
+		// Draw ranges, reused between frames.
+		vector<GLsizei> rangeCounts;
+		vector<const void*> rangeOffsets;
+		size_t drawCalls;
+
+		Batch* batchFor(GLuint program, const TextureRef& texture, const VertexLayout& layout);
+		void rebuild(Batch& batch);
+		void destroy(Batch& batch);
+
+	public:
+		// Constructor
+		StaticBatcher(WorkerPool& pool = WorkerPool::shared());
+		~StaticBatcher();
+
+		StaticBatcher(const StaticBatcher&) = delete;
+		StaticBatcher& operator=(const StaticBatcher&) = delete;
+
+		// Functions
+		// Returns an id for remove(), or 0 if the geometry can't be batched (it needs a float3 position at location 0).
+		unsigned int add(GLuint program, const TextureRef& texture, const VertexLayout& layout, const void* vertexData, size_t vertexCount,
+			const vector<unsigned int>& indices, const glm::mat4& transform = glm::mat4(1.0f));
+
+		// Batch an object's geometry with its program and texture. The object doesn't keep a CPU copy of its
+		//		vertices, so they are passed again here.
+		template<typename Vertex>
+		unsigned int add(const RenderableObject& object, const vector<Vertex>& vertices, const vector<unsigned int>& indices, const glm::mat4& transform = glm::mat4(1.0f)) {
+			return add(object.shaderProgram(), object.texture(), VertexLayout::of<Vertex>(), vertices.data(), vertices.size(), indices, transform);
+		}
+
+		bool remove(unsigned int id);
+
+		// Rebuild any batch whose membership changed, then draw every batch that touches the frustum.
+		//		Pass nullptr to skip culling.
+		void draw(const Frustum* frustum = nullptr);
+
+		size_t batchCount() const { return batches.size(); }
+		size_t drawCallsLastFrame() const { return drawCalls; }
+
+		// Transform 'count' float3 positions (or directions, with w = 0) laid out 'stride' bytes apart, in place.
+		static void transformPoints(const glm::mat4& matrix, unsigned char* data, size_t stride, size_t count, float w = 1.0f);
+};
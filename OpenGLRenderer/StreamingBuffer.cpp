@@ -0,0 +1,157 @@
+#include "StreamingBuffer.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <iostream>
+
+StreamingBuffer::StreamingBuffer(size_t bytesPerFrame, unsigned int framesInFlight) {
+	regionSize = max<size_t>(bytesPerFrame, 256);
+	regionCount = max(1u, framesInFlight);
+	region = 0;
+	head = 0;
+	committed = 0;
+	orphaned = false;
+	stalls = 0;
+	buffer = 0;
+	mapping = nullptr;
+	create();
+}
+
+StreamingBuffer::~StreamingBuffer() {
+	destroy();
+}
+
+void StreamingBuffer::create() {
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+	// Written by the CPU only, kept mapped for the buffer's whole life. Coherent, so no flushes are needed.
+	persistent = false;
+	if (GLExtensions::bufferStorage) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, regionSize * regionCount, NULL, flags);
+		mapping = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, regionSize * regionCount, flags);
+		persistent = mapping != nullptr;
+
+		// Immutable storage can't be respecified, so a failed map needs a fresh buffer for the fallback.
+		if (!persistent) {
+			cout << "ERROR::STREAMING_BUFFER::PERSISTENT_MAP_FAILED" << endl;
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			glDeleteBuffers(1, &buffer);
+			glGenBuffers(1, &buffer);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		}
+	}
+
+	if (!persistent) {
+		glBufferData(GL_COPY_WRITE_BUFFER, regionSize, NULL, GL_STREAM_DRAW);
+		staging.resize(regionSize);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	fences.assign(persistent ? regionCount : 0, nullptr);
+}
+
+void StreamingBuffer::destroy() {
+	for (unsigned int i = 0; i < fences.size(); i++)
+		wait(i);
+
+	if (mapping) {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		mapping = nullptr;
+	}
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+void StreamingBuffer::wait(unsigned int index) {
+	if (!fences[index])
+		return;
+
+	// The first wait flushes, so the fence is guaranteed to be submitted and the loop can't spin forever.
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true) {
+		GLenum result = glClientWaitSync(fences[index], flags, 1000000);	// 1 ms
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+			break;
+		flags = 0;
+	}
+	glDeleteSync(fences[index]);
+	fences[index] = nullptr;
+}
+
+// ---
+// Frames
+// ---
+void StreamingBuffer::beginFrame() {
+	head = 0;
+	committed = 0;
+	orphaned = false;
+	if (!persistent)
+		return;
+
+	region = (region + 1) % regionCount;
+	if (fences[region]) {
+		if (glClientWaitSync(fences[region], 0, 0) == GL_TIMEOUT_EXPIRED)
+			stalls++;
+		wait(region);
+	}
+}
+
+StreamAllocation StreamingBuffer::allocate(size_t bytes, size_t alignment) {
+	StreamAllocation allocation;
+	alignment = max<size_t>(alignment, 1);
+	size_t start = (head + alignment - 1) / alignment * alignment;
+	if (start + bytes > regionSize)
+		return allocation;
+
+	head = start + bytes;
+	allocation.size = bytes;
+	if (persistent) {
+		allocation.offset = region * regionSize + start;
+		allocation.data = mapping + allocation.offset;
+	}
+	else {
+		allocation.offset = start;
+		allocation.data = staging.data() + start;
+	}
+	return allocation;
+}
+
+void StreamingBuffer::commit() {
+	if (persistent || committed >= head)
+		return;
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	if (!orphaned) {
+		glBufferData(GL_COPY_WRITE_BUFFER, regionSize, NULL, GL_STREAM_DRAW);
+		orphaned = true;
+	}
+	glBufferSubData(GL_COPY_WRITE_BUFFER, committed, head - committed, staging.data() + committed);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	committed = head;
+}
+
+void StreamingBuffer::endFrame() {
+	commit();
+	if (!persistent)
+		return;
+
+	if (fences[region])
+		glDeleteSync(fences[region]);
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamingBuffer::reserve(size_t bytesPerFrame) {
+	if (bytesPerFrame <= regionSize)
+		return;
+
+	destroy();
+	regionSize = max(bytesPerFrame, regionSize * 2);
+	region = 0;
+	head = 0;
+	committed = 0;
+	create();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// Local Library Includes
+#include "GLExtensions.h"
+
+// Standard Library Includes
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// Space handed out for this frame's data: write through 'data', point GL at 'offset' in the buffer.
+struct StreamAllocation {
+	void* data = nullptr;
+	size_t offset = 0;
+	size_t size = 0;
+
+	bool valid() const { return data != nullptr; }
+};
+
+// A ring buffer for data that changes every frame: dynamic geometry, draw commands, per-draw constants.
+//
+//		With ARB_buffer_storage the buffer is allocated once, immutable, and mapped for good with
+//		GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT. It is split into one region per frame in flight. Each frame
+//		writes only its own region, straight into the mapping (from any thread), and endFrame() puts a fence
+//		behind the frame's commands. When the ring comes back round, beginFrame() waits on that fence before the
+//		region is reused. The CPU never writes memory the GPU may still be reading, and no GL call blocks on it.
+//
+//		Older drivers get the classic fallback: writes go to a CPU staging copy, and the first commit() of a frame
+//		orphans the buffer with glBufferData(NULL) before uploading. The driver hands over fresh storage instead of
+//		waiting for the GPU to finish with the old one.
+//
+//		Frame protocol: beginFrame(), allocate() and write, commit() before the draws that read it, endFrame() after them.
+class StreamingBuffer {
+
+	private:
+		GLuint buffer;
+		size_t regionSize;
+		unsigned int regionCount;
+		unsigned int region;
+		size_t head;			// Bytes allocated in the current region.
+		size_t committed;		// Fallback: bytes already uploaded this frame.
+		bool persistent;
+		bool orphaned;
+		unsigned char* mapping;
+		vector<GLsync> fences;
+		vector<unsigned char> staging;
+		size_t stalls;
+
+		void create();
+		void destroy();
+		void wait(unsigned int index);
+
+	public:
+		// Constructor
+		StreamingBuffer(size_t bytesPerFrame, unsigned int framesInFlight = 3);
+		~StreamingBuffer();
+
+		StreamingBuffer(const StreamingBuffer&) = delete;
+		StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+		// Functions
+		void beginFrame();
+
+		// Invalid if the frame's region is full; reserve() more before the next frame.
+		StreamAllocation allocate(size_t bytes, size_t alignment = 16);
+
+		// Make everything allocated so far visible to GL. Only the fallback has work to do.
+		void commit();
+
+		void endFrame();
+
+		// Grow every region to at least bytesPerFrame. Waits for the GPU to finish with the old buffer,
+		//		so call it between endFrame() and beginFrame(), and rarely.
+		void reserve(size_t bytesPerFrame);
+
+		GLuint id() const { return buffer; }
+		bool isPersistent() const { return persistent; }
+		size_t bytesPerFrame() const { return regionSize; }
+		unsigned int framesInFlight() const { return regionCount; }
+		size_t bytesUsed() const { return head; }
+
+		// Times beginFrame() had to wait for the GPU. Rising counts mean more frames in flight would help.
+		size_t stallCount() const { return stalls; }
+};
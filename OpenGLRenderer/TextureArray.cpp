@@ -0,0 +1,97 @@
+#include "TextureArray.h"
+
+// Local Library Includes
+#include "TextureLoader.h"
+
+// Standard Library Includes
+#include <algorithm>
+
+// ---
+// TextureArray
+// ---
+TextureArray::TextureArray(int width, int height, int channels, int capacity) {
+	this->width = width;
+	this->height = height;
+	this->channels = channels;
+	this->capacity = capacity;
+	layerCount = 0;
+
+	levels = 1;
+	while ((width >> levels) > 0 || (height >> levels) > 0)
+		levels++;
+
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+	// Reserve every level for every layer up front; layers are filled in with glTexSubImage3D.
+	for (int level = 0; level < levels; level++) {
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, MipmapGenerator::internalFormat(channels),
+			max(1, width >> level), max(1, height >> level), capacity, 0,
+			MipmapGenerator::pixelFormat(channels), GL_UNSIGNED_BYTE, NULL);
+	}
+}
+
+TextureArray::~TextureArray() {
+	glDeleteTextures(1, &texture);
+	for (TextureCharge& charge : charges)
+		charge.release();
+}
+
+int TextureArray::addLayer(const MipChain& chain, const TextureCharge& charge) {
+	if (isFull() || chain.levels.empty() || chain.channels != channels ||
+		chain.levels[0].width != width || chain.levels[0].height != height)
+		return -1;
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	int uploadLevels = min(levels, (int)chain.levels.size());
+	for (int level = 0; level < uploadLevels; level++) {
+		const MipLevel& mip = chain.levels[level];
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layerCount, mip.width, mip.height, 1,
+			MipmapGenerator::pixelFormat(channels), GL_UNSIGNED_BYTE, mip.pixels.data());
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	charges.push_back(charge);
+	return layerCount++;
+}
+
+// ---
+// TextureArrayPool
+// ---
+TextureArrayPool::TextureArrayPool(int layersPerArray) {
+	this->layersPerArray = layersPerArray;
+}
+
+TextureRef TextureArrayPool::add(const char* texPath) {
+	TextureCharge charge;
+	MipChain chain = TextureLoader::loadMipChain(texPath, TextureCategory::Default, &charge);
+	return add(chain, charge);
+}
+
+TextureRef TextureArrayPool::add(const MipChain& chain, TextureCharge charge) {
+	TextureRef ref;
+	if (chain.levels.empty())
+		return ref;
+
+	const MipLevel& base = chain.levels[0];
+	vector<unique_ptr<TextureArray>>& arrays = buckets[BucketKey(base.width, base.height, chain.channels)];
+
+	// Only the newest array in a bucket can have free layers.
+	if (arrays.empty() || arrays.back()->isFull())
+		arrays.emplace_back(new TextureArray(base.width, base.height, chain.channels, layersPerArray));
+
+	ref.kind = TextureKind::Array;
+	ref.texture = arrays.back()->id();
+	ref.index = arrays.back()->addLayer(chain, charge);
+	if (ref.index < 0)
+		charge.release();
+	return ref;
+}
@@ -0,0 +1,14 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 vertexColor;
+in vec2 TexCoord;
+
+// Same-sized textures share one array; each object picks its layer.
+uniform sampler2DArray texture1;
+uniform int textureLayer;
+
+void main()
+{
+	FragColor = texture(texture1, vec3(TexCoord, textureLayer)) * vec4(vertexColor, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// Local Library Includes
+#include "MipmapGenerator.h"
+#include "TextureBudget.h"
+#include "TextureRef.h"
+
+// Standard Library Includes
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+// A GL_TEXTURE_2D_ARRAY holding same-sized images as layers.
+//		Objects using any layer bind the same texture, so consecutive draws never rebind.
+class TextureArray {
+
+	private:
+		unsigned int texture;
+		int width, height, channels;
+		int capacity;
+		int levels;
+		int layerCount;
+		vector<TextureCharge> charges;	// Budget charges of the layers, given back when the array is deleted.
+
+	public:
+		// Constructor
+		TextureArray(int width, int height, int channels, int capacity);
+		~TextureArray();
+
+		TextureArray(const TextureArray&) = delete;
+		TextureArray& operator=(const TextureArray&) = delete;
+
+		// Functions
+		// Returns the new layer, or -1 if the array is full or the image doesn't match.
+		//		The array takes over the chain's budget charge only when the layer is added.
+		int addLayer(const MipChain& chain, const TextureCharge& charge = TextureCharge());
+		bool isFull() const { return layerCount >= capacity; }
+		unsigned int id() const { return texture; }
+};
+
+// Buckets textures by size and format so each bucket shares one TextureArray.
+class TextureArrayPool {
+
+	private:
+		typedef tuple<int, int, int> BucketKey; // width, height, channels
+		map<BucketKey, vector<unique_ptr<TextureArray>>> buckets;
+		int layersPerArray;
+
+	public:
+		// Constructor
+		TextureArrayPool(int layersPerArray = 64);
+
+		// Functions
+		// Load, mip and place an image. Returns a Single reference to nothing if the load failed.
+		TextureRef add(const char* texPath);
+		TextureRef add(const MipChain& chain, TextureCharge charge = TextureCharge());
+};
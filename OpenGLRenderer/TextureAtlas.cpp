@@ -0,0 +1,373 @@
+#include "TextureAtlas.h"
+
+// Local Library Includes
+#include "ImageDecoder.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <iostream>
+
+namespace {
+	const char ATLAS_MAGIC[4] = { 'A', 'T', 'L', 'S' };
+	const unsigned int ATLAS_VERSION = 1;
+	const unsigned int MAX_PAGE_SIZE = 16384;	// Larger than any GL_MAX_TEXTURE_SIZE in practice.
+
+	int alignUp(int value, int alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// Write one texel of any 1-4 channel layout as another, going through RGBA: grey spreads across RGB,
+	//		a missing alpha is opaque, and 1 or 2 channel pages keep grey (or red) and alpha.
+	void convertTexel(const unsigned char* src, int srcChannels, unsigned char* dst, int dstChannels) {
+		unsigned char rgba[4];
+		if (srcChannels <= 2) {
+			rgba[0] = rgba[1] = rgba[2] = src[0];
+			rgba[3] = srcChannels == 2 ? src[1] : 255;
+		}
+		else {
+			rgba[0] = src[0];
+			rgba[1] = src[1];
+			rgba[2] = src[2];
+			rgba[3] = srcChannels == 4 ? src[3] : 255;
+		}
+
+		if (dstChannels <= 2) {
+			dst[0] = rgba[0];
+			if (dstChannels == 2)
+				dst[1] = rgba[3];
+		}
+		else {
+			for (int c = 0; c < dstChannels; c++)
+				dst[c] = rgba[c];
+		}
+	}
+}
+
+TextureAtlas::TextureAtlas(int pageSize, int channels, int mipLevels) {
+	this->pageSize = pageSize;
+	this->channels = channels;
+	this->mipLevels = max(1, mipLevels);
+	gutter = 1 << (this->mipLevels - 1);
+}
+
+TextureAtlas::~TextureAtlas() {
+	for (Page& page : pages) {
+		if (page.texture)
+			glDeleteTextures(1, &page.texture);
+	}
+}
+
+// ---
+// Packing
+// ---
+bool TextureAtlas::add(const string& name, const unsigned char* pixels, int width, int height, int srcChannels) {
+	if (srcChannels < 1 || srcChannels > 4 || width <= 0 || height <= 0) {
+		cout << "ERROR::ATLAS::UNSUPPORTED_IMAGE " << name << endl;
+		return false;
+	}
+
+	// The slot holds the image plus a gutter on every side, rounded up so it starts and ends on a mip boundary.
+	int slotWidth = alignUp(width + gutter * 2, gutter);
+	int slotHeight = alignUp(height + gutter * 2, gutter);
+
+	if (slotWidth > pageSize || slotHeight > pageSize) {
+		cout << "ERROR::ATLAS::IMAGE_TOO_LARGE " << name << endl;
+		return false;
+	}
+
+	Rect slot;
+	int pageIndex = -1;
+
+	for (size_t i = 0; i < pages.size(); i++) {
+		if (placeInPage(pages[i], slotWidth, slotHeight, slot)) {
+			pageIndex = (int)i;
+			break;
+		}
+	}
+
+	// Nothing fits in the existing pages, so start a new one.
+	if (pageIndex < 0) {
+		Page page;
+		page.pixels.assign((size_t)pageSize * pageSize * channels, 0);
+		page.freeRects.push_back({ 0, 0, pageSize, pageSize });
+		pages.push_back(std::move(page));
+
+		pageIndex = (int)pages.size() - 1;
+		placeInPage(pages[pageIndex], slotWidth, slotHeight, slot);
+	}
+
+	blit(pages[pageIndex], slot, pixels, width, height, srcChannels);
+
+	AtlasRegion region;
+	region.page = pageIndex;
+	region.x = slot.x + gutter;
+	region.y = slot.y + gutter;
+	region.width = width;
+	region.height = height;
+	region.uvOffset = glm::vec2((float)region.x / pageSize, (float)region.y / pageSize);
+	region.uvScale = glm::vec2((float)width / pageSize, (float)height / pageSize);
+	regions[name] = region;
+	return true;
+}
+
+bool TextureAtlas::addFile(const string& name, const char* texPath) {
+	DecodedImage image = ImageDecoder::decodeFile(texPath, channels);
+	if (!image.valid())
+		return false;
+
+	return add(name, image.pixels.data(), image.width, image.height, image.channels);
+}
+
+const AtlasRegion* TextureAtlas::find(const string& name) const {
+	auto it = regions.find(name);
+	return (it == regions.end()) ? nullptr : &it->second;
+}
+
+// MaxRects, best short side fit: choose the free rectangle that leaves the smallest leftover on its tighter side.
+bool TextureAtlas::placeInPage(Page& page, int width, int height, Rect& result) {
+	int bestShortSide = INT_MAX;
+	int bestLongSide = INT_MAX;
+	bool found = false;
+
+	for (const Rect& free : page.freeRects) {
+		if (free.width < width || free.height < height)
+			continue;
+
+		int leftoverX = free.width - width;
+		int leftoverY = free.height - height;
+		int shortSide = min(leftoverX, leftoverY);
+		int longSide = max(leftoverX, leftoverY);
+
+		if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide)) {
+			result = { free.x, free.y, width, height };
+			bestShortSide = shortSide;
+			bestLongSide = longSide;
+			found = true;
+		}
+	}
+
+	if (found) {
+		splitFreeRects(page, result);
+		pruneFreeRects(page);
+	}
+	return found;
+}
+
+// Every free rectangle overlapping the new slot is replaced by up to four maximal pieces around it.
+void TextureAtlas::splitFreeRects(Page& page, const Rect& used) {
+	vector<Rect> result;
+
+	for (const Rect& free : page.freeRects) {
+		bool overlaps = used.x < free.x + free.width && used.x + used.width > free.x &&
+						used.y < free.y + free.height && used.y + used.height > free.y;
+
+		if (!overlaps) {
+			result.push_back(free);
+			continue;
+		}
+
+		if (used.x > free.x)
+			result.push_back({ free.x, free.y, used.x - free.x, free.height });
+		if (used.x + used.width < free.x + free.width)
+			result.push_back({ used.x + used.width, free.y, free.x + free.width - (used.x + used.width), free.height });
+		if (used.y > free.y)
+			result.push_back({ free.x, free.y, free.width, used.y - free.y });
+		if (used.y + used.height < free.y + free.height)
+			result.push_back({ free.x, used.y + used.height, free.width, free.y + free.height - (used.y + used.height) });
+	}
+
+	page.freeRects.swap(result);
+}
+
+// Drop free rectangles fully contained by another one; they can never give a better fit.
+void TextureAtlas::pruneFreeRects(Page& page) {
+	vector<Rect>& rects = page.freeRects;
+
+	for (size_t i = 0; i < rects.size(); i++) {
+		for (size_t j = i + 1; j < rects.size(); j++) {
+			const Rect& a = rects[i];
+			const Rect& b = rects[j];
+
+			if (a.x >= b.x && a.y >= b.y && a.x + a.width <= b.x + b.width && a.y + a.height <= b.y + b.height) {
+				rects.erase(rects.begin() + i);
+				i--;
+				break;
+			}
+			if (b.x >= a.x && b.y >= a.y && b.x + b.width <= a.x + a.width && b.y + b.height <= a.y + a.height) {
+				rects.erase(rects.begin() + j);
+				j--;
+			}
+		}
+	}
+}
+
+// Copy the image into its slot, extruding the edge texels out through the gutter.
+//		Filtering at the region's border then picks up its own colours instead of the neighbour's.
+void TextureAtlas::blit(Page& page, const Rect& slot, const unsigned char* pixels, int width, int height, int srcChannels) {
+	for (int sy = 0; sy < slot.height; sy++) {
+		int y = min(max(sy - gutter, 0), height - 1);
+		unsigned char* dstRow = &page.pixels[((size_t)(slot.y + sy) * pageSize + slot.x) * channels];
+
+		for (int sx = 0; sx < slot.width; sx++) {
+			int x = min(max(sx - gutter, 0), width - 1);
+			const unsigned char* src = pixels + ((size_t)y * width + x) * srcChannels;
+			unsigned char* dst = dstRow + (size_t)sx * channels;
+
+			convertTexel(src, srcChannels, dst, channels);
+		}
+	}
+}
+
+// ---
+// GPU pages
+// ---
+void TextureAtlas::build() {
+	// Box filtering keeps each aligned block inside its own slot for every level we generate.
+	MipSettings settings;
+	settings.filter = MipFilter::Box;
+	settings.wrap = false;
+	settings.maxLevels = mipLevels;
+
+	for (Page& page : pages) {
+		if (!page.texture)
+			glGenTextures(1, &page.texture);
+
+		glBindTexture(GL_TEXTURE_2D, page.texture);
+
+		// Pages never repeat; wrapping is meaningless once several images share the texture.
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		MipChain chain = MipmapGenerator::generate(page.pixels.data(), pageSize, pageSize, channels, settings);
+		MipmapGenerator::upload(GL_TEXTURE_2D, chain);
+	}
+}
+
+unsigned int TextureAtlas::pageTexture(int page) const {
+	return (page >= 0 && page < (int)pages.size()) ? pages[page].texture : 0;
+}
+
+void TextureAtlas::remapUVs(vector<float>& vertices, int stride, int uvOffset, const AtlasRegion& region) {
+	for (size_t i = uvOffset; i + 1 < vertices.size(); i += stride) {
+		vertices[i] = region.uvOffset.x + vertices[i] * region.uvScale.x;
+		vertices[i + 1] = region.uvOffset.y + vertices[i + 1] * region.uvScale.y;
+	}
+}
+
+// ---
+// Offline cooking
+// ---
+bool TextureAtlas::save(const char* atlasPath) const {
+	ofstream file(atlasPath, ios::binary);
+	if (!file) {
+		cout << "ERROR::ATLAS::FILE_NOT_SUCCESSFULLY_WRITTEN " << atlasPath << endl;
+		return false;
+	}
+
+	unsigned int header[] = { ATLAS_VERSION, (unsigned int)pageSize, (unsigned int)channels, (unsigned int)mipLevels, (unsigned int)pages.size(), (unsigned int)regions.size() };
+	file.write(ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+	file.write((const char*)header, sizeof(header));
+
+	for (const Page& page : pages)
+		file.write((const char*)page.pixels.data(), page.pixels.size());
+
+	for (const auto& entry : regions) {
+		const AtlasRegion& region = entry.second;
+		int values[] = { (int)entry.first.size(), region.page, region.x, region.y, region.width, region.height };
+		file.write((const char*)values, sizeof(values));
+		file.write(entry.first.data(), entry.first.size());
+	}
+
+	return (bool)file;
+}
+
+bool TextureAtlas::load(const char* atlasPath) {
+	ifstream file(atlasPath, ios::binary);
+	char magic[4];
+	unsigned int header[6];
+
+	if (!file.read(magic, sizeof(magic)) || !equal(magic, magic + 4, ATLAS_MAGIC) ||
+		!file.read((char*)header, sizeof(header)) || header[0] != ATLAS_VERSION) {
+		cout << "ERROR::ATLAS::FILE_NOT_SUCCESSFULLY_READ " << atlasPath << endl;
+		return false;
+	}
+
+	// Everything that sizes an allocation or a shift is checked against the file before it is used,
+	//		and the atlas is only replaced once the whole file has read back correctly.
+	streamoff headerEnd = file.tellg();
+	file.seekg(0, ios::end);
+	unsigned long long remaining = (unsigned long long)(file.tellg() - headerEnd);
+	file.seekg(headerEnd);
+
+	int newPageSize = (int)header[1];
+	int newChannels = (int)header[2];
+	int newMipLevels = (int)header[3];
+	unsigned long long pageBytes = (unsigned long long)header[1] * header[1] * header[2];
+	if (header[1] == 0 || header[1] > MAX_PAGE_SIZE || header[2] == 0 || header[2] > 4 ||
+		header[3] == 0 || header[3] > 15 || (header[1] >> (header[3] - 1)) == 0 || pageBytes * header[4] > remaining) {
+		cout << "ERROR::ATLAS::INVALID_HEADER " << atlasPath << endl;
+		return false;
+	}
+
+	vector<Page> newPages(header[4]);
+	for (Page& page : newPages) {
+		page.pixels.resize((size_t)pageBytes);
+		file.read((char*)page.pixels.data(), page.pixels.size());
+	}
+	remaining -= pageBytes * header[4];
+
+	map<string, AtlasRegion> newRegions;
+	for (unsigned int i = 0; i < header[5]; i++) {
+		int values[6];
+		if (!file.read((char*)values, sizeof(values)))
+			break;
+		remaining -= sizeof(values);
+
+		int nameLength = values[0];
+		AtlasRegion region;
+		region.page = values[1];
+		region.x = values[2];
+		region.y = values[3];
+		region.width = values[4];
+		region.height = values[5];
+		if (nameLength < 0 || (unsigned long long)nameLength > remaining || region.page < 0 || region.page >= (int)newPages.size() ||
+			region.x < 0 || region.y < 0 || region.width <= 0 || region.height <= 0 ||
+			region.width > newPageSize - region.x || region.height > newPageSize - region.y) {
+			cout << "ERROR::ATLAS::INVALID_REGION " << i << " in " << atlasPath << endl;
+			return false;
+		}
+
+		string name(nameLength, '\0');
+		file.read(&name[0], nameLength);
+		remaining -= nameLength;
+
+		region.uvOffset = glm::vec2((float)region.x / newPageSize, (float)region.y / newPageSize);
+		region.uvScale = glm::vec2((float)region.width / newPageSize, (float)region.height / newPageSize);
+		newRegions[name] = region;
+	}
+
+	if (!file) {
+		cout << "ERROR::ATLAS::FILE_NOT_SUCCESSFULLY_READ " << atlasPath << endl;
+		return false;
+	}
+
+	// Textures built for the old pages would be lost with them.
+	for (Page& page : pages) {
+		if (page.texture)
+			glDeleteTextures(1, &page.texture);
+	}
+
+	pageSize = newPageSize;
+	channels = newChannels;
+	mipLevels = newMipLevels;
+	gutter = 1 << (mipLevels - 1);
+	pages.swap(newPages);
+	regions.swap(newRegions);
+
+	// Loaded pages are full; further adds go to new pages.
+	return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Local Library Includes
+#include "MipmapGenerator.h"
+
+// Standard Library Includes
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Where a packed image ended up, plus the transform that takes its 0..1 UVs into page UVs.
+struct AtlasRegion {
+	int page;
+	int x, y;			// Bottom-left texel of the image inside the page, excluding the gutter.
+	int width, height;
+	glm::vec2 uvOffset;
+	glm::vec2 uvScale;
+};
+
+// Packs many small images into a few shared pages so objects using them can draw without rebinding textures.
+//		Images are placed with MaxRects (best short side fit). Every rectangle is aligned to, and padded by,
+//		2^(mipLevels - 1) texels, so a box-filtered mip chain never blends neighbouring images together.
+//		The same class works at runtime (add, then build) and offline (add, save, then load in the app).
+class TextureAtlas {
+
+	private:
+		struct Rect {
+			int x, y, width, height;
+		};
+
+		struct Page {
+			vector<unsigned char> pixels;
+			vector<Rect> freeRects;
+			unsigned int texture = 0;
+		};
+
+		int pageSize;
+		int channels;
+		int mipLevels;
+		int gutter;
+		vector<Page> pages;
+		map<string, AtlasRegion> regions;
+
+		bool placeInPage(Page& page, int width, int height, Rect& result);
+		void splitFreeRects(Page& page, const Rect& used);
+		void pruneFreeRects(Page& page);
+		void blit(Page& page, const Rect& slot, const unsigned char* pixels, int width, int height, int srcChannels);
+
+	public:
+		// Constructor
+		TextureAtlas(int pageSize = 2048, int channels = 4, int mipLevels = 5);
+		~TextureAtlas();
+
+		TextureAtlas(const TextureAtlas&) = delete;
+		TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+		// Functions
+		bool add(const string& name, const unsigned char* pixels, int width, int height, int srcChannels);
+		bool addFile(const string& name, const char* texPath);
+		const AtlasRegion* find(const string& name) const;
+
+		// Generate mips for every page and upload them. Call once all images are added.
+		void build();
+		unsigned int pageTexture(int page) const;
+		int pageCount() const { return (int)pages.size(); }
+
+		// Rewrite the UVs of an interleaved vertex array so they address the region inside its page.
+		//		'stride' and 'uvOffset' are counted in floats.
+		static void remapUVs(vector<float>& vertices, int stride, int uvOffset, const AtlasRegion& region);
+
+		// Offline cooking: store packed pages and regions so the runtime skips packing entirely.
+		bool save(const char* atlasPath) const;
+		bool load(const char* atlasPath);
+};
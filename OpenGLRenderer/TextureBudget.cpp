@@ -0,0 +1,123 @@
+#include "TextureBudget.h"
+
+// Local Library Includes
+#include "GLExtensions.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <iostream>
+
+// Neither memory query extension is in our glad profile.
+#ifndef GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX 0x9047
+#endif
+#ifndef GL_TEXTURE_FREE_MEMORY_ATI
+#define GL_TEXTURE_FREE_MEMORY_ATI 0x87FC
+#endif
+
+TextureBudget::TextureBudget(size_t budgetBytes, int minDimension) {
+	this->budgetBytes = budgetBytes;
+	this->minDimension = max(1, minDimension);
+	usedBytes = 0;
+}
+
+void TextureBudget::setBudget(size_t bytes) {
+	lock_guard<mutex> lock(budgetMutex);
+	budgetBytes = bytes;
+}
+
+void TextureBudget::setCategoryCap(TextureCategory category, const TextureCategoryCap& cap) {
+	lock_guard<mutex> lock(budgetMutex);
+	categories[(int)category].cap = cap;
+}
+
+int TextureBudget::maxDimension(TextureCategory category) const {
+	lock_guard<mutex> lock(budgetMutex);
+	return categories[(int)category].cap.maxDimension;
+}
+
+int TextureBudget::fit(TextureCategory category, MipChain& chain) {
+	if (chain.levels.empty())
+		return 0;
+
+	lock_guard<mutex> lock(budgetMutex);
+	CategoryState& state = categories[(int)category];
+
+	// Bytes held by levels [first, end), built from the bottom up so each candidate top level is O(1).
+	size_t levelCount = chain.levels.size();
+	vector<size_t> tailBytes(levelCount + 1, 0);
+	for (size_t i = levelCount; i-- > 0;)
+		tailBytes[i] = tailBytes[i + 1] + chain.levels[i].pixels.size();
+
+	size_t first = 0;
+	while (first + 1 < levelCount) {
+		const MipLevel& top = chain.levels[first];
+		const MipLevel& next = chain.levels[first + 1];
+		size_t bytes = tailBytes[first];
+
+		bool overDimension = state.cap.maxDimension > 0 && max(top.width, top.height) > state.cap.maxDimension;
+		bool overCategory = state.cap.maxBytes > 0 && state.usedBytes + bytes > state.cap.maxBytes;
+		bool overBudget = budgetBytes > 0 && usedBytes + bytes > budgetBytes;
+
+		if (!overDimension && !overCategory && !overBudget)
+			break;
+
+		// Memory pressure alone never shrinks a texture below the floor; an explicit dimension cap can.
+		if (!overDimension && max(next.width, next.height) < minDimension)
+			break;
+
+		first++;
+	}
+
+	if (first > 0)
+		chain.levels.erase(chain.levels.begin(), chain.levels.begin() + first);
+
+	size_t charged = tailBytes[first];
+	if (budgetBytes > 0 && usedBytes + charged > budgetBytes)
+		cout << "ERROR::TEXTURE_BUDGET::EXCEEDED at minimum size, " << (usedBytes + charged) / (1024 * 1024) << " MB of " << budgetBytes / (1024 * 1024) << " MB" << endl;
+
+	state.usedBytes += charged;
+	usedBytes += charged;
+	return (int)first;
+}
+
+void TextureBudget::release(TextureCategory category, size_t bytes) {
+	lock_guard<mutex> lock(budgetMutex);
+	CategoryState& state = categories[(int)category];
+	state.usedBytes -= min(state.usedBytes, bytes);
+	usedBytes -= min(usedBytes, bytes);
+}
+
+void TextureCharge::release() {
+	if (budget && bytes > 0)
+		budget->release(category, bytes);
+	bytes = 0;
+}
+
+size_t TextureBudget::used() const {
+	lock_guard<mutex> lock(budgetMutex);
+	return usedBytes;
+}
+
+size_t TextureBudget::budget() const {
+	lock_guard<mutex> lock(budgetMutex);
+	return budgetBytes;
+}
+
+size_t TextureBudget::detectVideoMemory() {
+	// Both queries report kilobytes.
+	if (GLExtensions::hasExtension("GL_NVX_gpu_memory_info")) {
+		GLint kilobytes = 0;
+		glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &kilobytes);
+		return (size_t)kilobytes * 1024;
+	}
+
+	// ATI only exposes what's free right now; at startup that's close enough to the total.
+	if (GLExtensions::hasExtension("GL_ATI_meminfo")) {
+		GLint info[4] = {};
+		glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, info);
+		return (size_t)info[0] * 1024;
+	}
+
+	return 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+// Local Library Includes
+#include "MipmapGenerator.h"
+
+// Standard Library Includes
+#include <cstddef>
+#include <mutex>
+
+using namespace std;
+
+// What a texture is used for. Each category gets its own resolution and memory caps,
+//		so e.g. UI art can stay sharp while world detail textures give way first.
+enum class TextureCategory {
+	Default,
+	Color,
+	Normal,
+	Detail,
+	Interface,
+	Count
+};
+
+struct TextureCategoryCap {
+	int maxDimension = 0;	// Longest side after loading. Larger images are resampled down to fit. 0 for no cap.
+	size_t maxBytes = 0;	// Total bytes this category may hold. 0 for no cap.
+};
+
+// Decides at load time how much resolution each texture can afford.
+//
+//		Two mechanisms, cheapest first:
+//		- A category's maxDimension is applied to the decoded image before mips are built (see
+//		  TextureLoader), using the generator's filtered resize, so oversized source art never
+//		  costs a full-size mip pass.
+//		- When a finished chain would push its category or the global budget over, its top levels are
+//		  dropped until it fits, i.e. a lower pre-built mip becomes level 0. Nothing is resampled twice.
+//
+//		Textures keep at least minDimension on their longest side even when that overshoots the budget;
+//		a blurry texture is better than a missing one.
+class TextureBudget {
+
+	private:
+		struct CategoryState {
+			TextureCategoryCap cap;
+			size_t usedBytes = 0;
+		};
+
+		size_t budgetBytes;
+		size_t usedBytes;
+		int minDimension;
+		CategoryState categories[(int)TextureCategory::Count];
+		mutable mutex budgetMutex;
+
+	public:
+		// Constructor. A budget of 0 means unlimited.
+		TextureBudget(size_t budgetBytes = 0, int minDimension = 64);
+
+		// Functions
+		void setBudget(size_t bytes);
+		void setCategoryCap(TextureCategory category, const TextureCategoryCap& cap);
+		int maxDimension(TextureCategory category) const;
+
+		// Drop top levels from the chain until it fits, then charge what's left. Returns how many levels were dropped.
+		int fit(TextureCategory category, MipChain& chain);
+
+		// Give bytes back when a texture charged through fit() is deleted. Owners normally go through TextureCharge.
+		void release(TextureCategory category, size_t bytes);
+
+		size_t used() const;
+		size_t budget() const;
+
+		// Dedicated video memory reported by the driver (NVX_gpu_memory_info or ATI_meminfo), or 0 if unknown.
+		//		Needs a current context.
+		static size_t detectVideoMemory();
+};
+
+// What one load was charged, kept by whoever owns the texture and released when it deletes it.
+//		Without this the budget only ever fills up, and every later load gets downscaled.
+struct TextureCharge {
+	TextureBudget* budget = nullptr;
+	TextureCategory category = TextureCategory::Default;
+	size_t bytes = 0;
+
+	// Safe to call more than once; only the first call gives anything back.
+	void release();
+};
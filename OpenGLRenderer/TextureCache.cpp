@@ -0,0 +1,289 @@
+#include "TextureCache.h"
+
+// Local Library Includes
+#include "MappedFile.h"
+
+// Standard Library Includes
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+namespace {
+	const char CACHE_MAGIC[4] = { 'T', 'X', 'C', 'H' };
+	const unsigned int CACHE_VERSION = 1;
+
+	// Level data starts on this boundary so the mapped bytes are suitably aligned for any copy or upload.
+	const size_t DATA_ALIGNMENT = 16;
+
+	struct CacheHeader {
+		char magic[4];
+		uint32_t version;
+		uint64_t contentHash;
+		uint64_t settingsHash;
+		uint32_t channels;
+		uint32_t levelCount;
+	};
+
+	struct CacheLevel {
+		uint32_t width;
+		uint32_t height;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	size_t alignUp(size_t value) {
+		return (value + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+	}
+
+	bool readEntry(const string& path, uint64_t contentHash, uint64_t settingsHash, MipChain& chain) {
+		MappedFile file;
+		if (!file.open(path.c_str()) || file.size() < sizeof(CacheHeader))
+			return false;
+
+		CacheHeader header;
+		memcpy(&header, file.data(), sizeof(header));
+
+		if (memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION ||
+			header.contentHash != contentHash || header.settingsHash != settingsHash ||
+			sizeof(CacheHeader) + (size_t)header.levelCount * sizeof(CacheLevel) > file.size())
+			return false;
+
+		const unsigned char* levelTable = file.data() + sizeof(CacheHeader);
+		MipChain result;
+		result.channels = (int)header.channels;
+		result.levels.resize(header.levelCount);
+
+		for (uint32_t i = 0; i < header.levelCount; i++) {
+			CacheLevel level;
+			memcpy(&level, levelTable + i * sizeof(CacheLevel), sizeof(level));
+
+			// A truncated file (crash mid-write, full disk) is a miss, not a crash.
+			if (level.offset > file.size() || level.size > file.size() - level.offset ||
+				level.size != (uint64_t)level.width * level.height * header.channels)
+				return false;
+
+			MipLevel& dst = result.levels[i];
+			dst.width = (int)level.width;
+			dst.height = (int)level.height;
+			dst.pixels.assign(file.data() + level.offset, file.data() + level.offset + level.size);
+		}
+
+		chain = std::move(result);
+		return true;
+	}
+}
+
+TextureCache::TextureCache(const string& directory) {
+	this->directory = directory;
+
+#ifdef _WIN32
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+
+	loadIndex();
+}
+
+// ---
+// Lookup
+// ---
+bool TextureCache::find(const char* texPath, const MipSettings& settings, MipChain& chain) {
+	uint64_t size;
+	int64_t modified;
+	if (!statFile(texPath, size, modified))
+		return false;
+
+	uint64_t contentHash;
+	{
+		lock_guard<mutex> lock(indexMutex);
+		auto it = index.find(texPath);
+		if (it == index.end() || it->second.size != size || it->second.modified != modified)
+			return false;
+		contentHash = it->second.contentHash;
+	}
+
+	return readEntry(entryPath(contentHash, settings), contentHash, settingsHash(settings), chain);
+}
+
+bool TextureCache::find(const char* texPath, uint64_t contentHash, const MipSettings& settings, MipChain& chain) {
+	if (!readEntry(entryPath(contentHash, settings), contentHash, settingsHash(settings), chain))
+		return false;
+
+	// The file was touched (or copied) without its content changing; remember the new size/mtime.
+	uint64_t size;
+	int64_t modified;
+	if (statFile(texPath, size, modified))
+		recordIndex(texPath, { size, modified, contentHash });
+	return true;
+}
+
+void TextureCache::store(const char* texPath, uint64_t contentHash, const MipSettings& settings, const MipChain& chain) {
+	if (chain.levels.empty())
+		return;
+
+	CacheHeader header;
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.contentHash = contentHash;
+	header.settingsHash = settingsHash(settings);
+	header.channels = (uint32_t)chain.channels;
+	header.levelCount = (uint32_t)chain.levels.size();
+
+	vector<CacheLevel> levels(chain.levels.size());
+	size_t offset = alignUp(sizeof(CacheHeader) + levels.size() * sizeof(CacheLevel));
+	for (size_t i = 0; i < levels.size(); i++) {
+		levels[i].width = (uint32_t)chain.levels[i].width;
+		levels[i].height = (uint32_t)chain.levels[i].height;
+		levels[i].offset = offset;
+		levels[i].size = chain.levels[i].pixels.size();
+		offset = alignUp(offset + chain.levels[i].pixels.size());
+	}
+
+	// Write to a private temporary name and rename it into place, so a reader (or a second
+	//		process warming the same cache) never maps a half-written entry.
+	string finalPath = entryPath(contentHash, settings);
+	string tempPath = finalPath + "." + to_string(hash<thread::id>()(this_thread::get_id())) + ".tmp";
+	{
+		ofstream file(tempPath, ios::binary);
+		if (!file) {
+			cout << "ERROR::TEXTURE_CACHE::FILE_NOT_SUCCESSFULLY_WRITTEN " << tempPath << endl;
+			return;
+		}
+
+		const char padding[DATA_ALIGNMENT] = {};
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)levels.data(), levels.size() * sizeof(CacheLevel));
+
+		size_t written = sizeof(header) + levels.size() * sizeof(CacheLevel);
+		for (size_t i = 0; i < levels.size(); i++) {
+			file.write(padding, levels[i].offset - written);
+			file.write((const char*)chain.levels[i].pixels.data(), levels[i].size);
+			written = levels[i].offset + levels[i].size;
+		}
+
+		if (!file) {
+			file.close();
+			remove(tempPath.c_str());
+			cout << "ERROR::TEXTURE_CACHE::FILE_NOT_SUCCESSFULLY_WRITTEN " << tempPath << endl;
+			return;
+		}
+	}
+
+	// Windows won't rename over an existing file; whoever got there first wrote identical bytes.
+	if (rename(tempPath.c_str(), finalPath.c_str()) != 0)
+		remove(tempPath.c_str());
+
+	uint64_t size;
+	int64_t modified;
+	if (statFile(texPath, size, modified))
+		recordIndex(texPath, { size, modified, contentHash });
+}
+
+// ---
+// Index
+// ---
+// One line per path: "<content hash> <size> <mtime> <path>". The file is append-only while running,
+//		later lines win, and it is rewritten compactly at startup once it has gathered enough stale lines.
+void TextureCache::loadIndex() {
+	string indexPath = directory + "/index.txt";
+	ifstream file(indexPath);
+	string line;
+	size_t lineCount = 0;
+
+	while (getline(file, line)) {
+		istringstream fields(line);
+		IndexEntry entry;
+		string texPath;
+
+		fields >> hex >> entry.contentHash >> dec >> entry.size >> entry.modified;
+		fields.get();
+		getline(fields, texPath);
+
+		if (fields.fail() || texPath.empty())
+			continue;
+
+		index[texPath] = entry;
+		lineCount++;
+	}
+	file.close();
+
+	if (lineCount > index.size() * 2 + 64) {
+		ofstream compacted(indexPath, ios::trunc);
+		for (const auto& it : index)
+			compacted << hex << it.second.contentHash << dec << ' ' << it.second.size << ' ' << it.second.modified << ' ' << it.first << '\n';
+	}
+}
+
+void TextureCache::recordIndex(const string& texPath, const IndexEntry& entry) {
+	lock_guard<mutex> lock(indexMutex);
+
+	auto it = index.find(texPath);
+	if (it != index.end() && it->second.size == entry.size && it->second.modified == entry.modified && it->second.contentHash == entry.contentHash)
+		return;
+
+	index[texPath] = entry;
+
+	ofstream file(directory + "/index.txt", ios::app);
+	file << hex << entry.contentHash << dec << ' ' << entry.size << ' ' << entry.modified << ' ' << texPath << '\n';
+}
+
+string TextureCache::entryPath(uint64_t contentHash, const MipSettings& settings) const {
+	char name[40];
+	snprintf(name, sizeof(name), "/%016llx.tex", (unsigned long long)(contentHash ^ (settingsHash(settings) * 0x9E3779B97F4A7C15ull)));
+	return directory + name;
+}
+
+// ---
+// Helpers
+// ---
+bool TextureCache::statFile(const char* path, uint64_t& size, int64_t& modified) {
+#ifdef _WIN32
+	struct _stat64 info;
+	if (_stat64(path, &info) != 0)
+		return false;
+#else
+	struct stat info;
+	if (stat(path, &info) != 0)
+		return false;
+#endif
+
+	size = (uint64_t)info.st_size;
+	modified = (int64_t)info.st_mtime;
+	return true;
+}
+
+// Everything that changes the cached bytes goes into the key, along with the format version.
+uint64_t TextureCache::settingsHash(const MipSettings& settings) {
+	uint32_t values[] = {
+		CACHE_VERSION,
+		(uint32_t)settings.filter,
+		(uint32_t)settings.sRGB,
+		(uint32_t)settings.wrap,
+		(uint32_t)settings.preserveAlphaCoverage,
+		0,
+		(uint32_t)settings.maxLevels,
+		(uint32_t)settings.maxDimension
+	};
+	memcpy(&values[5], &settings.alphaCutoff, sizeof(float));
+	return hashBytes(values, sizeof(values));
+}
+
+uint64_t TextureCache::hashBytes(const void* data, size_t size, uint64_t seed) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	uint64_t hash = seed;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+// Local Library Includes
+#include "MipmapGenerator.h"
+
+// Standard Library Includes
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+// A directory of fully processed (decoded + mipped) textures, so warm starts skip decoding and mip generation.
+//
+//		Entries are named by a hash of the source file's bytes combined with the MipSettings used, so
+//		renamed or duplicated images share one entry and changing a setting never returns stale output.
+//		Hashing the source on every run would cost as much as reading it, so an index remembers the
+//		size and modification time each path had when it was hashed; if those still match, the lookup
+//		is a stat() plus a memory-mapped read of the cached levels.
+//
+//		Safe to use from several loader threads at once.
+class TextureCache {
+
+	private:
+		struct IndexEntry {
+			uint64_t size;
+			int64_t modified;
+			uint64_t contentHash;
+		};
+
+		string directory;
+		unordered_map<string, IndexEntry> index;
+		mutex indexMutex;
+
+		void loadIndex();
+		void recordIndex(const string& texPath, const IndexEntry& entry);
+		string entryPath(uint64_t contentHash, const MipSettings& settings) const;
+
+		static bool statFile(const char* path, uint64_t& size, int64_t& modified);
+		static uint64_t settingsHash(const MipSettings& settings);
+
+	public:
+		// Constructor. The directory is created if it doesn't exist.
+		TextureCache(const string& directory);
+
+		TextureCache(const TextureCache&) = delete;
+		TextureCache& operator=(const TextureCache&) = delete;
+
+		// Functions
+		// Fast lookup: only stats the source file. Misses when the file is new or has changed since it was indexed.
+		bool find(const char* texPath, const MipSettings& settings, MipChain& chain);
+
+		// Lookup by the hash of the source bytes, for when the fast path missed but the content may be unchanged.
+		//		A hit re-indexes the path so the next run takes the fast path.
+		bool find(const char* texPath, uint64_t contentHash, const MipSettings& settings, MipChain& chain);
+
+		void store(const char* texPath, uint64_t contentHash, const MipSettings& settings, const MipChain& chain);
+
+		// 64-bit FNV-1a.
+		static uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+};
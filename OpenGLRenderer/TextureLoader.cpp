@@ -0,0 +1,99 @@
+#include "TextureLoader.h"
+
+// Local Library Includes
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <iostream>
+
+TextureCache* TextureLoader::cache = nullptr;
+TextureBudget* TextureLoader::budget = nullptr;
+
+MipChain TextureLoader::loadMipChain(const char* texPath, const MipSettings& settings) {
+	MipChain chain;
+	if (cache && cache->find(texPath, settings, chain))
+		return chain;
+
+	MappedFile file;
+	if (!file.open(texPath)) {
+		std::cout << "Failed to load texture " << texPath << std::endl;
+		return MipChain();
+	}
+
+	// The file changed on disk (or was never indexed), but its bytes may still match a cached entry.
+	uint64_t contentHash = 0;
+	if (cache) {
+		contentHash = TextureCache::hashBytes(file.data(), file.size());
+		if (cache->find(texPath, contentHash, settings, chain))
+			return chain;
+	}
+
+	// Decoding flips the rows to account for conversion between 1.0y and 0.0y to prevent upside-down textures.
+	DecodedImage image = ImageDecoder::decodeMemory(file.data(), file.size());
+	if (!image.valid()) {
+		std::cout << "Failed to load texture " << texPath << std::endl;
+		return MipChain();
+	}
+
+	// Oversized sources are filtered straight down to the cap, so the full-size chain is never built.
+	int longest = max(image.width, image.height);
+	if (settings.maxDimension > 0 && longest > settings.maxDimension) {
+		int newWidth = max(1, (int)((long long)image.width * settings.maxDimension / longest));
+		int newHeight = max(1, (int)((long long)image.height * settings.maxDimension / longest));
+
+		MipLevel resized = MipmapGenerator::resize(image.pixels.data(), image.width, image.height, image.channels, newWidth, newHeight, settings);
+		chain = MipmapGenerator::generate(resized.pixels.data(), newWidth, newHeight, image.channels, settings);
+	}
+	else {
+		chain = MipmapGenerator::generate(image.pixels.data(), image.width, image.height, image.channels, settings);
+	}
+
+	if (cache)
+		cache->store(texPath, contentHash, settings, chain);
+	return chain;
+}
+
+MipChain TextureLoader::loadMipChain(const char* texPath, TextureCategory category, TextureCharge* charge, const MipSettings& settings) {
+	if (charge)
+		*charge = TextureCharge();
+	if (!budget)
+		return loadMipChain(texPath, settings);
+
+	// The tighter of the caller's and the category's dimension caps wins.
+	MipSettings capped = settings;
+	int categoryMax = budget->maxDimension(category);
+	if (categoryMax > 0 && (capped.maxDimension == 0 || categoryMax < capped.maxDimension))
+		capped.maxDimension = categoryMax;
+
+	MipChain chain = loadMipChain(texPath, capped);
+	if (budget->fit(category, chain) > 0)
+		std::cout << "Texture " << texPath << " reduced to " << chain.levels[0].width << "x" << chain.levels[0].height << " to fit the texture budget" << std::endl;
+
+	if (charge) {
+		charge->budget = budget;
+		charge->category = category;
+		charge->bytes = chain.byteSize();
+	}
+	return chain;
+}
+
+void TextureLoader::setCache(TextureCache* textureCache) {
+	cache = textureCache;
+}
+
+vector<MipChain> TextureLoader::loadMipChains(const vector<string>& texPaths, const MipSettings& settings, WorkerPool& pool) {
+	vector<MipChain> chains(texPaths.size());
+
+	// One file per job; the mip generation inside each job spreads its rows over the same pool.
+	pool.parallelFor(texPaths.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			chains[i] = loadMipChain(texPaths[i].c_str(), settings);
+	});
+	return chains;
+}
+
+void TextureLoader::setBudget(TextureBudget* textureBudget) {
+	budget = textureBudget;
+}
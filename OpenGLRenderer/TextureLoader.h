@@ -0,0 +1,43 @@
+#pragma once
+
+// Local Library Includes
+#include "MipmapGenerator.h"
+#include "TextureBudget.h"
+#include "TextureCache.h"
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// The one place image files turn into GPU-ready mip chains.
+//		Every texture path (RenderableObject, arrays, bindless) goes through here,
+//		so decoding and mip settings only need changing in one spot.
+class TextureLoader {
+
+	private:
+		static TextureCache* cache;
+		static TextureBudget* budget;
+
+	public:
+		// Functions
+		// Returns an empty chain (no levels) if the file couldn't be decoded.
+		static MipChain loadMipChain(const char* texPath, const MipSettings& settings = MipSettings());
+
+		// As above, but sized to fit the active TextureBudget for that category. Use this for textures that
+		//		stay resident; chains that are loaded again later (streaming) would be charged twice.
+		//		'charge' receives what was charged; release it when the texture is deleted.
+		static MipChain loadMipChain(const char* texPath, TextureCategory category, TextureCharge* charge = nullptr, const MipSettings& settings = MipSettings());
+
+		// Decode and mip many files at once across the worker pool. Failed files give empty chains.
+		static vector<MipChain> loadMipChains(const vector<string>& texPaths, const MipSettings& settings = MipSettings(), WorkerPool& pool = WorkerPool::shared());
+
+		// Route every load through an on-disk cache of finished mip chains. Pass nullptr to disable.
+		//		Set this once at startup, before any loads are in flight.
+		static void setCache(TextureCache* textureCache);
+
+		// Charge resident loads against a VRAM budget, dropping resolution when it runs out. Pass nullptr to disable.
+		static void setBudget(TextureBudget* textureBudget);
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+// How a RenderableObject reaches its texture at draw time.
+//		Single binds a GL_TEXTURE_2D, Array binds a shared GL_TEXTURE_2D_ARRAY and selects a layer,
+//		Bindless only sets an index into the resident handle table - no bind at all - and Virtual
+//		samples the VirtualTexture cache, which is bound once per frame rather than per object.
+enum class TextureKind {
+	Single,
+	Array,
+	Bindless,
+	Virtual
+};
+
+struct TextureRef {
+	TextureKind kind = TextureKind::Single;
+	unsigned int texture = 0;	// GL name of the 2D texture or the array. Unused for Bindless.
+	int index = 0;				// Array layer, or slot in the bindless handle table.
+};
@@ -0,0 +1,221 @@
+#include "TextureStreamer.h"
+
+// Local Library Includes
+#include "RenderableObject.h"
+#include "TextureLoader.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+TextureStreamer::TextureStreamer(size_t vramBudgetBytes, int startupLevels, int maxUploadsPerFrame, WorkerPool& pool) : pool(pool) {
+	budgetBytes = vramBudgetBytes;
+	this->startupLevels = max(1, startupLevels);
+	this->maxUploadsPerFrame = maxUploadsPerFrame;
+}
+
+TextureStreamer::~TextureStreamer() {
+	for (auto& entry : textures) {
+		// Decodes still running reference our path strings, so let them finish first.
+		if (entry.second->pending.valid())
+			entry.second->pending.wait();
+		glDeleteTextures(1, &entry.second->texture);
+	}
+
+	// GL reuses deleted names; a cache still naming one would skip the next bind of that name.
+	RenderableObject::bindTexture2D(0);
+}
+
+// ---
+// Loading
+// ---
+TextureRef TextureStreamer::add(const char* texPath) {
+	TextureRef ref;
+	MipChain chain = TextureLoader::loadMipChain(texPath);
+	if (chain.levels.empty())
+		return ref;
+
+	unique_ptr<StreamedTexture> tex(new StreamedTexture());
+	tex->path = texPath;
+	tex->channels = chain.channels;
+	tex->requestedPixels = 0.0f;
+
+	for (const MipLevel& level : chain.levels)
+		tex->levelSizes.push_back(glm::ivec2(level.width, level.height));
+
+	int levels = (int)chain.levels.size();
+	tex->minResidentTop = max(0, levels - startupLevels);
+	tex->residentTop = levels; // Nothing resident yet.
+	tex->wantedTop = tex->minResidentTop;
+
+	glGenTextures(1, &tex->texture);
+	RenderableObject::bindTexture2D(tex->texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+	// Only the tail of the chain goes to the GPU now; the rest is dropped and re-decoded on demand.
+	uploadLevels(*tex, chain, tex->minResidentTop, levels - 1);
+
+	ref.texture = tex->texture;
+	textures[tex->texture] = std::move(tex);
+	return ref;
+}
+
+void TextureStreamer::requestPixels(unsigned int texture, float screenPixels) {
+	auto it = textures.find(texture);
+	if (it != textures.end())
+		it->second->requestedPixels = max(it->second->requestedPixels, screenPixels);
+}
+
+// ---
+// Per-frame residency
+// ---
+void TextureStreamer::update() {
+	// 1. Decide which level each texture would like as its top, ignoring the budget.
+	for (auto& entry : textures) {
+		StreamedTexture& tex = *entry.second;
+		tex.wantedTop = levelForPixels(tex, tex.requestedPixels);
+	}
+
+	// 2. Give up detail on the most oversampled textures until the wanted set fits.
+	fitToBudget();
+
+	// 3. Apply the decisions, limiting how many textures grow per frame to keep frame times flat.
+	int uploads = 0;
+	for (auto& entry : textures) {
+		StreamedTexture& tex = *entry.second;
+
+		if (tex.wantedTop > tex.residentTop)
+			evictTo(tex, tex.wantedTop);
+
+		if (tex.pending.valid() && uploads < maxUploadsPerFrame &&
+			tex.pending.wait_for(chrono::seconds(0)) == future_status::ready) {
+			MipChain chain = tex.pending.get();
+
+			// The wanted level may have changed while decoding; only upload what's still missing.
+			if (tex.wantedTop < tex.residentTop && chain.levels.size() == tex.levelSizes.size()) {
+				uploadLevels(tex, chain, tex.wantedTop, tex.residentTop - 1);
+				uploads++;
+			}
+		}
+
+		if (tex.wantedTop < tex.residentTop && !tex.pending.valid()) {
+			const string* path = &tex.path;
+			tex.pending = pool.async([path]() { return TextureLoader::loadMipChain(path->c_str()); });
+		}
+
+		// Objects re-report every frame; textures nobody asks for fall back to their minimum.
+		tex.requestedPixels = 0.0f;
+	}
+}
+
+void TextureStreamer::fitToBudget() {
+	size_t total = 0;
+	for (auto& entry : textures)
+		total += residentBytesFrom(*entry.second, entry.second->wantedTop);
+
+	while (total > budgetBytes) {
+		StreamedTexture* victim = nullptr;
+		float worstOversampling = 0.0f;
+
+		for (auto& entry : textures) {
+			StreamedTexture& tex = *entry.second;
+			if (tex.wantedTop >= tex.minResidentTop)
+				continue;
+
+			glm::ivec2 size = tex.levelSizes[tex.wantedTop];
+			float oversampling = max(size.x, size.y) / max(tex.requestedPixels, 1.0f);
+
+			if (!victim || oversampling > worstOversampling) {
+				victim = &tex;
+				worstOversampling = oversampling;
+			}
+		}
+
+		// Everything is already at its minimum; the budget is simply too small.
+		if (!victim)
+			break;
+
+		total -= levelBytes(*victim, victim->wantedTop);
+		victim->wantedTop++;
+	}
+}
+
+int TextureStreamer::levelForPixels(const StreamedTexture& tex, float pixels) const {
+	if (pixels <= 0.0f)
+		return tex.minResidentTop;
+
+	// One texel per pixel: each level halves the resolution, so the right level is log2 of the ratio.
+	glm::ivec2 top = tex.levelSizes[0];
+	int level = (int)floorf(log2f(max(top.x, top.y) / pixels));
+	return min(max(level, 0), tex.minResidentTop);
+}
+
+void TextureStreamer::uploadLevels(StreamedTexture& tex, const MipChain& chain, int first, int last) {
+	RenderableObject::bindTexture2D(tex.texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (int level = first; level <= last; level++) {
+		const MipLevel& mip = chain.levels[level];
+		glTexImage2D(GL_TEXTURE_2D, level, MipmapGenerator::internalFormat(tex.channels), mip.width, mip.height, 0,
+			MipmapGenerator::pixelFormat(tex.channels), GL_UNSIGNED_BYTE, mip.pixels.data());
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	// Only widen the sampled range once the new levels actually exist.
+	tex.residentTop = min(tex.residentTop, first);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, tex.residentTop);
+}
+
+void TextureStreamer::evictTo(StreamedTexture& tex, int newTop) {
+	RenderableObject::bindTexture2D(tex.texture);
+
+	// Clamp sampling first so the texture stays complete, then release the finer levels.
+	//		Respecifying a level as 0x0 lets the driver free its memory.
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, newTop);
+	for (int level = tex.residentTop; level < newTop; level++) {
+		glTexImage2D(GL_TEXTURE_2D, level, MipmapGenerator::internalFormat(tex.channels), 0, 0, 0,
+			MipmapGenerator::pixelFormat(tex.channels), GL_UNSIGNED_BYTE, NULL);
+	}
+
+	tex.residentTop = newTop;
+}
+
+// ---
+// Accounting
+// ---
+size_t TextureStreamer::levelBytes(const StreamedTexture& tex, int level) const {
+	glm::ivec2 size = tex.levelSizes[level];
+	return (size_t)size.x * size.y * tex.channels;
+}
+
+size_t TextureStreamer::residentBytesFrom(const StreamedTexture& tex, int top) const {
+	size_t total = 0;
+	for (int level = top; level < (int)tex.levelSizes.size(); level++)
+		total += levelBytes(tex, level);
+	return total;
+}
+
+size_t TextureStreamer::residentBytes() const {
+	size_t total = 0;
+	for (const auto& entry : textures)
+		total += residentBytesFrom(*entry.second, entry.second->residentTop);
+	return total;
+}
+
+float TextureStreamer::projectedPixels(const glm::vec3& center, float radius, const glm::vec3& cameraPos, float fovY, int viewportHeight) {
+	float distance = glm::length(center - cameraPos);
+
+	// Inside the bounding sphere it covers the whole screen.
+	if (distance <= radius)
+		return (float)viewportHeight;
+
+	float projectedRadius = radius / (distance * tanf(fovY * 0.5f));
+	return projectedRadius * viewportHeight;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Local Library Includes
+#include "MipmapGenerator.h"
+#include "TextureRef.h"
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Keeps only the mip levels that are actually visible resident in VRAM.
+//		At startup each texture uploads just its smallest levels. Every frame objects report how large
+//		they appear on screen, and update() streams in finer levels (decoded on worker threads) or drops
+//		ones that are no longer needed. GL_TEXTURE_BASE_LEVEL/MAX_LEVEL clamp sampling to what's resident,
+//		and when the total exceeds the VRAM budget the most oversampled textures give up detail first.
+class TextureStreamer {
+
+	private:
+		struct StreamedTexture {
+			string path;
+			unsigned int texture;
+			int channels;
+			vector<glm::ivec2> levelSizes;	// Dimensions of every level of the full chain.
+			int residentTop;				// Finest level currently in VRAM.
+			int minResidentTop;				// Levels from here down are never evicted.
+			int wantedTop;					// Decided in update().
+			float requestedPixels;			// Largest on-screen size reported this frame.
+			future<MipChain> pending;		// In-flight decode, if any.
+		};
+
+		map<unsigned int, unique_ptr<StreamedTexture>> textures;
+		size_t budgetBytes;
+		int startupLevels;
+		int maxUploadsPerFrame;
+		WorkerPool& pool;
+
+		size_t levelBytes(const StreamedTexture& tex, int level) const;
+		size_t residentBytesFrom(const StreamedTexture& tex, int top) const;
+		int levelForPixels(const StreamedTexture& tex, float pixels) const;
+		void fitToBudget();
+		void uploadLevels(StreamedTexture& tex, const MipChain& chain, int first, int last);
+		void evictTo(StreamedTexture& tex, int newTop);
+
+	public:
+		// Constructor
+		TextureStreamer(size_t vramBudgetBytes, int startupLevels = 4, int maxUploadsPerFrame = 2, WorkerPool& pool = WorkerPool::shared());
+		~TextureStreamer();
+
+		TextureStreamer(const TextureStreamer&) = delete;
+		TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+		// Functions
+		// Load a texture with only its smallest levels resident.
+		TextureRef add(const char* texPath);
+
+		// Report that 'texture' covers roughly this many pixels on screen this frame.
+		void requestPixels(unsigned int texture, float screenPixels);
+
+		// Stream in, stream out and enforce the budget. Call once per frame on the GL thread.
+		//		Textures are bound on unit 0 through RenderableObject's bind cache, so this is safe between draws.
+		void update();
+
+		size_t residentBytes() const;
+		void setBudget(size_t vramBudgetBytes) { budgetBytes = vramBudgetBytes; }
+
+		// Projected diameter in pixels of a bounding sphere seen through a perspective camera.
+		static float projectedPixels(const glm::vec3& center, float radius, const glm::vec3& cameraPos, float fovY, int viewportHeight);
+};
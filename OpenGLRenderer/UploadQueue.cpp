@@ -0,0 +1,246 @@
+#include "UploadQueue.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cstdint>
+
+UploadQueue::UploadQueue(size_t bytesPerFrame, double millisecondsPerFrame, size_t sliceBytes) {
+	this->bytesPerFrame = bytesPerFrame;
+	this->millisecondsPerFrame = millisecondsPerFrame;
+	this->sliceBytes = max<size_t>(1, sliceBytes);
+	nextSequence = 0;
+	queuedBytes = 0;
+	lastFrameBytes = 0;
+}
+
+// ---
+// Producers
+// ---
+void UploadQueue::uploadBuffer(GLuint buffer, size_t offset, vector<unsigned char> data, UploadPriority priority, shared_ptr<UploadTicket> ticket) {
+	unique_ptr<Request> request(new Request());
+	request->kind = RequestKind::Buffer;
+	request->priority = (int)priority;
+	request->ticket = ticket;
+	request->object = buffer;
+	request->offset = offset;
+	request->data = std::move(data);
+	push(std::move(request));
+}
+
+void UploadQueue::uploadTexture(GLuint texture, GLint level, GLenum internalFormat, int width, int height, GLenum format, GLenum type, vector<unsigned char> pixels, UploadPriority priority, shared_ptr<UploadTicket> ticket) {
+	unique_ptr<Request> request(new Request());
+	request->kind = RequestKind::Texture;
+	request->priority = (int)priority;
+	request->ticket = ticket;
+	request->target = GL_TEXTURE_2D;
+	request->object = texture;
+	request->level = level;
+	request->internalFormat = internalFormat;
+	request->width = width;
+	request->height = height;
+	request->format = format;
+	request->type = type;
+	request->rowBytes = (size_t)width * bytesPerPixel(format, type);
+	request->data = std::move(pixels);
+	push(std::move(request));
+}
+
+void UploadQueue::uploadMipChain(GLuint texture, MipChain chain, UploadPriority priority, shared_ptr<UploadTicket> ticket) {
+	if (chain.levels.empty())
+		return;
+
+	int channels = chain.channels;
+	GLint maxLevel = (GLint)chain.levels.size() - 1;
+
+	for (size_t i = 0; i < chain.levels.size(); i++) {
+		MipLevel& level = chain.levels[i];
+		uploadTexture(texture, (GLint)i, MipmapGenerator::internalFormat(channels), level.width, level.height,
+			MipmapGenerator::pixelFormat(channels), GL_UNSIGNED_BYTE, std::move(level.pixels), priority, ticket);
+	}
+
+	enqueue([texture, channels, maxLevel]() {
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+
+		// Greyscale images would otherwise sample as pure red.
+		if (channels == 1) {
+			GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+			glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		}
+		else if (channels == 2) {
+			GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+			glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		}
+	}, 0, priority, ticket);
+}
+
+void UploadQueue::enqueue(function<void()> command, size_t estimatedBytes, UploadPriority priority, shared_ptr<UploadTicket> ticket) {
+	unique_ptr<Request> request(new Request());
+	request->kind = RequestKind::Command;
+	request->priority = (int)priority;
+	request->ticket = ticket;
+	request->command = std::move(command);
+	request->cost = estimatedBytes;
+	push(std::move(request));
+}
+
+void UploadQueue::push(unique_ptr<Request> request) {
+	if (request->ticket)
+		request->ticket->pending++;
+
+	lock_guard<mutex> lock(queueMutex);
+	request->sequence = nextSequence++;
+	queuedBytes += (request->kind == RequestKind::Command) ? request->cost : request->data.size();
+	requests.push_back(std::move(request));
+	push_heap(requests.begin(), requests.end(), lowerPriority);
+}
+
+// std heaps keep the "largest" element on top, so the older request counts as larger within a priority.
+bool UploadQueue::lowerPriority(const unique_ptr<Request>& a, const unique_ptr<Request>& b) {
+	if (a->priority != b->priority)
+		return a->priority < b->priority;
+	return a->sequence > b->sequence;
+}
+
+// ---
+// Render thread
+// ---
+void UploadQueue::process() {
+	auto start = chrono::steady_clock::now();
+	size_t spent = 0;
+
+	// Level data is tightly packed, and textures go through unit 0, which beginFrame() already treats as dirty.
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glActiveTexture(GL_TEXTURE0);
+
+	while (true) {
+		unique_ptr<Request> request;
+		{
+			lock_guard<mutex> lock(queueMutex);
+			if (requests.empty())
+				break;
+
+			// Always move at least one slice, so a tiny budget still drains eventually.
+			if (spent > 0) {
+				double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+				if (spent >= bytesPerFrame || elapsed >= millisecondsPerFrame)
+					break;
+			}
+
+			pop_heap(requests.begin(), requests.end(), lowerPriority);
+			request = std::move(requests.back());
+			requests.pop_back();
+		}
+
+		bool finished = false;
+		size_t bytes = uploadSlice(*request, finished);
+		spent += bytes;
+
+		if (finished) {
+			if (request->ticket)
+				request->ticket->pending--;
+		}
+
+		// Unfinished requests go back with their original sequence, so they keep their place in line.
+		lock_guard<mutex> lock(queueMutex);
+		queuedBytes -= min(queuedBytes, bytes);
+		if (!finished) {
+			requests.push_back(std::move(request));
+			push_heap(requests.begin(), requests.end(), lowerPriority);
+		}
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	lastFrameBytes = spent;
+}
+
+void UploadQueue::flush() {
+	size_t savedBytes = bytesPerFrame;
+	double savedMilliseconds = millisecondsPerFrame;
+
+	bytesPerFrame = SIZE_MAX;
+	millisecondsPerFrame = 1e30;
+	process();
+
+	bytesPerFrame = savedBytes;
+	millisecondsPerFrame = savedMilliseconds;
+}
+
+size_t UploadQueue::uploadSlice(Request& request, bool& finished) {
+	switch (request.kind) {
+		case RequestKind::Command:
+			request.command();
+			finished = true;
+			return request.cost;
+
+		case RequestKind::Buffer: {
+			size_t bytes = min(sliceBytes, request.data.size() - request.progress);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, request.object);
+			glBufferSubData(GL_COPY_WRITE_BUFFER, request.offset + request.progress, bytes, request.data.data() + request.progress);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+			request.progress += bytes;
+			finished = request.progress >= request.data.size();
+			return bytes;
+		}
+
+		case RequestKind::Texture: {
+			glBindTexture(request.target, request.object);
+
+			// Give the level its storage on the first visit; the rows follow in slices.
+			if (request.progress == 0)
+				glTexImage2D(request.target, request.level, request.internalFormat, request.width, request.height, 0, request.format, request.type, NULL);
+
+			int firstRow = (int)(request.progress / max<size_t>(1, request.rowBytes));
+			int rows = (int)max<size_t>(1, sliceBytes / max<size_t>(1, request.rowBytes));
+			rows = min(rows, request.height - firstRow);
+
+			glTexSubImage2D(request.target, request.level, 0, firstRow, request.width, rows, request.format, request.type, request.data.data() + request.progress);
+
+			size_t bytes = (size_t)rows * request.rowBytes;
+			request.progress += bytes;
+			finished = firstRow + rows >= request.height;
+			return bytes;
+		}
+	}
+
+	finished = true;
+	return 0;
+}
+
+void UploadQueue::setBudget(size_t bytesPerFrame, double millisecondsPerFrame) {
+	this->bytesPerFrame = bytesPerFrame;
+	this->millisecondsPerFrame = millisecondsPerFrame;
+}
+
+size_t UploadQueue::pendingBytes() const {
+	lock_guard<mutex> lock(queueMutex);
+	return queuedBytes;
+}
+
+size_t UploadQueue::bytesPerPixel(GLenum format, GLenum type) {
+	switch (type) {
+		// Packed types hold the whole pixel in one 32-bit word.
+		case GL_UNSIGNED_INT_5_9_9_9_REV:
+		case GL_UNSIGNED_INT_10F_11F_11F_REV:
+		case GL_UNSIGNED_INT_2_10_10_10_REV:
+		case GL_UNSIGNED_INT_24_8:
+		case GL_UNSIGNED_INT_8_8_8_8:
+		case GL_UNSIGNED_INT_8_8_8_8_REV:
+			return 4;
+	}
+
+	size_t components = 4;
+	switch (format) {
+		case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: components = 1; break;
+		case GL_RG: case GL_RG_INTEGER: components = 2; break;
+		case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: components = 3; break;
+	}
+
+	switch (type) {
+		case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return components * 2;
+		case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: return components * 4;
+	}
+	return components;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// Local Library Includes
+#include "MipmapGenerator.h"
+
+// Standard Library Includes
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+enum class UploadPriority {
+	Low,	// Detail that can pop in late (distant textures, extra mips).
+	Normal,
+	High	// Needed before anything can be drawn (geometry).
+};
+
+// Counts a group of uploads that belong together, such as everything one object needs before it can be drawn.
+//		Producers bump it when they queue work, and the queue drops it as each request completes.
+struct UploadTicket {
+	atomic<int> pending{ 0 };
+
+	bool ready() const { return pending.load() == 0; }
+};
+
+// Spreads GPU uploads over frames so creating many objects at once doesn't produce one enormous frame.
+//
+//		Any thread can queue work. The render thread calls process() once per frame, which uploads in
+//		priority order (oldest first within a priority) until the frame's byte or time budget runs out.
+//		Large buffers go up in glBufferSubData chunks, and large textures in row slices through
+//		glTexSubImage2D, so no single request can blow the budget by much. At least one slice is
+//		uploaded every frame, so a budget smaller than a slice still makes progress.
+//
+//		Buffers are written through GL_COPY_WRITE_BUFFER so no VAO's element binding is disturbed.
+//		Textures are bound on the active unit; call process() before RenderableObject::beginFrame().
+class UploadQueue {
+
+	private:
+		enum class RequestKind {
+			Buffer,
+			Texture,
+			Command
+		};
+
+		struct Request {
+			RequestKind kind;
+			int priority;
+			unsigned long long sequence;
+			shared_ptr<UploadTicket> ticket;
+
+			GLenum target = 0;
+			GLuint object = 0;
+			size_t offset = 0;			// Buffer destination offset.
+			GLint level = 0;
+			GLenum internalFormat = 0;
+			int width = 0;
+			int height = 0;
+			GLenum format = 0;
+			GLenum type = 0;
+			size_t rowBytes = 0;
+
+			vector<unsigned char> data;
+			size_t progress = 0;		// Bytes already uploaded.
+
+			function<void()> command;
+			size_t cost = 0;			// What a command counts against the budget.
+		};
+
+		vector<unique_ptr<Request>> requests; // A heap, highest priority and oldest on top.
+		mutable mutex queueMutex;
+		unsigned long long nextSequence;
+		size_t queuedBytes;
+
+		size_t bytesPerFrame;
+		double millisecondsPerFrame;
+		size_t sliceBytes;
+		size_t lastFrameBytes;
+
+		void push(unique_ptr<Request> request);
+		size_t uploadSlice(Request& request, bool& finished);
+
+		static bool lowerPriority(const unique_ptr<Request>& a, const unique_ptr<Request>& b);
+
+	public:
+		// Constructor
+		UploadQueue(size_t bytesPerFrame = 4 * 1024 * 1024, double millisecondsPerFrame = 2.0, size_t sliceBytes = 256 * 1024);
+
+		UploadQueue(const UploadQueue&) = delete;
+		UploadQueue& operator=(const UploadQueue&) = delete;
+
+		// Functions
+		// The buffer must already have storage (e.g. glBufferData with NULL) covering offset + data.size().
+		void uploadBuffer(GLuint buffer, size_t offset, vector<unsigned char> data, UploadPriority priority = UploadPriority::Normal, shared_ptr<UploadTicket> ticket = nullptr);
+
+		// Specifies one level of a GL_TEXTURE_2D: allocated on the first slice, filled row by row after that.
+		void uploadTexture(GLuint texture, GLint level, GLenum internalFormat, int width, int height, GLenum format, GLenum type, vector<unsigned char> pixels, UploadPriority priority = UploadPriority::Normal, shared_ptr<UploadTicket> ticket = nullptr);
+
+		// Every level of a chain, followed by the same level range and swizzle setup MipmapGenerator::upload does.
+		void uploadMipChain(GLuint texture, MipChain chain, UploadPriority priority = UploadPriority::Normal, shared_ptr<UploadTicket> ticket = nullptr);
+
+		// Arbitrary GL work (glGenerateMipmap, parameter changes) charged as 'estimatedBytes' against the budget.
+		void enqueue(function<void()> command, size_t estimatedBytes, UploadPriority priority = UploadPriority::Normal, shared_ptr<UploadTicket> ticket = nullptr);
+
+		// Render thread only.
+		void process();
+		void flush(); // Ignore the budget and upload everything now (loading screens, shutdown).
+
+		void setBudget(size_t bytesPerFrame, double millisecondsPerFrame);
+		size_t pendingBytes() const;
+		size_t uploadedLastFrame() const { return lastFrameBytes; }
+
+		static size_t bytesPerPixel(GLenum format, GLenum type);
+};
@@ -0,0 +1,30 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 vertexColor;
+in vec2 TexCoord;
+
+// Set by VirtualTexture::attachFeedbackProgram.
+uniform vec2 virtualSize;
+uniform float pageSize;
+uniform int maxLevel;
+uniform float lodBias;	// This pass runs at reduced resolution; the bias brings the level back to full resolution.
+
+// Writes the virtual page this pixel needs, packed for VirtualTexture::parseFeedback:
+//		(x low byte, y low byte, x high nibble | y high nibble << 4, level + 1). Alpha 0 means "nothing".
+void main()
+{
+	vec2 uv = fract(TexCoord);
+
+	vec2 texel = TexCoord * virtualSize;
+	vec2 dx = dFdx(texel);
+	vec2 dy = dFdy(texel);
+	float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + lodBias;
+	int level = clamp(int(floor(lod)), 0, maxLevel);
+
+	vec2 pagesAtLevel = (virtualSize / pageSize) / exp2(float(level));
+	ivec2 page = ivec2(uv * pagesAtLevel);
+
+	int high = ((page.x >> 8) & 15) | (((page.y >> 8) & 15) << 4);
+	FragColor = vec4(float(page.x & 255), float(page.y & 255), float(high), float(level + 1)) / 255.0;
+}
\ No newline at end of file
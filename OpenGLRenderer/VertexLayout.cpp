@@ -0,0 +1,55 @@
+#include "VertexLayout.h"
+
+// Standard Library Includes
+#include <cstring>
+
+void VertexLayout::apply(size_t baseOffset) const {
+	for (const VertexAttribute& attribute : attributes) {
+		const void* pointer = (const void*)(baseOffset + attribute.offset);
+
+		// Integer attributes need the I variant, or GL converts them to float before the shader sees them.
+		if (attribute.integer)
+			glVertexAttribIPointer(attribute.location, attribute.components, attribute.type, stride, pointer);
+		else
+			glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE, stride, pointer);
+
+		glEnableVertexAttribArray(attribute.location);
+	}
+}
+
+const VertexAttribute* VertexLayout::find(GLuint location) const {
+	for (const VertexAttribute& attribute : attributes) {
+		if (attribute.location == location)
+			return &attribute;
+	}
+	return nullptr;
+}
+
+bool VertexLayout::readPositions(const void* vertexData, size_t vertexCount, vector<glm::vec3>& positions) const {
+	const VertexAttribute* position = find(0);
+	if (!position || position->type != GL_FLOAT || position->components < 3)
+		return false;
+
+	positions.resize(vertexCount);
+	const unsigned char* base = (const unsigned char*)vertexData + position->offset;
+	for (size_t i = 0; i < vertexCount; i++) {
+		float xyz[3];
+		memcpy(xyz, base + i * stride, sizeof(xyz));
+		positions[i] = glm::vec3(xyz[0], xyz[1], xyz[2]);
+	}
+	return true;
+}
+
+bool VertexLayout::operator==(const VertexLayout& other) const {
+	if (stride != other.stride || attributes.size() != other.attributes.size())
+		return false;
+
+	for (size_t i = 0; i < attributes.size(); i++) {
+		const VertexAttribute& a = attributes[i];
+		const VertexAttribute& b = other.attributes[i];
+		if (a.location != b.location || a.components != b.components || a.type != b.type ||
+			a.normalized != b.normalized || a.integer != b.integer || a.offset != b.offset)
+			return false;
+	}
+	return true;
+}
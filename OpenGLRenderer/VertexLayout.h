@@ -0,0 +1,183 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Standard Library Includes
+#include <array>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// One vertex shader input: where it lives in the vertex and how GL should read it.
+struct VertexAttribute {
+	GLuint location;
+	GLint components;
+	GLenum type;
+	bool normalized;	// Integer data read as 0..1 (or -1..1) floats.
+	bool integer;		// Integer data read as ints (glVertexAttribIPointer).
+	GLuint offset;
+	GLuint size;		// Bytes the member occupies.
+};
+
+// ---
+// Attribute formats, derived from the C++ type of each vertex member.
+// ---
+
+// Integer components the shader should see as normalized floats, e.g. Normalized<unsigned char, 4> for an RGBA8 colour.
+template<typename Component, int Count>
+struct Normalized {
+	Component v[Count];
+};
+
+// Integer components the shader reads as ints/uints (ivec, uvec).
+template<typename Component, int Count>
+struct Integer {
+	Component v[Count];
+};
+
+template<typename Component> struct ComponentType;
+template<> struct ComponentType<float> { static constexpr GLenum value = GL_FLOAT; };
+template<> struct ComponentType<signed char> { static constexpr GLenum value = GL_BYTE; };
+template<> struct ComponentType<unsigned char> { static constexpr GLenum value = GL_UNSIGNED_BYTE; };
+template<> struct ComponentType<short> { static constexpr GLenum value = GL_SHORT; };
+template<> struct ComponentType<unsigned short> { static constexpr GLenum value = GL_UNSIGNED_SHORT; };
+template<> struct ComponentType<int> { static constexpr GLenum value = GL_INT; };
+template<> struct ComponentType<unsigned int> { static constexpr GLenum value = GL_UNSIGNED_INT; };
+
+template<typename T> struct AttributeFormat;
+
+template<> struct AttributeFormat<float> {
+	static constexpr GLint components = 1;
+	static constexpr GLenum type = GL_FLOAT;
+	static constexpr bool normalized = false;
+	static constexpr bool integer = false;
+};
+
+template<int Count, GLenum Type> struct FloatVectorFormat {
+	static constexpr GLint components = Count;
+	static constexpr GLenum type = Type;
+	static constexpr bool normalized = false;
+	static constexpr bool integer = false;
+};
+template<> struct AttributeFormat<glm::vec2> : FloatVectorFormat<2, GL_FLOAT> {};
+template<> struct AttributeFormat<glm::vec3> : FloatVectorFormat<3, GL_FLOAT> {};
+template<> struct AttributeFormat<glm::vec4> : FloatVectorFormat<4, GL_FLOAT> {};
+
+template<typename Component, int Count> struct AttributeFormat<Normalized<Component, Count>> {
+	static constexpr GLint components = Count;
+	static constexpr GLenum type = ComponentType<Component>::value;
+	static constexpr bool normalized = true;
+	static constexpr bool integer = false;
+};
+
+template<typename Component, int Count> struct AttributeFormat<Integer<Component, Count>> {
+	static constexpr GLint components = Count;
+	static constexpr GLenum type = ComponentType<Component>::value;
+	static constexpr bool normalized = false;
+	static constexpr bool integer = true;
+};
+
+template<typename Member>
+constexpr VertexAttribute vertexAttribute(GLuint location, size_t offset) {
+	return VertexAttribute{ location, AttributeFormat<Member>::components, AttributeFormat<Member>::type,
+		AttributeFormat<Member>::normalized, AttributeFormat<Member>::integer, (GLuint)offset, (GLuint)sizeof(Member) };
+}
+
+// Describe a vertex member: its format comes from the member's type and its offset from offsetof,
+//		both at compile time, so adding or reordering members can't leave the attribute setup out of date.
+#define VERTEX_ATTRIBUTE(Vertex, member, location) vertexAttribute<decltype(Vertex::member)>(location, offsetof(Vertex, member))
+
+// ---
+// Vertex types. Each lists its attributes once, in a constexpr attributes() function.
+// ---
+
+// The layout Default.vert expects: position, colour and texture coordinates as floats.
+struct DefaultVertex {
+	glm::vec3 position;
+	glm::vec3 color;
+	glm::vec2 texCoord;
+
+	static constexpr array<VertexAttribute, 3> attributes() {
+		return { {
+			VERTEX_ATTRIBUTE(DefaultVertex, position, 0),
+			VERTEX_ATTRIBUTE(DefaultVertex, color, 1),
+			VERTEX_ATTRIBUTE(DefaultVertex, texCoord, 2)
+		} };
+	}
+};
+
+// Full precision vertices as mesh loaders produce them: DefaultVertex plus a normal at location 3.
+//		Shaders that don't read normals just ignore the extra attribute.
+struct MeshVertex {
+	glm::vec3 position;
+	glm::vec3 color;
+	glm::vec2 texCoord;
+	glm::vec3 normal;
+
+	static constexpr array<VertexAttribute, 4> attributes() {
+		return { {
+			VERTEX_ATTRIBUTE(MeshVertex, position, 0),
+			VERTEX_ATTRIBUTE(MeshVertex, color, 1),
+			VERTEX_ATTRIBUTE(MeshVertex, texCoord, 2),
+			VERTEX_ATTRIBUTE(MeshVertex, normal, 3)
+		} };
+	}
+};
+
+// ---
+// Runtime form
+// ---
+
+// A vertex format as data, so code that handles many formats (arenas, batching, loaders) can compare and apply them.
+struct VertexLayout {
+	vector<VertexAttribute> attributes;
+	GLsizei stride = 0;
+
+	// Set up the attribute pointers on the bound VAO, reading from the bound GL_ARRAY_BUFFER starting at baseOffset.
+	void apply(size_t baseOffset = 0) const;
+
+	// The attribute at 'location', or nullptr.
+	const VertexAttribute* find(GLuint location) const;
+
+	// Copy out the xyz of the float position at location 0. Returns false if the layout has none.
+	bool readPositions(const void* vertexData, size_t vertexCount, vector<glm::vec3>& positions) const;
+
+	bool operator==(const VertexLayout& other) const;
+	bool operator!=(const VertexLayout& other) const { return !(*this == other); }
+
+	template<typename Vertex>
+	static VertexLayout of() {
+		static_assert(validate<Vertex>(), "Vertex attribute lies outside the vertex or two attributes share a location");
+
+		constexpr auto described = Vertex::attributes();
+		VertexLayout layout;
+		layout.attributes.assign(described.begin(), described.end());
+		layout.stride = (GLsizei)sizeof(Vertex);
+		return layout;
+	}
+
+	// Compile-time checks on a vertex type's description.
+	template<typename Vertex>
+	static constexpr bool validate() {
+		return validateAttributes(Vertex::attributes(), sizeof(Vertex));
+	}
+
+private:
+	template<size_t Count>
+	static constexpr bool validateAttributes(const array<VertexAttribute, Count>& attributes, size_t stride) {
+		for (size_t i = 0; i < Count; i++) {
+			if (attributes[i].offset + attributes[i].size > stride)
+				return false;
+			for (size_t j = i + 1; j < Count; j++) {
+				if (attributes[i].location == attributes[j].location)
+					return false;
+			}
+		}
+		return true;
+	}
+};
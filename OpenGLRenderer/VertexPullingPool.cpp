@@ -0,0 +1,262 @@
+#include "VertexPullingPool.h"
+
+// Local Library Includes
+#include "RenderableObject.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+const GLint VertexPullingPool::textureUnit;
+const GLuint VertexPullingPool::storageBinding;
+
+namespace {
+	const size_t TEXELS_PER_VERTEX = sizeof(PulledVertex) / sizeof(glm::vec4);
+
+	// One component of any attribute format as a float, the way GL's fixed function fetch would convert it.
+	float readComponent(const unsigned char* source, GLenum type, bool normalized, int component) {
+		switch (type) {
+			case GL_FLOAT: {
+				float value;
+				memcpy(&value, source + component * sizeof(float), sizeof(float));
+				return value;
+			}
+			case GL_UNSIGNED_BYTE: {
+				unsigned char value = source[component];
+				return normalized ? value / 255.0f : (float)value;
+			}
+			case GL_BYTE: {
+				signed char value = (signed char)source[component];
+				return normalized ? max(value / 127.0f, -1.0f) : (float)value;
+			}
+			case GL_UNSIGNED_SHORT: {
+				unsigned short value;
+				memcpy(&value, source + component * sizeof(value), sizeof(value));
+				return normalized ? value / 65535.0f : (float)value;
+			}
+			case GL_SHORT: {
+				short value;
+				memcpy(&value, source + component * sizeof(value), sizeof(value));
+				return normalized ? max(value / 32767.0f, -1.0f) : (float)value;
+			}
+			case GL_UNSIGNED_INT: {
+				unsigned int value;
+				memcpy(&value, source + component * sizeof(value), sizeof(value));
+				return normalized ? (float)(value / 4294967295.0) : (float)value;
+			}
+			case GL_INT: {
+				int value;
+				memcpy(&value, source + component * sizeof(value), sizeof(value));
+				return normalized ? (float)max(value / 2147483647.0, -1.0) : (float)value;
+			}
+		}
+		return 0.0f;
+	}
+
+	// Missing components fill in as GL does for attributes: (0, 0, 0, 1) beyond what is stored.
+	glm::vec4 readAttribute(const VertexAttribute* attribute, const unsigned char* vertex, const glm::vec4& fallback) {
+		if (!attribute)
+			return fallback;
+
+		glm::vec4 value(0.0f, 0.0f, 0.0f, 1.0f);
+		const unsigned char* source = vertex + attribute->offset;
+		for (int i = 0; i < min(attribute->components, 4); i++)
+			value[i] = readComponent(source, attribute->type, attribute->normalized, i);
+		return value;
+	}
+
+	glm::vec3 readNormal(const VertexAttribute* attribute, const unsigned char* vertex) {
+		if (!attribute)
+			return glm::vec3(0.0f, 0.0f, 1.0f);
+
+		// Two components are the octahedral encoding QuantizedVertex stores.
+		if (attribute->components == 2) {
+			glm::vec4 stored = readAttribute(attribute, vertex, glm::vec4(0.5f));
+			unsigned short encoded[2] = {
+				(unsigned short)(min(max(stored.x, 0.0f), 1.0f) * 65535.0f + 0.5f),
+				(unsigned short)(min(max(stored.y, 0.0f), 1.0f) * 65535.0f + 0.5f)
+			};
+			return VertexQuantizer::decodeNormal(encoded);
+		}
+		return glm::vec3(readAttribute(attribute, vertex, glm::vec4(0.0f, 0.0f, 1.0f, 0.0f)));
+	}
+
+	// Widen indices to the pool's 32 bits.
+	void readIndices(const void* indexData, size_t indexCount, GLenum indexType, vector<GLuint>& indices) {
+		indices.resize(indexCount);
+		if (indexType == GL_UNSIGNED_INT) {
+			memcpy(indices.data(), indexData, indexCount * sizeof(GLuint));
+		}
+		else if (indexType == GL_UNSIGNED_SHORT) {
+			const unsigned short* source = (const unsigned short*)indexData;
+			for (size_t i = 0; i < indexCount; i++)
+				indices[i] = source[i];
+		}
+		else {
+			const unsigned char* source = (const unsigned char*)indexData;
+			for (size_t i = 0; i < indexCount; i++)
+				indices[i] = source[i];
+		}
+	}
+}
+
+// ---
+// VertexPullingPool
+// ---
+
+VertexPullingPool::VertexPullingPool(size_t vertexCapacity, size_t indexCapacity, WorkerPool& pool) : pool(pool) {
+	// A buffer texture is addressed in texels, and every vertex takes three.
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	if (maxTexels > 0 && vertexCapacity * TEXELS_PER_VERTEX > (size_t)maxTexels) {
+		cout << "ERROR::VERTEX_PULLING_POOL::CAPACITY_EXCEEDS_TEXTURE_BUFFER_SIZE (" << vertexCapacity << " vertices, limit "
+			<< maxTexels / TEXELS_PER_VERTEX << ")" << endl;
+		vertexCapacity = maxTexels / TEXELS_PER_VERTEX;
+	}
+	vertices = RangeAllocator(vertexCapacity);
+	indices = RangeAllocator(indexCapacity);
+
+	glGenBuffers(1, &vertexBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, vertexBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, vertexCapacity * sizeof(PulledVertex), NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	glGenTextures(1, &vertexTexture);
+	glBindTexture(GL_TEXTURE_BUFFER, vertexTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, vertexBuffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+	// No attributes at all; the VAO only remembers the element buffer.
+	// Bound through RenderableObject's cache, so its next Draw() doesn't assume its own VAO is still bound.
+	glGenVertexArrays(1, &vao);
+	RenderableObject::bindVertexArray(vao);
+	glGenBuffers(1, &indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+	RenderableObject::bindVertexArray(0);
+}
+
+VertexPullingPool::~VertexPullingPool() {
+	glDeleteVertexArrays(1, &vao);
+	// Every pulled object bound this VAO through the cache, which would otherwise skip its recycled name.
+	RenderableObject::bindVertexArray(0);
+	glDeleteTextures(1, &vertexTexture);
+	glDeleteBuffers(1, &vertexBuffer);
+	glDeleteBuffers(1, &indexBuffer);
+}
+
+PulledMesh VertexPullingPool::add(const VertexLayout& layout, const void* vertexData, size_t vertexCount, const void* indexData, size_t indexCount,
+	GLenum indexType, const Dequantization& dequantization, UploadQueue* uploadQueue, shared_ptr<UploadTicket> ticket) {
+
+	PulledMesh mesh;
+	if (vertexCount == 0 || indexCount == 0) {
+		cout << "ERROR::VERTEX_PULLING_POOL::EMPTY_MESH" << endl;
+		return mesh;
+	}
+
+	// The shader fetches gl_VertexID straight from the pool, so an index past this mesh would read its neighbours.
+	vector<GLuint> widened;
+	readIndices(indexData, indexCount, indexType, widened);
+	for (GLuint index : widened) {
+		if (index >= vertexCount) {
+			cout << "ERROR::VERTEX_PULLING_POOL::INDEX_OUT_OF_RANGE" << endl;
+			return mesh;
+		}
+	}
+
+	size_t firstVertex = vertices.allocate(vertexCount);
+	size_t firstIndex = indices.allocate(indexCount);
+	if (firstVertex == RangeAllocator::INVALID || firstIndex == RangeAllocator::INVALID) {
+		if (firstVertex != RangeAllocator::INVALID)
+			vertices.free(firstVertex, vertexCount);
+		if (firstIndex != RangeAllocator::INVALID)
+			indices.free(firstIndex, indexCount);
+		cout << "ERROR::VERTEX_PULLING_POOL::OUT_OF_SPACE (" << vertexCount << " vertices, " << indexCount << " indices)" << endl;
+		return mesh;
+	}
+
+	vector<PulledVertex> converted(vertexCount);
+	convert(layout, vertexData, vertexCount, dequantization, converted.data(), &pool);
+
+	write(vertexBuffer, firstVertex * sizeof(PulledVertex), converted.data(), converted.size() * sizeof(PulledVertex), uploadQueue, ticket);
+	write(indexBuffer, firstIndex * sizeof(GLuint), widened.data(), widened.size() * sizeof(GLuint), uploadQueue, ticket);
+
+	mesh.baseVertex = (GLint)firstVertex;
+	mesh.firstIndex = (GLuint)firstIndex;
+	mesh.indexCount = (GLsizei)indexCount;
+	mesh.vertexCount = (GLuint)vertexCount;
+	return mesh;
+}
+
+void VertexPullingPool::free(PulledMesh& mesh) {
+	if (!mesh.valid())
+		return;
+
+	vertices.free(mesh.baseVertex, mesh.vertexCount);
+	indices.free(mesh.firstIndex, mesh.indexCount);
+	mesh = PulledMesh();
+}
+
+void VertexPullingPool::bind() const {
+	glActiveTexture(GL_TEXTURE0 + textureUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, vertexTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	if (GLExtensions::shaderStorageBuffer)
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, storageBinding, vertexBuffer);
+}
+
+// gl_VertexID comes out as index + baseVertex, which is exactly the vertex's slot in the pool.
+void VertexPullingPool::draw(const PulledMesh& mesh) const {
+	if (!mesh.valid())
+		return;
+
+	RenderableObject::bindVertexArray(vao);
+	glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, mesh.indexOffset(), mesh.baseVertex);
+}
+
+void VertexPullingPool::convert(const VertexLayout& layout, const void* vertexData, size_t vertexCount, const Dequantization& dequantization,
+	PulledVertex* out, WorkerPool* pool) {
+
+	const VertexAttribute* position = layout.find(0);
+	const VertexAttribute* color = layout.find(1);
+	const VertexAttribute* texCoord = layout.find(2);
+	const VertexAttribute* normal = layout.find(3);
+	const unsigned char* source = (const unsigned char*)vertexData;
+
+	auto convertRange = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const unsigned char* vertex = source + i * layout.stride;
+
+			glm::vec3 p = glm::vec3(readAttribute(position, vertex, glm::vec4(0.0f))) * dequantization.positionScale + dequantization.positionOffset;
+			glm::vec4 c = readAttribute(color, vertex, glm::vec4(1.0f));
+			glm::vec4 t = readAttribute(texCoord, vertex, glm::vec4(0.0f));
+			glm::vec2 uv = glm::vec2(t.x, t.y) * dequantization.texCoordScale + dequantization.texCoordOffset;
+			glm::vec3 n = readNormal(normal, vertex);
+
+			// A three component colour reads back with alpha 1, as GL would give the shader.
+			out[i].positionU = glm::vec4(p, uv.x);
+			out[i].colorV = glm::vec4(glm::vec3(c), uv.y);
+			out[i].normalAlpha = glm::vec4(n, c.w);
+		}
+	};
+
+	if (pool)
+		pool->parallelFor(vertexCount, convertRange, 4096);
+	else
+		convertRange(0, vertexCount);
+}
+
+// Writes go through GL_COPY_WRITE_BUFFER, like the geometry arena, so the bound VAO's element buffer is left alone.
+void VertexPullingPool::write(GLuint buffer, size_t offset, const void* data, size_t bytes, UploadQueue* uploadQueue, shared_ptr<UploadTicket> ticket) {
+	if (uploadQueue) {
+		const unsigned char* begin = (const unsigned char*)data;
+		uploadQueue->uploadBuffer(buffer, offset, vector<unsigned char>(begin, begin + bytes), UploadPriority::High, ticket);
+		return;
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, offset, bytes, data);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
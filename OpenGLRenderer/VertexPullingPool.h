@@ -0,0 +1,93 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Local Library Includes
+#include "GeometryArena.h"
+#include "GLExtensions.h"
+#include "UploadQueue.h"
+#include "VertexLayout.h"
+#include "VertexQuantizer.h"
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// The one vertex format the pulling shaders read: three vec4s, 48 bytes, a std430 struct or three RGBA32F texels.
+struct PulledVertex {
+	glm::vec4 positionU;	// xyz position, u texture coordinate
+	glm::vec4 colorV;		// rgb colour, v texture coordinate
+	glm::vec4 normalAlpha;	// xyz normal, colour alpha
+};
+
+struct PulledMesh {
+	GLint baseVertex = -1;
+	GLuint firstIndex = 0;
+	GLsizei indexCount = 0;
+	GLuint vertexCount = 0;
+
+	bool valid() const { return baseVertex >= 0; }
+	const void* indexOffset() const { return (const void*)(uintptr_t)(firstIndex * sizeof(GLuint)); }
+};
+
+// Geometry for vertex pulling: every mesh, whatever its vertex format, in one buffer the vertex shader reads itself.
+//
+//		Meshes are converted to PulledVertex as they are added (dequantized, octahedral normals decoded, integers
+//		normalized) and their indices widened to 32 bits. The pool's VAO has no attributes at all, only the shared
+//		index buffer. Pulled.vert fetches each vertex from a samplerBuffer (GL 3.3) by gl_VertexID, which
+//		glDrawElementsBaseVertex sets to index + baseVertex. PulledStorage.vert reads the same buffer as an SSBO
+//		on GL 4.3. Every mesh draws from the same VAO with no glVertexAttribPointer state to change, so Draw() never
+//		switches VAOs between them. Submitted to an IndirectRenderer they need PulledIndirect.vert, which also reads
+//		the draw index; its buckets still split on program and texture, so only pulled meshes sharing both go out
+//		in one multi-draw, whatever their original vertex formats.
+class VertexPullingPool {
+
+	private:
+		GLuint vao, vertexBuffer, indexBuffer, vertexTexture;
+		RangeAllocator vertices;	// In vertices.
+		RangeAllocator indices;		// In indices.
+		WorkerPool& pool;
+
+		void write(GLuint buffer, size_t offset, const void* data, size_t bytes, UploadQueue* uploadQueue, shared_ptr<UploadTicket> ticket);
+
+	public:
+		// Constructor
+		VertexPullingPool(size_t vertexCapacity = 1024 * 1024, size_t indexCapacity = 4 * 1024 * 1024, WorkerPool& pool = WorkerPool::shared());
+		~VertexPullingPool();
+
+		VertexPullingPool(const VertexPullingPool&) = delete;
+		VertexPullingPool& operator=(const VertexPullingPool&) = delete;
+
+		// Functions
+		// Convert and copy a mesh in. Positions and texture coordinates are mapped through 'dequantization'
+		//		(identity unless the data is quantized). Returns an invalid mesh if it is empty or the pool is full.
+		PulledMesh add(const VertexLayout& layout, const void* vertexData, size_t vertexCount, const void* indexData, size_t indexCount,
+			GLenum indexType = GL_UNSIGNED_INT, const Dequantization& dequantization = Dequantization(),
+			UploadQueue* uploadQueue = nullptr, shared_ptr<UploadTicket> ticket = nullptr);
+
+		void free(PulledMesh& mesh);
+
+		// Bind the vertex data for the pulling shaders: the buffer texture on textureUnit and, on GL 4.3, the SSBO
+		//		at storageBinding. Nothing else uses either, so once per frame is enough.
+		void bind() const;
+
+		void draw(const PulledMesh& mesh) const;
+
+		GLuint vertexArray() const { return vao; }
+		GLuint indexBufferId() const { return indexBuffer; }
+		size_t usedVertices() const { return vertices.size() - vertices.available(); }
+
+		// Any layout's vertices as PulledVertex, e.g. for tools or tests.
+		static void convert(const VertexLayout& layout, const void* vertexData, size_t vertexCount, const Dequantization& dequantization,
+			PulledVertex* out, WorkerPool* pool = nullptr);
+
+		static const GLint textureUnit = 2;
+		static const GLuint storageBinding = 0;
+};
@@ -0,0 +1,125 @@
+#include "VertexQuantizer.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	unsigned short toUnorm16(float value) {
+		value = min(max(value, 0.0f), 1.0f);
+		return (unsigned short)(value * 65535.0f + 0.5f);
+	}
+
+	unsigned char toUnorm8(float value) {
+		value = min(max(value, 0.0f), 1.0f);
+		return (unsigned char)(value * 255.0f + 0.5f);
+	}
+
+	// A zero extent (flat meshes, constant UVs) would divide by zero; any scale works since every value is the offset.
+	float safeInverse(float extent) {
+		return extent > 0.0f ? 1.0f / extent : 0.0f;
+	}
+}
+
+QuantizedMesh VertexQuantizer::quantize(const vector<MeshVertex>& vertices, const vector<unsigned int>& indices, WorkerPool& pool) {
+	QuantizedMesh mesh;
+	mesh.indices = indices;
+	if (vertices.empty())
+		return mesh;
+
+	// Ranges first; every vertex is then stored relative to them.
+	glm::vec3 minPos = vertices[0].position, maxPos = vertices[0].position;
+	glm::vec2 minUV = vertices[0].texCoord, maxUV = vertices[0].texCoord;
+	for (const MeshVertex& vertex : vertices) {
+		minPos = glm::min(minPos, vertex.position);
+		maxPos = glm::max(maxPos, vertex.position);
+		minUV = glm::min(minUV, vertex.texCoord);
+		maxUV = glm::max(maxUV, vertex.texCoord);
+	}
+
+	Dequantization& dequantization = mesh.dequantization;
+	dequantization.positionScale = maxPos - minPos;
+	dequantization.positionOffset = minPos;
+	dequantization.texCoordScale = maxUV - minUV;
+	dequantization.texCoordOffset = minUV;
+
+	glm::vec3 positionInverse(safeInverse(dequantization.positionScale.x), safeInverse(dequantization.positionScale.y), safeInverse(dequantization.positionScale.z));
+	glm::vec2 texCoordInverse(safeInverse(dequantization.texCoordScale.x), safeInverse(dequantization.texCoordScale.y));
+
+	mesh.vertices.resize(vertices.size());
+	pool.parallelFor(vertices.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const MeshVertex& source = vertices[i];
+			QuantizedVertex& target = mesh.vertices[i];
+
+			glm::vec3 position = (source.position - minPos) * positionInverse;
+			target.position.v[0] = toUnorm16(position.x);
+			target.position.v[1] = toUnorm16(position.y);
+			target.position.v[2] = toUnorm16(position.z);
+			target.position.v[3] = 0;
+
+			target.color.v[0] = toUnorm8(source.color.x);
+			target.color.v[1] = toUnorm8(source.color.y);
+			target.color.v[2] = toUnorm8(source.color.z);
+			target.color.v[3] = 255;
+
+			glm::vec2 texCoord = (source.texCoord - minUV) * texCoordInverse;
+			target.texCoord.v[0] = toUnorm16(texCoord.x);
+			target.texCoord.v[1] = toUnorm16(texCoord.y);
+
+			encodeNormal(source.normal, target.normal.v);
+		}
+	}, 4096);
+
+	return mesh;
+}
+
+QuantizedMesh VertexQuantizer::quantize(const vector<DefaultVertex>& vertices, const vector<unsigned int>& indices, WorkerPool& pool) {
+	vector<MeshVertex> expanded(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++) {
+		expanded[i].position = vertices[i].position;
+		expanded[i].color = vertices[i].color;
+		expanded[i].texCoord = vertices[i].texCoord;
+		expanded[i].normal = glm::vec3(0.0f, 0.0f, 1.0f);
+	}
+	return quantize(expanded, indices, pool);
+}
+
+// Octahedral mapping: project the normal onto the octahedron |x| + |y| + |z| = 1 and unfold
+//		the lower half over the corners of the square, giving two values in -1..1 with even error everywhere.
+void VertexQuantizer::encodeNormal(const glm::vec3& normal, unsigned short encoded[2]) {
+	float sum = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+	if (sum <= 0.0f) {
+		encoded[0] = encoded[1] = toUnorm16(0.5f);
+		return;
+	}
+
+	float x = normal.x / sum;
+	float y = normal.y / sum;
+	if (normal.z < 0.0f) {
+		float foldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		float foldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	encoded[0] = toUnorm16(x * 0.5f + 0.5f);
+	encoded[1] = toUnorm16(y * 0.5f + 0.5f);
+}
+
+glm::vec3 VertexQuantizer::decodeNormal(const unsigned short encoded[2]) {
+	float x = encoded[0] / 65535.0f * 2.0f - 1.0f;
+	float y = encoded[1] / 65535.0f * 2.0f - 1.0f;
+	float z = 1.0f - fabsf(x) - fabsf(y);
+
+	float t = max(-z, 0.0f);
+	x += (x >= 0.0f) ? -t : t;
+	y += (y >= 0.0f) ? -t : t;
+
+	return glm::normalize(glm::vec3(x, y, z));
+}
+
+glm::vec3 VertexQuantizer::decodePosition(const QuantizedVertex& vertex, const Dequantization& dequantization) {
+	glm::vec3 stored(vertex.position.v[0] / 65535.0f, vertex.position.v[1] / 65535.0f, vertex.position.v[2] / 65535.0f);
+	return stored * dequantization.positionScale + dequantization.positionOffset;
+}
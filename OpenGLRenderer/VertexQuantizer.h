@@ -0,0 +1,71 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// GL Mathematics
+#include <glm/glm.hpp>
+
+// Local Library Includes
+#include "VertexLayout.h"
+#include "WorkerPool.h"
+
+// Standard Library Includes
+#include <array>
+#include <vector>
+
+using namespace std;
+
+// A MeshVertex in 20 bytes instead of 44 (DefaultVertex alone is 32).
+//		Everything is stored as unsigned normalized integers, which every GL version converts the same way
+//		(value / 65535 or / 255), unlike signed normalized data before GL 4.2.
+struct QuantizedVertex {
+	Normalized<unsigned short, 4> position;	// xyz across the mesh's bounding box; w is padding to keep attributes 4-byte aligned.
+	Normalized<unsigned char, 4> color;		// RGBA8.
+	Normalized<unsigned short, 2> texCoord;	// Across the mesh's UV range, so tiling UVs outside 0..1 survive.
+	Normalized<unsigned short, 2> normal;	// Octahedral encoding remapped from -1..1 to 0..1.
+
+	static constexpr array<VertexAttribute, 4> attributes() {
+		return { {
+			VERTEX_ATTRIBUTE(QuantizedVertex, position, 0),
+			VERTEX_ATTRIBUTE(QuantizedVertex, color, 1),
+			VERTEX_ATTRIBUTE(QuantizedVertex, texCoord, 2),
+			VERTEX_ATTRIBUTE(QuantizedVertex, normal, 3)
+		} };
+	}
+};
+
+// What the vertex shader needs to turn the stored 0..1 values back into the mesh's own units:
+//		value = stored * scale + offset. Quantized.vert reads these as uniforms.
+struct Dequantization {
+	glm::vec3 positionScale = glm::vec3(1.0f);
+	glm::vec3 positionOffset = glm::vec3(0.0f);
+	glm::vec2 texCoordScale = glm::vec2(1.0f);
+	glm::vec2 texCoordOffset = glm::vec2(0.0f);
+};
+
+struct QuantizedMesh {
+	vector<QuantizedVertex> vertices;
+	vector<unsigned int> indices;
+	Dequantization dequantization;
+};
+
+// Ingestion step that shrinks meshes before they are uploaded.
+//		Halving the vertex size halves vertex fetch bandwidth and the memory the geometry arena needs.
+//		Positions keep 16 bits per axis across the mesh's bounds, which for a 10m object is a step of 0.15mm.
+class VertexQuantizer {
+
+	public:
+		// Functions
+		static QuantizedMesh quantize(const vector<MeshVertex>& vertices, const vector<unsigned int>& indices, WorkerPool& pool = WorkerPool::shared());
+
+		// DefaultVertex has no normal, so every vertex gets +Z.
+		static QuantizedMesh quantize(const vector<DefaultVertex>& vertices, const vector<unsigned int>& indices, WorkerPool& pool = WorkerPool::shared());
+
+		// Unit normal to two 16-bit values and back. The decode matches Quantized.vert.
+		static void encodeNormal(const glm::vec3& normal, unsigned short encoded[2]);
+		static glm::vec3 decodeNormal(const unsigned short encoded[2]);
+
+		// Undo the quantization of one vertex on the CPU (bounds, picking, debugging).
+		static glm::vec3 decodePosition(const QuantizedVertex& vertex, const Dequantization& dequantization);
+};
@@ -0,0 +1,543 @@
+#include "VirtualTexture.h"
+
+// Local Library Includes
+#include "ImageDecoder.h"
+#include "MipmapGenerator.h"
+#include "RenderableObject.h"
+
+// Standard Library Includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+	const char PAGE_FILE_MAGIC[4] = { 'V', 'T', 'E', 'X' };
+	const unsigned int PAGE_FILE_VERSION = 1;
+	const int PAGE_CHANNELS = 4;
+
+	// Header: magic, then version, width, height, pageSize, border, levelCount.
+	const size_t HEADER_BYTES = sizeof(PAGE_FILE_MAGIC) + 6 * sizeof(unsigned int);
+	const unsigned int MAX_PAGE_SIZE = 1024;
+	const unsigned int MAX_PAGES_PER_SIDE = 4096;	// pageKey() packs page x and y into 12 bits each.
+
+	int nextPowerOfTwo(int value) {
+		int result = 1;
+		while (result < value)
+			result <<= 1;
+		return result;
+	}
+
+	int log2i(int value) {
+		int result = 0;
+		while ((1 << (result + 1)) <= value)
+			result++;
+		return result;
+	}
+}
+
+const unsigned int VirtualTexture::EMPTY_SLOT;
+
+// ---
+// Offline cooking
+// ---
+bool VirtualTexture::cook(const char* imagePath, const char* pagePath, int pageSize, int border) {
+	DecodedImage image = ImageDecoder::decodeFile(imagePath, PAGE_CHANNELS);
+	if (!image.valid())
+		return false;
+
+	int imgWidth = image.width, imgHeight = image.height;
+
+	// Power-of-two sizes make every level an exact grid of pages, which keeps the shader maths trivial.
+	int width = nextPowerOfTwo(max(imgWidth, pageSize));
+	int height = nextPowerOfTwo(max(imgHeight, pageSize));
+	int levels = min(log2i(width / pageSize), log2i(height / pageSize)) + 1;
+
+	MipSettings settings;
+	settings.maxLevels = levels;
+
+	MipChain chain;
+	if (width != imgWidth || height != imgHeight) {
+		MipLevel resized = MipmapGenerator::resize(image.pixels.data(), imgWidth, imgHeight, PAGE_CHANNELS, width, height, settings);
+		chain = MipmapGenerator::generate(resized.pixels.data(), width, height, PAGE_CHANNELS, settings);
+	}
+	else {
+		chain = MipmapGenerator::generate(image.pixels.data(), width, height, PAGE_CHANNELS, settings);
+	}
+	image.pixels.clear();
+
+	ofstream file(pagePath, ios::binary);
+	if (!file) {
+		cout << "ERROR::VIRTUAL_TEXTURE::FILE_NOT_SUCCESSFULLY_WRITTEN " << pagePath << endl;
+		return false;
+	}
+
+	unsigned int header[] = { PAGE_FILE_VERSION, (unsigned int)width, (unsigned int)height, (unsigned int)pageSize, (unsigned int)border, (unsigned int)levels };
+	file.write(PAGE_FILE_MAGIC, sizeof(PAGE_FILE_MAGIC));
+	file.write((const char*)header, sizeof(header));
+
+	// Pages are stored level by level, row by row, each with its border copied from its neighbours (wrapping).
+	int slot = pageSize + border * 2;
+	vector<unsigned char> page((size_t)slot * slot * PAGE_CHANNELS);
+
+	for (int level = 0; level < levels; level++) {
+		const MipLevel& mip = chain.levels[level];
+		int pagesX = mip.width / pageSize;
+		int pagesY = mip.height / pageSize;
+
+		for (int py = 0; py < pagesY; py++) {
+			for (int px = 0; px < pagesX; px++) {
+				for (int sy = 0; sy < slot; sy++) {
+					int y = ((py * pageSize + sy - border) % mip.height + mip.height) % mip.height;
+					for (int sx = 0; sx < slot; sx++) {
+						int x = ((px * pageSize + sx - border) % mip.width + mip.width) % mip.width;
+						const unsigned char* src = &mip.pixels[((size_t)y * mip.width + x) * PAGE_CHANNELS];
+						copy(src, src + PAGE_CHANNELS, &page[((size_t)sy * slot + sx) * PAGE_CHANNELS]);
+					}
+				}
+				file.write((const char*)page.data(), page.size());
+			}
+		}
+	}
+
+	return (bool)file;
+}
+
+// ---
+// Runtime
+// ---
+VirtualTexture::VirtualTexture(const char* pagePath, int physicalPagesX, int physicalPagesY, int feedbackScale, int maxUploadsPerFrame) {
+	this->pagePath = pagePath;
+	this->physicalPagesX = physicalPagesX;
+	this->physicalPagesY = physicalPagesY;
+	this->feedbackScale = max(1, feedbackScale);
+	this->maxUploadsPerFrame = maxUploadsPerFrame;
+	physicalTexture = indirectionTexture = 0;
+	feedbackFBO = feedbackColor = feedbackDepth = 0;
+	feedbackPBO[0] = feedbackPBO[1] = 0;
+	feedbackPBOFilled[0] = feedbackPBOFilled[1] = false;
+	feedbackWidth = feedbackHeight = 0;
+	indirectionDirty = true;
+	frameIndex = 0;
+	stopping = false;
+
+	if (!readHeader()) {
+		cout << "ERROR::VIRTUAL_TEXTURE::FILE_NOT_SUCCESSFULLY_READ " << pagePath << endl;
+		return;
+	}
+
+	// 1. The physical page cache. Plain bilinear filtering - the page borders cover the neighbouring texels.
+	glGenTextures(1, &physicalTexture);
+	RenderableObject::bindTexture2D(physicalTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, physicalPagesX * slotSize, physicalPagesY * slotSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	slotOwner.assign((size_t)physicalPagesX * physicalPagesY, EMPTY_SLOT);
+
+	// 2. The indirection texture: one RGBA8UI texel per virtual page, one mip per page level.
+	//		Each texel holds (slot x, slot y, level of the page actually used, unused).
+	glGenTextures(1, &indirectionTexture);
+	RenderableObject::bindTexture2D(indirectionTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+	indirection.resize(levelCount);
+	for (int level = 0; level < levelCount; level++) {
+		indirection[level].assign((size_t)levelPagesX[level] * levelPagesY[level] * 4, 0);
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8UI, levelPagesX[level], levelPagesY[level], 0, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, NULL);
+	}
+
+	// 3. Lock the coarsest level in so every lookup has something to fall back to.
+	ifstream file(this->pagePath, ios::binary);
+	int coarsest = levelCount - 1;
+	vector<unsigned char> pixels;
+
+	for (int y = 0; y < levelPagesY[coarsest]; y++) {
+		for (int x = 0; x < levelPagesX[coarsest]; x++) {
+			unsigned int key = pageKey(coarsest, x, y);
+			if (readPage(file, key, pixels))
+				uploadPage(key, pixels, true);
+		}
+	}
+	rebuildIndirection();
+
+	// 4. Start the loader thread.
+	loader = thread(&VirtualTexture::loaderLoop, this);
+}
+
+VirtualTexture::~VirtualTexture() {
+	if (loader.joinable()) {
+		{
+			lock_guard<mutex> lock(loaderMutex);
+			stopping = true;
+		}
+		loaderSignal.notify_all();
+		loader.join();
+	}
+
+	if (physicalTexture) glDeleteTextures(1, &physicalTexture);
+	if (indirectionTexture) glDeleteTextures(1, &indirectionTexture);
+	if (feedbackColor) glDeleteTextures(1, &feedbackColor);
+	if (feedbackDepth) glDeleteRenderbuffers(1, &feedbackDepth);
+	if (feedbackFBO) glDeleteFramebuffers(1, &feedbackFBO);
+	if (feedbackPBO[0]) glDeleteBuffers(2, feedbackPBO);
+
+	// GL reuses deleted names; a cache still naming one would skip the next bind of that name.
+	RenderableObject::bindTexture2D(0);
+}
+
+bool VirtualTexture::readHeader() {
+	ifstream file(pagePath, ios::binary);
+	char magic[4];
+	unsigned int header[6];
+
+	if (!file.read(magic, sizeof(magic)) || !equal(magic, magic + 4, PAGE_FILE_MAGIC) ||
+		!file.read((char*)header, sizeof(header)) || header[0] != PAGE_FILE_VERSION)
+		return false;
+
+	// Sizes, shifts and divisions below all come from these, so they are checked before anything uses them.
+	//		Every level needs at least one whole page, which bounds levelCount by log2(min side / pageSize) + 1.
+	unsigned int width = header[1], height = header[2], size = header[3], gutter = header[4], levels = header[5];
+	if (size == 0 || size > MAX_PAGE_SIZE || (size & (size - 1)) != 0 || gutter >= size ||
+		width < size || height < size || width / size > MAX_PAGES_PER_SIDE || height / size > MAX_PAGES_PER_SIDE || levels == 0) {
+		cout << "ERROR::VIRTUAL_TEXTURE::INVALID_HEADER " << pagePath << endl;
+		return false;
+	}
+
+	unsigned int maxLevels = 1;
+	while ((min(width, height) >> maxLevels) >= size)
+		maxLevels++;
+	if (levels > maxLevels) {
+		cout << "ERROR::VIRTUAL_TEXTURE::INVALID_HEADER " << pagePath << endl;
+		return false;
+	}
+
+	virtualWidth = (int)width;
+	virtualHeight = (int)height;
+	pageSize = (int)size;
+	border = (int)gutter;
+	levelCount = (int)levels;
+	slotSize = pageSize + border * 2;
+	pageBytes = (size_t)slotSize * slotSize * PAGE_CHANNELS;
+	headerBytes = HEADER_BYTES;
+
+	size_t firstPage = 0;
+	for (int level = 0; level < levelCount; level++) {
+		levelPagesX.push_back((virtualWidth >> level) / pageSize);
+		levelPagesY.push_back((virtualHeight >> level) / pageSize);
+		levelFirstPage.push_back(firstPage);
+		firstPage += (size_t)levelPagesX[level] * levelPagesY[level];
+	}
+	return true;
+}
+
+TextureRef VirtualTexture::textureRef() const {
+	TextureRef ref;
+	ref.kind = TextureKind::Virtual;
+	ref.texture = physicalTexture;
+	return ref;
+}
+
+// ---
+// Feedback pass
+// ---
+void VirtualTexture::beginFeedback(int viewportWidth, int viewportHeight) {
+	int width = max(1, viewportWidth / feedbackScale);
+	int height = max(1, viewportHeight / feedbackScale);
+
+	// (Re)create the low resolution target whenever the window size changes.
+	if (width != feedbackWidth || height != feedbackHeight) {
+		if (!feedbackFBO) {
+			glGenFramebuffers(1, &feedbackFBO);
+			glGenTextures(1, &feedbackColor);
+			glGenRenderbuffers(1, &feedbackDepth);
+			glGenBuffers(2, feedbackPBO);
+		}
+
+		feedbackWidth = width;
+		feedbackHeight = height;
+
+		RenderableObject::bindTexture2D(feedbackColor);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+		glBindRenderbuffer(GL_RENDERBUFFER, feedbackDepth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, feedbackFBO);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, feedbackColor, 0);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, feedbackDepth);
+
+		for (int i = 0; i < 2; i++) {
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackPBO[i]);
+			glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)width * height * 4, NULL, GL_STREAM_READ);
+			feedbackPBOFilled[i] = false;
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	// The scene may itself be drawing into an offscreen target; put back whatever was bound.
+	glGetIntegerv(GL_VIEWPORT, savedViewport);
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &savedFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, feedbackFBO);
+	glViewport(0, 0, feedbackWidth, feedbackHeight);
+
+	// Alpha 0 marks "no virtual texture here".
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void VirtualTexture::endFeedback() {
+	int current = frameIndex % 2;
+	int previous = 1 - current;
+
+	// Start this frame's readback into one PBO; the GPU finishes it in the background.
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackPBO[current]);
+	glReadPixels(0, 0, feedbackWidth, feedbackHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	feedbackPBOFilled[current] = true;
+
+	// ...and consume last frame's, which is done by now, so mapping it doesn't stall.
+	if (feedbackPBOFilled[previous]) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackPBO[previous]);
+		const unsigned char* pixels = (const unsigned char*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+		if (pixels) {
+			parseFeedback(pixels);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		feedbackPBOFilled[previous] = false;
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, savedFramebuffer);
+	glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+}
+
+// Each feedback texel is (x low, y low, x high | y high << 4, level + 1), see VTFeedback.frag.
+void VirtualTexture::parseFeedback(const unsigned char* pixels) {
+	size_t count = (size_t)feedbackWidth * feedbackHeight;
+	unsigned int lastKey = EMPTY_SLOT;
+
+	for (size_t i = 0; i < count; i++) {
+		const unsigned char* texel = pixels + i * 4;
+		if (texel[3] == 0)
+			continue;
+
+		int level = min((int)texel[3] - 1, levelCount - 1);
+		int x = texel[0] | ((texel[2] & 0x0F) << 8);
+		int y = texel[1] | ((texel[2] >> 4) << 8);
+
+		if (x >= levelPagesX[level] || y >= levelPagesY[level])
+			continue;
+
+		// Neighbouring pixels usually want the same page; skip the set insert for runs.
+		unsigned int key = pageKey(level, x, y);
+		if (key != lastKey) {
+			requestedThisFrame.insert(key);
+			lastKey = key;
+		}
+	}
+}
+
+// ---
+// Streaming
+// ---
+void VirtualTexture::update() {
+	if (!physicalTexture)
+		return;
+
+	frameIndex++;
+
+	// 1. Touch resident pages and queue loads for missing ones, coarse levels first so fallbacks improve quickly.
+	vector<unsigned int> missing;
+	for (unsigned int key : requestedThisFrame) {
+		auto it = resident.find(key);
+		if (it != resident.end())
+			it->second.lastUsedFrame = frameIndex;
+		else
+			missing.push_back(key);
+	}
+	requestedThisFrame.clear();
+
+	sort(missing.begin(), missing.end(), [](unsigned int a, unsigned int b) { return keyLevel(a) > keyLevel(b); });
+
+	if (!missing.empty()) {
+		lock_guard<mutex> lock(loaderMutex);
+		for (unsigned int key : missing) {
+			if (pending.insert(key).second)
+				loadQueue.push_back(key);
+		}
+	}
+	loaderSignal.notify_one();
+
+	// 2. Copy finished pages into the cache, within the per-frame budget.
+	for (int uploads = 0; uploads < maxUploadsPerFrame; uploads++) {
+		PageRequest page;
+		{
+			lock_guard<mutex> lock(loaderMutex);
+			if (loadedPages.empty())
+				break;
+			page = std::move(loadedPages.front());
+			loadedPages.pop_front();
+			pending.erase(page.key);
+		}
+
+		if (resident.find(page.key) == resident.end())
+			uploadPage(page.key, page.pixels, false);
+	}
+
+	// 3. Point the indirection texture at whatever is resident now.
+	if (indirectionDirty)
+		rebuildIndirection();
+}
+
+void VirtualTexture::loaderLoop() {
+	ifstream file(pagePath, ios::binary);
+
+	while (true) {
+		unsigned int key;
+		{
+			unique_lock<mutex> lock(loaderMutex);
+			loaderSignal.wait(lock, [this]() { return stopping || !loadQueue.empty(); });
+			if (stopping)
+				return;
+
+			key = loadQueue.front();
+			loadQueue.pop_front();
+		}
+
+		PageRequest page;
+		page.key = key;
+		if (!readPage(file, key, page.pixels)) {
+			file.clear();
+			lock_guard<mutex> lock(loaderMutex);
+			pending.erase(key);
+			continue;
+		}
+
+		lock_guard<mutex> lock(loaderMutex);
+		loadedPages.push_back(std::move(page));
+	}
+}
+
+bool VirtualTexture::readPage(ifstream& file, unsigned int key, vector<unsigned char>& pixels) const {
+	int level = keyLevel(key);
+	size_t index = levelFirstPage[level] + (size_t)keyY(key) * levelPagesX[level] + keyX(key);
+
+	pixels.resize(pageBytes);
+	file.seekg((streamoff)(headerBytes + index * pageBytes));
+	return (bool)file.read((char*)pixels.data(), pageBytes);
+}
+
+// A free slot if there is one, otherwise the least recently used page not needed this frame.
+int VirtualTexture::acquireSlot() {
+	for (size_t i = 0; i < slotOwner.size(); i++) {
+		if (slotOwner[i] == EMPTY_SLOT)
+			return (int)i;
+	}
+
+	unsigned int victim = EMPTY_SLOT;
+	unsigned int oldest = frameIndex;
+	for (const auto& entry : resident) {
+		if (!entry.second.locked && entry.second.lastUsedFrame < oldest) {
+			oldest = entry.second.lastUsedFrame;
+			victim = entry.first;
+		}
+	}
+
+	if (victim == EMPTY_SLOT)
+		return -1;
+
+	int slot = resident[victim].slot;
+	resident.erase(victim);
+	slotOwner[slot] = EMPTY_SLOT;
+	indirectionDirty = true;
+	return slot;
+}
+
+void VirtualTexture::uploadPage(unsigned int key, const vector<unsigned char>& pixels, bool locked) {
+	int slot = acquireSlot();
+	if (slot < 0)
+		return; // The cache is full of pages in use this frame; try again next frame.
+
+	RenderableObject::bindTexture2D(physicalTexture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, (slot % physicalPagesX) * slotSize, (slot / physicalPagesX) * slotSize,
+		slotSize, slotSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+	ResidentPage page;
+	page.slot = slot;
+	page.lastUsedFrame = frameIndex;
+	page.locked = locked;
+	resident[key] = page;
+	slotOwner[slot] = key;
+	indirectionDirty = true;
+}
+
+// Coarsest level first: every page points at itself if resident, otherwise inherits its parent's entry.
+void VirtualTexture::rebuildIndirection() {
+	RenderableObject::bindTexture2D(indirectionTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (int level = levelCount - 1; level >= 0; level--) {
+		vector<unsigned char>& table = indirection[level];
+
+		for (int y = 0; y < levelPagesY[level]; y++) {
+			for (int x = 0; x < levelPagesX[level]; x++) {
+				unsigned char* entry = &table[((size_t)y * levelPagesX[level] + x) * 4];
+				auto it = resident.find(pageKey(level, x, y));
+
+				if (it != resident.end()) {
+					entry[0] = (unsigned char)(it->second.slot % physicalPagesX);
+					entry[1] = (unsigned char)(it->second.slot / physicalPagesX);
+					entry[2] = (unsigned char)level;
+					entry[3] = 255;
+				}
+				else if (level + 1 < levelCount) {
+					int parentX = min(x / 2, levelPagesX[level + 1] - 1);
+					int parentY = min(y / 2, levelPagesY[level + 1] - 1);
+					const unsigned char* parent = &indirection[level + 1][((size_t)parentY * levelPagesX[level + 1] + parentX) * 4];
+					copy(parent, parent + 4, entry);
+				}
+			}
+		}
+
+		glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, levelPagesX[level], levelPagesY[level], GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, table.data());
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	indirectionDirty = false;
+}
+
+// ---
+// Shader interface
+// ---
+void VirtualTexture::bind() const {
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, physicalTexture);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, indirectionTexture);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void VirtualTexture::attachToProgram(unsigned int program) const {
+	glUseProgram(program);
+	glUniform1i(glGetUniformLocation(program, "physicalTexture"), 1);
+	glUniform1i(glGetUniformLocation(program, "indirectionTexture"), 2);
+	glUniform2f(glGetUniformLocation(program, "virtualSize"), (float)virtualWidth, (float)virtualHeight);
+	glUniform2f(glGetUniformLocation(program, "physicalSize"), (float)(physicalPagesX * slotSize), (float)(physicalPagesY * slotSize));
+	glUniform1f(glGetUniformLocation(program, "pageSize"), (float)pageSize);
+	glUniform1f(glGetUniformLocation(program, "pageBorder"), (float)border);
+	glUniform1i(glGetUniformLocation(program, "maxLevel"), levelCount - 1);
+}
+
+void VirtualTexture::attachFeedbackProgram(unsigned int program) const {
+	glUseProgram(program);
+	glUniform2f(glGetUniformLocation(program, "virtualSize"), (float)virtualWidth, (float)virtualHeight);
+	glUniform1f(glGetUniformLocation(program, "pageSize"), (float)pageSize);
+	glUniform1i(glGetUniformLocation(program, "maxLevel"), levelCount - 1);
+
+	// The feedback target is smaller than the screen, so derivatives are larger; bias back to screen-resolution mips.
+	glUniform1f(glGetUniformLocation(program, "lodBias"), -log2f((float)feedbackScale));
+}
@@ -0,0 +1,38 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 vertexColor;
+in vec2 TexCoord;
+
+// Set by VirtualTexture::attachToProgram.
+uniform sampler2D physicalTexture;		// The page cache.
+uniform usampler2D indirectionTexture;	// Per virtual page: (slot x, slot y, level actually resident).
+uniform vec2 virtualSize;				// Size of the full virtual image in texels.
+uniform vec2 physicalSize;				// Size of the page cache in texels.
+uniform float pageSize;
+uniform float pageBorder;
+uniform int maxLevel;
+
+void main()
+{
+	vec2 uv = fract(TexCoord);
+
+	// Pick the mip level the hardware would have used for a texture of the virtual size.
+	vec2 texel = TexCoord * virtualSize;
+	vec2 dx = dFdx(texel);
+	vec2 dy = dFdy(texel);
+	float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy)));
+	int level = clamp(int(floor(lod)), 0, maxLevel);
+
+	// Look up the page. If it is not resident the entry points at the closest resident parent instead.
+	vec2 pagesAtLevel = (virtualSize / pageSize) / exp2(float(level));
+	uvec4 entry = texelFetch(indirectionTexture, ivec2(uv * pagesAtLevel), level);
+
+	// Position inside whichever page we actually got, then into its slot in the cache.
+	vec2 pagesAtEntry = (virtualSize / pageSize) / exp2(float(entry.z));
+	vec2 inPage = fract(uv * pagesAtEntry);
+	vec2 slotOrigin = vec2(entry.xy) * (pageSize + 2.0 * pageBorder) + pageBorder;
+	vec2 physicalUV = (slotOrigin + inPage * pageSize) / physicalSize;
+
+	FragColor = textureLod(physicalTexture, physicalUV, 0.0) * vec4(vertexColor, 1.0f);
+}
\ No newline at end of file
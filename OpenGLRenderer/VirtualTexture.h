@@ -0,0 +1,126 @@
+#pragma once
+
+// OpenGL Includes
+#include <glad/glad.h>
+
+// Local Library Includes
+#include "TextureRef.h"
+
+// Standard Library Includes
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Sparse virtual texturing for images far larger than VRAM.
+//
+//		Offline, cook() cuts an image and its mip chain into fixed-size pages (with a border for filtering)
+//		and writes them to a page file. At runtime only a fixed pool of pages lives on the GPU, in one
+//		"physical" cache texture. An indirection texture (one texel per virtual page, one mip per level)
+//		tells the shader where each page sits in the cache, falling back to the nearest resident parent.
+//
+//		Each frame the scene is drawn at low resolution with VTFeedback.frag, which writes the page each
+//		pixel wants. That buffer is read back through a PBO a frame late (no stall), requested pages are
+//		loaded from disk on a loader thread, and update() copies at most a few per frame into the cache,
+//		evicting the least recently used ones.
+class VirtualTexture {
+
+	private:
+		struct PageRequest {
+			unsigned int key;
+			vector<unsigned char> pixels;
+		};
+
+		struct ResidentPage {
+			int slot;
+			unsigned int lastUsedFrame;
+			bool locked;	// The coarsest level is always resident so every lookup has a fallback.
+		};
+
+		// Page file layout
+		string pagePath;
+		int virtualWidth, virtualHeight;
+		int pageSize, border, slotSize;
+		int levelCount;
+		vector<int> levelPagesX, levelPagesY;
+		vector<size_t> levelFirstPage;
+		size_t pageBytes, headerBytes;
+
+		// GPU side
+		unsigned int physicalTexture, indirectionTexture;
+		int physicalPagesX, physicalPagesY;
+		vector<unsigned int> slotOwner;		// Page key stored in each physical slot, or EMPTY_SLOT.
+		unordered_map<unsigned int, ResidentPage> resident;
+		vector<vector<unsigned char>> indirection;
+		bool indirectionDirty;
+		unsigned int frameIndex;
+		int maxUploadsPerFrame;
+
+		// Feedback pass
+		unsigned int feedbackFBO, feedbackColor, feedbackDepth;
+		unsigned int feedbackPBO[2];
+		bool feedbackPBOFilled[2];
+		int feedbackWidth, feedbackHeight, feedbackScale;
+		GLint savedViewport[4];
+		GLint savedFramebuffer;
+		set<unsigned int> requestedThisFrame;
+
+		// Loader thread
+		thread loader;
+		mutex loaderMutex;
+		condition_variable loaderSignal;
+		deque<unsigned int> loadQueue;
+		deque<PageRequest> loadedPages;
+		set<unsigned int> pending;
+		bool stopping;
+
+		static unsigned int pageKey(int level, int x, int y) { return ((unsigned int)level << 24) | ((unsigned int)y << 12) | (unsigned int)x; }
+		static int keyLevel(unsigned int key) { return (int)(key >> 24); }
+		static int keyY(unsigned int key) { return (int)((key >> 12) & 0xFFF); }
+		static int keyX(unsigned int key) { return (int)(key & 0xFFF); }
+
+		bool readHeader();
+		void loaderLoop();
+		bool readPage(ifstream& file, unsigned int key, vector<unsigned char>& pixels) const;
+		int acquireSlot();
+		void uploadPage(unsigned int key, const vector<unsigned char>& pixels, bool locked);
+		void parseFeedback(const unsigned char* pixels);
+		void rebuildIndirection();
+
+	public:
+		static const unsigned int EMPTY_SLOT = 0xFFFFFFFF;
+
+		// Constructor
+		VirtualTexture(const char* pagePath, int physicalPagesX = 16, int physicalPagesY = 16, int feedbackScale = 8, int maxUploadsPerFrame = 8);
+		~VirtualTexture();
+
+		VirtualTexture(const VirtualTexture&) = delete;
+		VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+		// Functions
+		// Offline: split an image into a page file. Dimensions are rounded up to powers of two.
+		static bool cook(const char* imagePath, const char* pagePath, int pageSize = 128, int border = 4);
+
+		bool isValid() const { return physicalTexture != 0; }
+		TextureRef textureRef() const;
+
+		// Render the scene with VTFeedback.frag between these two calls each frame.
+		void beginFeedback(int viewportWidth, int viewportHeight);
+		void endFeedback();
+
+		// Queue loads for requested pages and upload finished ones. Call once per frame on the GL thread.
+		//		Uploads bind on unit 0 through RenderableObject's bind cache, so this is safe between draws.
+		void update();
+
+		// Bind the cache and indirection textures and set a program's VT uniforms (physical on unit 1, indirection on unit 2).
+		void bind() const;
+		void attachToProgram(unsigned int program) const;
+		void attachFeedbackProgram(unsigned int program) const;
+};
@@ -0,0 +1,103 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+WorkerPool::WorkerPool(unsigned int threadCount) {
+	stopping = false;
+
+	if (threadCount == 0)
+		threadCount = max(1u, thread::hardware_concurrency());
+
+	for (unsigned int i = 0; i < threadCount; i++)
+		workers.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		lock_guard<mutex> lock(jobMutex);
+		stopping = true;
+	}
+	jobSignal.notify_all();
+
+	for (thread& worker : workers)
+		worker.join();
+}
+
+void WorkerPool::submit(function<void()> job) {
+	{
+		lock_guard<mutex> lock(jobMutex);
+		jobs.push(std::move(job));
+	}
+	jobSignal.notify_one();
+}
+
+// Each worker sleeps until a job arrives, runs it, and goes back to sleep.
+//		Remaining jobs are drained before the pool shuts down.
+void WorkerPool::workerLoop() {
+	while (true) {
+		function<void()> job;
+		{
+			unique_lock<mutex> lock(jobMutex);
+			jobSignal.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+			if (jobs.empty())
+				return;
+
+			job = std::move(jobs.front());
+			jobs.pop();
+		}
+		job();
+	}
+}
+
+void WorkerPool::parallelFor(size_t count, const function<void(size_t begin, size_t end)>& fn, size_t minChunk) {
+	if (count == 0)
+		return;
+
+	// Aim for a few chunks per worker so uneven rows still balance out.
+	size_t chunkSize = max(minChunk, (count + size() * 4 - 1) / (size() * 4));
+	size_t numChunks = (count + chunkSize - 1) / chunkSize;
+
+	if (numChunks == 1) {
+		fn(0, count);
+		return;
+	}
+
+	// Shared between the caller and helpers; helpers may outlive this call if they start late.
+	struct ForState {
+		atomic<size_t> nextChunk{ 0 };
+		atomic<size_t> finishedChunks{ 0 };
+		mutex doneMutex;
+		condition_variable doneSignal;
+	};
+	shared_ptr<ForState> state = make_shared<ForState>();
+
+	auto runChunks = [state, &fn, count, chunkSize, numChunks]() {
+		size_t chunk;
+		while ((chunk = state->nextChunk.fetch_add(1)) < numChunks) {
+			size_t begin = chunk * chunkSize;
+			fn(begin, min(count, begin + chunkSize));
+
+			if (state->finishedChunks.fetch_add(1) + 1 == numChunks) {
+				lock_guard<mutex> lock(state->doneMutex);
+				state->doneSignal.notify_all();
+			}
+		}
+	};
+
+	size_t helpers = min((size_t)size(), numChunks - 1);
+	for (size_t i = 0; i < helpers; i++)
+		submit(runChunks);
+
+	runChunks();
+
+	// Only chunks claimed by helpers can still be in flight at this point.
+	unique_lock<mutex> lock(state->doneMutex);
+	state->doneSignal.wait(lock, [&state, numChunks]() { return state->finishedChunks.load() == numChunks; });
+}
+
+WorkerPool& WorkerPool::shared() {
+	static WorkerPool pool;
+	return pool;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// Standard Library Includes
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// A small fixed-size pool of worker threads.
+//		CPU-side asset work (mip generation, decoding, mesh processing) is pushed here
+//		so the render thread only has to deal with the final GL calls.
+class WorkerPool {
+
+	private:
+		vector<thread> workers;
+		queue<function<void()>> jobs;
+		mutex jobMutex;
+		condition_variable jobSignal;
+		bool stopping;
+
+		void workerLoop();
+
+	public:
+		// Constructor. A thread count of 0 uses one worker per hardware thread.
+		WorkerPool(unsigned int threadCount = 0);
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		// Functions
+		void submit(function<void()> job);
+		unsigned int size() const { return (unsigned int)workers.size(); }
+
+		// Queue a job and receive its result through a future.
+		template<typename Fn>
+		auto async(Fn fn) -> future<decltype(fn())> {
+			auto task = make_shared<packaged_task<decltype(fn())()>>(std::move(fn));
+			future<decltype(fn())> result = task->get_future();
+			submit([task]() { (*task)(); });
+			return result;
+		}
+
+		// Split [0, count) into chunks and run them across the pool.
+		//		The calling thread works on chunks too, so this is safe to call from inside a job.
+		void parallelFor(size_t count, const function<void(size_t begin, size_t end)>& fn, size_t minChunk = 1);
+
+		// The process-wide pool used by the asset pipeline when no pool is given.
+		static WorkerPool& shared();
+};
@@ -3,7 +3,14 @@
 #include <GLFW/glfw3.h>
 
 // Local Header Includes
+#include "GeometryArena.h"
+#include "GLExtensions.h"
+#include "MeshOptimizer.h"
 #include "RenderableObject.h"
+#include "RenderTarget.h"
+#include "TextureCache.h"
+#include "TextureLoader.h"
+#include "UploadQueue.h"
 
 // Standard Library Includes
 #include <iostream>
@@ -11,6 +18,7 @@
 const char* vertSource = "./Default.vert";
 const char* fragSource = "./Default.frag";
 const char* texSource = "./container.jpg";
+const char* textureCacheDir = "./TextureCache";
 
 // Namespaces
 using namespace std;
@@ -64,6 +72,18 @@ int main() {
 		return -1;
 	}
 
+	// Fetch the entry points newer than GL 3.3 (bindless textures etc.) if the driver has them.
+	GLExtensions::load((GLADloadproc)glfwGetProcAddress);
+
+	// Finished mip chains are kept on disk, so later runs skip decoding and mip generation.
+	TextureCache textureCache(textureCacheDir);
+	TextureLoader::setCache(&textureCache);
+
+	// Resident textures share half of the card's memory; the rest is left for buffers and render targets.
+	//		When the driver can't tell us how much there is, nothing is downscaled.
+	TextureBudget textureBudget(TextureBudget::detectVideoMemory() / 2);
+	TextureLoader::setBudget(&textureBudget);
+
 	// 4. Let OpenGL know the initial dimensions (in pixels) of the window.
 	//		First two parameters are location of lower left corner.
 	glViewport(0, 0, width, height);
@@ -85,11 +105,22 @@ int main() {
 	//		These VBO attributes are stored in a Vertex Array Object (VAO). Subsequent vertex attribute calls can be stored in this object.
 	//		We'll only need to configure the VBO's [and shaders?] once. We can bind the object's VAO in our render loop whenever we need to draw it.
 	// ---
-	vector<float> squareVerts = {
-		0.5f,  0.5f, 0.0f,  // top right
-		0.5f, -0.5f, 0.0f,  // bottom right
-		-0.5f, -0.5f, 0.0f,  // bottom left
-		-0.5f,  0.5f, 0.0f   // top left 
+
+	// Object data is uploaded a few megabytes per frame instead of all at once when the objects are built,
+	//		so loading a scene never produces one huge frame.
+	UploadQueue uploadQueue(4 * 1024 * 1024, 2.0);
+	RenderableObject::setUploadQueue(&uploadQueue);
+
+	// Meshes share a few large buffers per vertex format rather than a VAO, VBO and EBO each.
+	GeometryArena geometryArena;
+	RenderableObject::setGeometryArena(&geometryArena);
+
+	vector<DefaultVertex> squareVerts = {
+		// positions							// colors							// tex co-ords
+		{ glm::vec3(0.5f,  0.5f, 0.0f),		glm::vec3(1.0f, 0.0f, 0.0f),		glm::vec2(1.0f, 1.0f) },  // top right
+		{ glm::vec3(0.5f, -0.5f, 0.0f),		glm::vec3(0.0f, 1.0f, 0.0f),		glm::vec2(1.0f, 0.0f) },  // bottom right
+		{ glm::vec3(-0.5f, -0.5f, 0.0f),	glm::vec3(0.0f, 0.0f, 1.0f),		glm::vec2(0.0f, 0.0f) },  // bottom left
+		{ glm::vec3(-0.5f,  0.5f, 0.0f),	glm::vec3(0.0f, 0.0f, 0.0f),		glm::vec2(0.0f, 1.0f) }   // top left 
 	};
 
 	vector<unsigned int> squareIndices = { // note that we start from 0!
@@ -109,7 +140,15 @@ int main() {
 		0.45f, 0.5f, 0.0f   // top 
 	};
 
-	RenderableObject squareObject = RenderableObject(squareVerts, squareIndices, 6, vertSource, fragSource, texSource);
+	// Reorder for the vertex cache and vertex fetch, and drop to 16-bit indices where the mesh allows.
+	MeshOptimizationReport optimization = MeshOptimizer::optimize(squareVerts, squareIndices);
+	cout << "MeshOptimizer: ACMR " << optimization.before.acmr << " -> " << optimization.after.acmr
+		<< ", ATVR " << optimization.before.atvr << " -> " << optimization.after.atvr << endl;
+	RenderableObject squareObject = RenderableObject(squareVerts, MeshOptimizer::packIndices(squareIndices, squareVerts.size()), vertSource, fragSource, texSource);
+
+	// The scene is drawn into a packed-float target and copied to the window at the end of each frame.
+	//		R11G11B10F holds values above 1.0 at half the size of RGBA16F.
+	RenderTarget sceneTarget(width, height, GL_R11F_G11F_B10F);
 
 	// glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); // Wireframe Rendering
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL); // Fill Rendering
@@ -125,11 +164,21 @@ int main() {
 
 		// rendering commands
 		// ...
+		int framebufferWidth, framebufferHeight;
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		sceneTarget.resize(framebufferWidth, framebufferHeight);
+		sceneTarget.bind();
+
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f); // state-setting function of OpenGL
 		glClear(GL_COLOR_BUFFER_BIT); // state-using function. Uses the current state defined to retrieve the clearing color.
 
+		uploadQueue.process();
+		RenderableObject::beginFrame();
+
 		squareObject.Draw();
 
+		sceneTarget.blitToScreen(framebufferWidth, framebufferHeight);
+
 		// call events and swap the buffers
 		glfwSwapBuffers(window); //update color buffer (a 2D buffer that contains color values for each pixel) to render during this iteration and show it as output to the screen.
 		glfwPollEvents(); // checks if any events are triggered, updates the window state, and calls the corresponding functions (which we can register via callback methods)